@@ -14,6 +14,7 @@
 #include "cppArrayType.h"
 #include "cppExpression.h"
 #include "cppPointerType.h"
+#include "stl_compares.h"
 
 /**
  *
@@ -195,6 +196,17 @@ output_instance(std::ostream &out, int indent_level, CPPScope *scope,
                                  prename, name + bracketsstr);
 }
 
+/**
+ *
+ */
+size_t CPPArrayType::
+add_hash(size_t hash) const {
+  if (_bounds != nullptr) {
+    hash = _bounds->add_hash(hash);
+  }
+  return _element_type->add_hash(hash);
+}
+
 /**
  *
  */
@@ -52,6 +52,7 @@ public:
                                bool complete, const std::string &prename,
                                const std::string &name) const;
 
+  virtual size_t add_hash(size_t hash) const;
   virtual SubType get_subtype() const;
 
   virtual CPPArrayType *as_array_type();
@@ -51,9 +51,9 @@ CPPType *parse_type(CPPPreprocessor *pp,
                     CPPScope *new_current_scope,
                     CPPScope *new_global_scope);
 
-extern CPPScope *current_scope;
-extern CPPScope *global_scope;
-extern CPPPreprocessor *current_lexer;
+extern thread_local CPPScope *current_scope;
+extern thread_local CPPScope *global_scope;
+extern thread_local CPPPreprocessor *current_lexer;
 
 
 // This structure holds the return value for each token.  Traditionally, this
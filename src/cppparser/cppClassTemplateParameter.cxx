@@ -13,6 +13,7 @@
 
 #include "cppClassTemplateParameter.h"
 #include "cppIdentifier.h"
+#include "stl_compares.h"
 
 /**
  *
@@ -60,6 +61,19 @@ output(std::ostream &out, int indent_level, CPPScope *scope, bool complete) cons
 }
 
 
+/**
+ *
+ */
+size_t CPPClassTemplateParameter::
+add_hash(size_t hash) const {
+  hash = pointer_hash::add_hash(hash, _default_type);
+  hash = integer_hash<int>::add_hash(hash, _packed);
+  if (_ident != nullptr) {
+    hash = _ident->add_hash(hash);
+  }
+  return hash;
+}
+
 /**
  *
  */
@@ -31,6 +31,7 @@ public:
   virtual bool is_fully_specified() const;
   virtual void output(std::ostream &out, int indent_level, CPPScope *scope,
                       bool complete) const;
+  virtual size_t add_hash(size_t hash) const;
   virtual SubType get_subtype() const;
 
   virtual CPPClassTemplateParameter *as_class_template_parameter();
@@ -12,6 +12,7 @@
  */
 
 #include "cppConstType.h"
+#include "stl_compares.h"
 
 /**
  *
@@ -189,6 +190,14 @@ output_instance(std::ostream &out, int indent_level, CPPScope *scope,
                                    "const " + prename, name);
 }
 
+/**
+ *
+ */
+size_t CPPConstType::
+add_hash(size_t hash) const {
+  return pointer_hash::add_hash(hash, _wrapped_around);
+}
+
 /**
  *
  */
@@ -53,6 +53,7 @@ public:
                                bool complete, const std::string &prename,
                                const std::string &name) const;
 
+  virtual size_t add_hash(size_t hash) const;
   virtual SubType get_subtype() const;
 
   virtual CPPConstType *as_const_type();
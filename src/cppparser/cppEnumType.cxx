@@ -72,11 +72,8 @@ get_underlying_type() {
   if (_element_type == nullptr) {
     // This enum is untyped.  Use a suitable default, ie.  'int'. In the
     // future, we might want to check whether it fits in an int.
-    static CPPType *default_element_type = nullptr;
-    if (default_element_type == nullptr) {
-      default_element_type =
-        CPPType::new_type(new CPPConstType(new CPPSimpleType(CPPSimpleType::T_int, 0)));
-    }
+    static thread_local CPPType *default_element_type =
+      CPPType::new_type(new CPPConstType(new CPPSimpleType(CPPSimpleType::T_int, 0)));
 
     return default_element_type;
   } else {
@@ -29,6 +29,7 @@
 #include "cppStructType.h"
 #include "cppBison.h"
 #include "pdtoa.h"
+#include "stl_compares.h"
 
 #include <assert.h>
 
@@ -535,7 +536,7 @@ raw_literal(const string &raw, CPPInstance *lit_op) {
  */
 const CPPExpression &CPPExpression::
 get_nullptr() {
-  static CPPExpression expr(0);
+  static thread_local CPPExpression expr(0);
   expr._type = T_nullptr;
   return expr;
 }
@@ -545,7 +546,7 @@ get_nullptr() {
  */
 const CPPExpression &CPPExpression::
 get_default() {
-  static CPPExpression expr(0);
+  static thread_local CPPExpression expr(0);
   expr._type = T_default;
   return expr;
 }
@@ -555,7 +556,7 @@ get_default() {
  */
 const CPPExpression &CPPExpression::
 get_delete() {
-  static CPPExpression expr(0);
+  static thread_local CPPExpression expr(0);
   expr._type = T_delete;
   return expr;
 }
@@ -972,45 +973,46 @@ determine_type() const {
   CPPType *t1 = nullptr;
   CPPType *t2 = nullptr;
 
-  static CPPType *nullptr_type =
+  // Types are unique per thread; see CPPType::new_type().
+  static thread_local CPPType *nullptr_type =
     CPPType::new_type(new CPPSimpleType(CPPSimpleType::T_nullptr));
 
-  static CPPType *int_type =
+  static thread_local CPPType *int_type =
     CPPType::new_type(new CPPSimpleType(CPPSimpleType::T_int));
 
-  static CPPType *unsigned_long_type =
+  static thread_local CPPType *unsigned_long_type =
     CPPType::new_type(new CPPSimpleType(CPPSimpleType::T_int,
                                         CPPSimpleType::F_unsigned |
                                         CPPSimpleType::F_long));
 
-  static CPPType *bool_type =
+  static thread_local CPPType *bool_type =
     CPPType::new_type(new CPPSimpleType(CPPSimpleType::T_bool));
 
-  static CPPType *float_type =
+  static thread_local CPPType *float_type =
     CPPType::new_type(new CPPSimpleType(CPPSimpleType::T_double));
 
-  static CPPType *char_type =
+  static thread_local CPPType *char_type =
     CPPType::new_type(new CPPSimpleType(CPPSimpleType::T_char));
 
-  static CPPType *wchar_type =
+  static thread_local CPPType *wchar_type =
     CPPType::new_type(new CPPSimpleType(CPPSimpleType::T_wchar_t));
 
-  static CPPType *char16_type =
+  static thread_local CPPType *char16_type =
     CPPType::new_type(new CPPSimpleType(CPPSimpleType::T_char16_t));
 
-  static CPPType *char32_type =
+  static thread_local CPPType *char32_type =
     CPPType::new_type(new CPPSimpleType(CPPSimpleType::T_char32_t));
 
-  static CPPType *char_str_type = CPPType::new_type(
+  static thread_local CPPType *char_str_type = CPPType::new_type(
     new CPPPointerType(CPPType::new_type(new CPPConstType(char_type))));
 
-  static CPPType *wchar_str_type = CPPType::new_type(
+  static thread_local CPPType *wchar_str_type = CPPType::new_type(
     new CPPPointerType(CPPType::new_type(new CPPConstType(wchar_type))));
 
-  static CPPType *char16_str_type = CPPType::new_type(
+  static thread_local CPPType *char16_str_type = CPPType::new_type(
     new CPPPointerType(CPPType::new_type(new CPPConstType(char16_type))));
 
-  static CPPType *char32_str_type = CPPType::new_type(
+  static thread_local CPPType *char32_str_type = CPPType::new_type(
     new CPPPointerType(CPPType::new_type(new CPPConstType(char32_type))));
 
   switch (_type) {
@@ -1633,6 +1635,44 @@ is_tbd() const {
   }
 }
 
+/**
+ * Adds a hash of the expression into the running hash.  Only the simplest
+ * kinds of expressions are hashed by value; for the rest, only the kind of
+ * expression goes into the hash.
+ */
+size_t CPPExpression::
+add_hash(size_t hash) const {
+  hash = integer_hash<int>::add_hash(hash, (int)_type);
+
+  switch (_type) {
+  case T_boolean:
+    return integer_hash<int>::add_hash(hash, _u._boolean);
+
+  case T_integer:
+    return integer_hash<unsigned long long>::add_hash(hash, _u._integer);
+
+  case T_string:
+  case T_wstring:
+  case T_u8string:
+  case T_u16string:
+  case T_u32string:
+    return string_hash::add_hash(hash, _str);
+
+  case T_variable:
+    return pointer_hash::add_hash(hash, _u._variable);
+
+  case T_function:
+    return pointer_hash::add_hash(hash, _u._fgroup);
+
+  case T_unknown_ident:
+  case T_sizeof_ellipsis:
+    return _u._ident->add_hash(hash);
+
+  default:
+    return hash;
+  }
+}
+
 /**
  *
  */
@@ -137,6 +137,7 @@ public:
   CPPType *determine_type() const;
   bool is_lvalue() const;
   bool is_tbd() const;
+  size_t add_hash(size_t hash) const;
 
   virtual bool is_fully_specified() const;
   virtual CPPDeclaration *substitute_decl(SubstDecl &subst,
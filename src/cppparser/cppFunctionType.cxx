@@ -15,6 +15,7 @@
 #include "cppParameterList.h"
 #include "cppSimpleType.h"
 #include "cppInstance.h"
+#include "stl_compares.h"
 
 using std::ostream;
 using std::ostringstream;
@@ -352,6 +353,22 @@ get_num_default_parameters() const {
   return count;
 }
 
+/**
+ *
+ */
+size_t CPPFunctionType::
+add_hash(size_t hash) const {
+  hash = pointer_hash::add_hash(hash, _return_type);
+  hash = integer_hash<int>::add_hash(hash, _flags);
+  if (_parameters != nullptr) {
+    hash = integer_hash<int>::add_hash(hash, _parameters->_includes_ellipsis);
+    for (const CPPInstance *param : _parameters->_parameters) {
+      hash = param->add_hash(hash);
+    }
+  }
+  return hash;
+}
+
 /**
  *
  */
@@ -84,6 +84,7 @@ public:
                        int num_default_parameters) const;
   int get_num_default_parameters() const;
 
+  virtual size_t add_hash(size_t hash) const;
   virtual SubType get_subtype() const;
 
   virtual CPPFunctionType *as_function_type();
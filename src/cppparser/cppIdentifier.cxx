@@ -18,6 +18,7 @@
 #include "cppTemplateParameterList.h"
 #include "cppTBDType.h"
 #include "cppStructType.h"
+#include "stl_compares.h"
 
 using std::string;
 
@@ -126,6 +127,21 @@ operator < (const CPPIdentifier &other) const {
   return false;
 }
 
+/**
+ * Adds a hash of the identifier, including any template parameters, into the
+ * running hash.
+ */
+size_t CPPIdentifier::
+add_hash(size_t hash) const {
+  for (const CPPNameComponent &name : _names) {
+    hash = string_hash::add_hash(hash, name.get_name());
+    if (name.has_templ()) {
+      hash = name.get_templ()->add_hash(hash);
+    }
+  }
+  return hash;
+}
+
 /**
  *
  */
@@ -44,6 +44,7 @@ public:
   bool operator == (const CPPIdentifier &other) const;
   bool operator != (const CPPIdentifier &other) const;
   bool operator < (const CPPIdentifier &other) const;
+  size_t add_hash(size_t hash) const;
 
   bool is_scoped() const;
 
@@ -23,6 +23,7 @@
 #include "cppReferenceType.h"
 #include "cppConstType.h"
 #include "indent.h"
+#include "stl_compares.h"
 
 #include <algorithm>
 
@@ -231,6 +232,24 @@ operator < (const CPPInstance &other) const {
   return false;
 }
 
+/**
+ * Adds a hash of the instance into the running hash.  Types that contain
+ * instances, such as function types, use this to compute their own hash.
+ */
+size_t CPPInstance::
+add_hash(size_t hash) const {
+  hash = pointer_hash::add_hash(hash, _type);
+  hash = integer_hash<int>::add_hash(hash, _storage_class);
+  hash = pointer_hash::add_hash(hash, _alignment);
+  if (_ident != nullptr) {
+    hash = _ident->add_hash(hash);
+  }
+  if (_initializer != nullptr) {
+    hash = _initializer->add_hash(hash);
+  }
+  return hash;
+}
+
 /**
  * Sets the value of the expression that is used to initialize the variable,
  * or the default value for a parameter.  If a non-null expression is set on a
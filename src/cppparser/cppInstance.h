@@ -87,6 +87,7 @@ public:
   bool operator == (const CPPInstance &other) const;
   bool operator != (const CPPInstance &other) const;
   bool operator < (const CPPInstance &other) const;
+  size_t add_hash(size_t hash) const;
 
   void set_initializer(CPPExpression *initializer);
   void set_alignment(int align);
@@ -186,6 +186,17 @@ stringify(const string &source) {
  */
 string CPPManifest::
 expand(const vector_string &args) const {
+  return expand(args, args);
+}
+
+/**
+ * Like expand(), but substitutes each parameter with the corresponding string
+ * in expanded_args, which should have any manifests in it already expanded.
+ * A parameter that is stringified or pasted is substituted with the original
+ * string from args instead.
+ */
+string CPPManifest::
+expand(const vector_string &args, const vector_string &expanded_args) const {
   string result;
 
   Expansion::const_iterator ei;
@@ -193,13 +204,18 @@ expand(const vector_string &args) const {
     if ((*ei)._parm_number >= 0) {
       int i = (*ei)._parm_number;
 
+      Expansion::const_iterator next = ei + 1;
+      bool pasted = (*ei)._paste || (next != _expansion.end() && (*next)._paste);
+      const vector_string &source =
+        ((*ei)._stringify || pasted) ? args : expanded_args;
+
       string subst;
-      if (i < (int)args.size()) {
-        subst = args[i];
+      if (i < (int)source.size()) {
+        subst = source[i];
 
         if (i == _variadic_param) {
-          for (++i; i < (int)args.size(); ++i) {
-            subst += ", " + args[i];
+          for (++i; i < (int)source.size(); ++i) {
+            subst += ", " + source[i];
           }
         }
         if ((*ei)._stringify) {
@@ -236,6 +252,16 @@ expand(const vector_string &args) const {
   return result;
 }
 
+/**
+ * Returns the expansion of a manifest that has no parameters.  This is the
+ * same as expand(), but doesn't need to build a new string each time.
+ */
+const string &CPPManifest::
+get_simple_expansion() const {
+  assert(!_has_parameters);
+  return _simple_expansion;
+}
+
 /**
  * Returns the type of the manifest, if it is known, or NULL if the type
  * cannot be determined.
@@ -431,4 +457,8 @@ save_expansion(const string &exp, const vector_string &parameter_names) {
   if (last != p) {
     _expansion.push_back(ExpansionNode(exp.substr(last, p - last), paste));
   }
+
+  if (!_has_parameters) {
+    _simple_expansion = expand();
+  }
 }
@@ -36,6 +36,9 @@ public:
 
   static std::string stringify(const std::string &source);
   std::string expand(const vector_string &args = vector_string()) const;
+  std::string expand(const vector_string &args,
+                     const vector_string &expanded_args) const;
+  const std::string &get_simple_expansion() const;
 
   CPPType *determine_type() const;
 
@@ -70,6 +73,10 @@ private:
   };
   typedef std::vector<ExpansionNode> Expansion;
   Expansion _expansion;
+
+  // A manifest without parameters always expands to the same thing, so we
+  // expand it once up front.
+  std::string _simple_expansion;
 };
 
 inline std::ostream &operator << (std::ostream &out, const CPPManifest &manifest) {
@@ -23,7 +23,10 @@
 #include <set>
 
 /**
- *
+ * Separate CPPParsers may be run at the same time on separate threads, since
+ * the parser state that is shared between parsers is kept per thread.  This
+ * also means that each thread has its own set of unique types, so there is no
+ * way yet to combine parses from different threads into one scope.
  */
 class CPPParser : public CPPScope, public CPPPreprocessor {
 public:
@@ -17,6 +17,7 @@
 #include "cppArrayType.h"
 #include "cppStructType.h"
 #include "cppSimpleType.h"
+#include "stl_compares.h"
 
 /**
  *
@@ -251,6 +252,14 @@ output_instance(std::ostream &out, int indent_level, CPPScope *scope,
                                 star + prename, name);
 }
 
+/**
+ *
+ */
+size_t CPPPointerType::
+add_hash(size_t hash) const {
+  return pointer_hash::add_hash(hash, _pointing_at);
+}
+
 /**
  *
  */
@@ -51,6 +51,7 @@ public:
                                bool complete, const std::string &prename,
                                const std::string &name) const;
 
+  virtual size_t add_hash(size_t hash) const;
   virtual SubType get_subtype() const;
 
   virtual CPPPointerType *as_pointer_type();
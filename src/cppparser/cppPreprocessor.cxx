@@ -32,8 +32,10 @@
 #include "pstrtod.h"
 #include "string_utils.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <ctype.h>
+#include <string.h>
 
 using std::cerr;
 using std::string;
@@ -43,7 +45,7 @@ using std::string;
 // visibility when they are declared.  (Asking the parser for the current
 // visibility is prone to error, since the parser might be several tokens
 // behind the preprocessor.)
-static CPPVisibility preprocessor_vis = V_public;
+static thread_local CPPVisibility preprocessor_vis = V_public;
 
 static int
 hex_val(int c) {
@@ -85,51 +87,64 @@ trim_blanks(const string &str) {
   return str.substr(first, last - first + 1);
 }
 
+/**
+ * Quietly removes any embedded carriage-return characters.  We shouldn't see
+ * any of these unless there was some DOS-to-Unix file conversion problem.
+ */
+static void
+remove_carriage_returns(string &str) {
+  if (str.find('\r') != string::npos) {
+    str.erase(std::remove(str.begin(), str.end(), '\r'), str.end());
+  }
+}
+
 /**
  *
  */
 CPPPreprocessor::InputFile::
 InputFile() {
-  _in = nullptr;
+  _next = nullptr;
+  _end = nullptr;
   _ignore_manifest = nullptr;
   _line_number = 0;
   _col_number = 0;
   _next_line_number = 1;
   _next_col_number = 1;
   _lock_position = false;
+  _guard_state = GS_none;
+  _if_nesting = 0;
 }
 
 /**
- *
- */
-CPPPreprocessor::InputFile::
-~InputFile() {
-  if (_in != nullptr) {
-    // For some reason--compiler bug in gcc 3.2?--explicitly deleting the
-    // stream pointer does not call the appropriate global delete function;
-    // instead apparently calling the system delete function.  So we call the
-    // delete function by hand instead.
-#if !defined(USE_MEMORY_NOWRAPPERS) && defined(REDEFINE_GLOBAL_OPERATOR_NEW)
-    _in->~istream();
-    (*global_operator_delete)(_in);
-#else
-    delete _in;
-#endif
-  }
-}
-
-/**
- *
+ * Reads the entire contents of the file into memory.
  */
 bool CPPPreprocessor::InputFile::
 open(const CPPFile &file) {
-  assert(_in == nullptr);
+  assert(_next == nullptr);
 
   _file = file;
-  pifstream *in = new pifstream;
-  _in = in;
+  pifstream in;
+  if (!_file._filename.open_read(in)) {
+    return false;
+  }
 
-  return _file._filename.open_read(*in);
+  std::streamsize size = _file._filename.get_file_size();
+  if (size > 0) {
+    _input.reserve((size_t)size);
+  }
+
+  char buffer[4096];
+  while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+    _input.append(buffer, (size_t)in.gcount());
+  }
+  if (in.bad()) {
+    return false;
+  }
+
+  remove_carriage_returns(_input);
+  _next = _input.data();
+  _end = _next + _input.size();
+  return true;
 }
 
 /**
@@ -137,11 +152,13 @@ open(const CPPFile &file) {
  */
 bool CPPPreprocessor::InputFile::
 connect_input(const string &input) {
-  assert(_in == nullptr);
+  assert(_next == nullptr);
 
   _input = input;
-  _in = new std::istringstream(_input);
-  return !_in->fail();
+  remove_carriage_returns(_input);
+  _next = _input.data();
+  _end = _next + _input.size();
+  return true;
 }
 
 /**
@@ -149,34 +166,24 @@ connect_input(const string &input) {
  */
 int CPPPreprocessor::InputFile::
 get() {
-  assert(_in != nullptr);
+  assert(_next != nullptr);
 
   if (!_lock_position) {
     _line_number = _next_line_number;
     _col_number = _next_col_number;
   }
 
-  int c = _in->get();
-
-  // Quietly skip over embedded carriage-return characters.  We shouldn't see
-  // any of these unless there was some DOS-to-Unix file conversion problem.
-  while (c == '\r') {
-    c = _in->get();
+  if (_next == _end) {
+    return EOF;
   }
 
-  switch (c) {
-  case EOF:
-    break;
+  int c = (unsigned char)*_next++;
 
-  case '\n':
-    if (!_lock_position) {
+  if (!_lock_position) {
+    if (c == '\n') {
       ++_next_line_number;
       _next_col_number = 1;
-    }
-    break;
-
-  default:
-    if (!_lock_position) {
+    } else {
       ++_next_col_number;
     }
   }
@@ -189,18 +196,81 @@ get() {
  */
 int CPPPreprocessor::InputFile::
 peek() {
-  assert(_in != nullptr);
+  assert(_next != nullptr);
+
+  if (_next == _end) {
+    return EOF;
+  }
+  return (unsigned char)*_next;
+}
 
-  int c = _in->peek();
+/**
+ * Skips ahead to the given position in the buffer, which must be past the
+ * current position.  This has the same effect as calling get() once for each
+ * character in between.
+ */
+void CPPPreprocessor::InputFile::
+advance(const char *to) {
+  assert(to > _next && to <= _end);
 
-  // Quietly skip over embedded carriage-return characters.  We shouldn't see
-  // any of these unless there was some DOS-to-Unix file conversion problem.
-  while (c == '\r') {
-    _in->get();
-    c = _in->peek();
+  if (!_lock_position) {
+    // Count the lines up to the last character, and find its column.
+    const char *last = to - 1;
+    const char *p = _next;
+    const char *line_start = nullptr;
+    while ((p = (const char *)memchr(p, '\n', last - p)) != nullptr) {
+      ++_next_line_number;
+      line_start = ++p;
+    }
+    if (line_start != nullptr) {
+      _next_col_number = 1 + (int)(last - line_start);
+    } else {
+      _next_col_number += (int)(last - _next);
+    }
+
+    _line_number = _next_line_number;
+    _col_number = _next_col_number;
+    if (*last == '\n') {
+      ++_next_line_number;
+      _next_col_number = 1;
+    } else {
+      ++_next_col_number;
+    }
   }
 
-  return c;
+  _next = to;
+}
+
+/**
+ * Refers to a string that stays around for as long as this is in use, such as
+ * the expansion of a manifest without parameters.
+ */
+CPPPreprocessor::PendingExpansion::
+PendingExpansion(const string *str, const CPPManifest *manifest) :
+  _str(str),
+  _pos(0),
+  _manifest(manifest)
+{
+}
+
+/**
+ * Takes ownership of the given string.
+ */
+CPPPreprocessor::PendingExpansion::
+PendingExpansion(string &&str, const CPPManifest *manifest) :
+  _str(nullptr),
+  _owned_str(std::move(str)),
+  _pos(0),
+  _manifest(manifest)
+{
+}
+
+/**
+ * Returns the string being scanned.
+ */
+const string &CPPPreprocessor::PendingExpansion::
+get_str() const {
+  return (_str != nullptr) ? *_str : _owned_str;
 }
 
 /**
@@ -209,6 +279,7 @@ peek() {
 CPPPreprocessor::
 CPPPreprocessor() {
   _noangles = false;
+  _record_include_probes = false;
   _state = S_eof;
   _paren_nesting = 0;
   _parsing_template_params = false;
@@ -738,6 +809,7 @@ push_file(const CPPFile &file) {
     _parsed_files.insert(file);
 
     infile._prev_last_c = _last_c;
+    infile._guard_state = InputFile::GS_start;
     _last_c = '\0';
     _start_of_line = true;
     return true;
@@ -789,88 +861,187 @@ push_string(const string &input, bool lock_position) {
 /**
  * Given a string, expand all manifests within the string and return the new
  * string.
+ *
+ * The string is scanned only once, from left to right.  When a manifest is
+ * found, its expansion is scanned before continuing with the rest of the
+ * string.  A manifest is not expanded again while we are still scanning its
+ * own expansion, so that a manifest that refers to itself is left alone.
  */
 string CPPPreprocessor::
 expand_manifests(const string &input_expr, bool expand_undefined,
                  const YYLTYPE &loc) {
-  // Get a copy of the expression string we can modify.
-  string expr = input_expr;
-
-  // Repeatedly scan the expr for any manifest names or defined() function.
-
-  bool manifest_found;
-  do {
-    manifest_found = false;
-    size_t p = 0;
-    while (p < expr.size()) {
-      if (isalpha(expr[p]) || expr[p] == '_') {
-        size_t q = p;
-        while (p < expr.size() && (isalnum(expr[p]) || expr[p] == '_')) {
-          p++;
-        }
-        string ident = expr.substr(q, p - q);
+  string result;
+  result.reserve(input_expr.size());
 
-        // Here's an identifier.  Is it "defined"?
-        if (ident == "defined") {
-          expand_defined_function(expr, q, p);
-        } else if (expand_undefined && ident == "__has_include") {
-          expand_has_include_function(expr, q, p, loc);
-        } else {
-          // Is it a manifest?
-          Manifests::const_iterator mi = _manifests.find(ident);
-          if (mi != _manifests.end()) {
-            const CPPManifest *manifest = (*mi).second;
-            expand_manifest_inline(expr, q, p, manifest);
-            manifest_found = true;
-
-          } else if (ident == "__FILE__") {
-            // Special case: this is a dynamic definition.
-            string file = string("\"") + loc.file._filename_as_referenced.get_fullpath() + "\"";
-            expr = expr.substr(0, q) + file + expr.substr(p);
-            p = q + file.size();
-            manifest_found = true;
-
-          } else if (ident == "__LINE__") {
-            // So is this.
-            string line = format_string(loc.first_line);
-            expr = expr.substr(0, q) + line + expr.substr(p);
-            p = q + line.size();
-            manifest_found = true;
-
-          } else if (expand_undefined && ident != "true" && ident != "false") {
-            // It is not found.  Expand it to 0, but only if we are currently
-            // parsing an #if expression.
-            expr = expr.substr(0, q) + "0" + expr.substr(p);
-            p = q + 1;
+  PendingExpansions pending;
+  pending.push_back(PendingExpansion(&input_expr, nullptr));
+  expand_pending(pending, expand_undefined, loc, result);
+
+  return result;
+}
+
+/**
+ * Scans the string on top of the stack of pending expansions, and appends it
+ * to result with all manifests expanded.  The manifests that are further down
+ * the stack are not expanded.  On return, the string has been removed from
+ * the stack.
+ */
+void CPPPreprocessor::
+expand_pending(PendingExpansions &pending, bool expand_undefined,
+               const YYLTYPE &loc, string &result) {
+  size_t base = pending.size() - 1;
+
+  while (pending.size() > base) {
+    PendingExpansion &top = pending.back();
+    const string &expr = top.get_str();
+    size_t p = top._pos;
+
+    if (p >= expr.size()) {
+      // We have reached the end of this expansion, so continue with the rest
+      // of the string in which we found the manifest.
+      pending.pop_back();
+      continue;
+    }
+
+    if (!isalpha(expr[p]) && expr[p] != '_') {
+      // Copy everything up to the next identifier.
+      size_t q = p;
+      while (p < expr.size() && !isalpha(expr[p]) && expr[p] != '_') {
+        if (expr[p] == '\'' || expr[p] == '"') {
+          // Skip the next part until we find a closing quotation mark.
+          char quote = expr[p];
+          p++;
+          while (p < expr.size() && expr[p] != quote) {
+            if (expr[p] == '\\') {
+              // This might be an escaped quote.  Skip an extra char.
+              p++;
+            }
+            p++;
           }
-        }
-      } else if (expr[p] == '\'' || expr[p] == '"') {
-        // Skip the next part until we find a closing quotation mark.
-        char quote = expr[p];
-        p++;
-        while (p < expr.size() && expr[p] != quote) {
-          if (expr[p] == '\\') {
-            // This might be an escaped quote.  Skip an extra char.
+          if (p >= expr.size()) {
+            // Unclosed string.
+            warning("missing terminating " + string(1, quote) + " character", loc);
+            p = expr.size();
+          } else {
             p++;
           }
+        } else if (isdigit(expr[p])) {
+          // A number may contain letters, as in 0x10 or 10UL, but these are
+          // not identifiers.
+          p++;
+          while (p < expr.size() && (isalnum(expr[p]) || expr[p] == '_' || expr[p] == '.')) {
+            p++;
+          }
+        } else {
           p++;
         }
-        if (p >= expr.size()) {
-          // Unclosed string.
-          warning("missing terminating " + string(1, quote) + " character", loc);
+      }
+      result.append(expr, q, p - q);
+      top._pos = p;
+      continue;
+    }
+
+    size_t q = p;
+    while (p < expr.size() && (isalnum(expr[p]) || expr[p] == '_')) {
+      p++;
+    }
+    string ident = expr.substr(q, p - q);
+    top._pos = p;
+
+    // Here's an identifier.  Is it "defined"?
+    if (ident == "defined") {
+      result += expand_defined_function(expr, top._pos);
+      continue;
+    }
+    if (expand_undefined && ident == "__has_include") {
+      result += expand_has_include_function(expr, top._pos, loc);
+      continue;
+    }
+
+    // Is it a manifest that we are not already in the middle of expanding?
+    const CPPManifest *manifest = nullptr;
+    Manifests::const_iterator mi = _manifests.find(ident);
+    if (mi != _manifests.end()) {
+      manifest = (*mi).second;
+      for (const PendingExpansion &outer : pending) {
+        if (outer._manifest == manifest) {
+          manifest = nullptr;
+          break;
         }
-        p++;
-      } else {
-        p++;
       }
     }
 
-    // If we expanded any manifests at all that time, then go back through the
-    // string and look again--we might have a manifest that expands to another
-    // manifest.
-  } while (manifest_found);
+    if (manifest != nullptr && manifest->_has_parameters) {
+      // Look for the opening parenthesis.  It may lie beyond the end of the
+      // expansion that the manifest name appeared in.
+      size_t level = pending.size() - 1;
+      size_t next = pending[level]._pos;
+      while (true) {
+        const string &next_expr = pending[level].get_str();
+        while (next < next_expr.size() && isspace(next_expr[next])) {
+          next++;
+        }
+        if (next < next_expr.size() || level == base) {
+          break;
+        }
+        --level;
+        next = pending[level]._pos;
+      }
+
+      const string &next_expr = pending[level].get_str();
+      if (next < next_expr.size() && next_expr[next] == '(') {
+        // We are done with any expansions we skipped past to get here.
+        pending.erase(pending.begin() + level + 1, pending.end());
+        pending[level]._pos = next;
+
+        vector_string args;
+        extract_manifest_args_inline(manifest->_name, manifest->_num_parameters,
+                                     manifest->_variadic_param, args,
+                                     next_expr, pending[level]._pos);
+
+        // The arguments have their manifests expanded before they are
+        // substituted, which is when they may still contain this manifest.
+        vector_string expanded_args;
+        expanded_args.reserve(args.size());
+        for (const string &arg : args) {
+          string expanded_arg;
+          pending.push_back(PendingExpansion(&arg, nullptr));
+          expand_pending(pending, false, loc, expanded_arg);
+          expanded_args.push_back(std::move(expanded_arg));
+        }
+
+        pending.push_back(PendingExpansion(manifest->expand(args, expanded_args), manifest));
+        continue;
+      }
+
+      // Without arguments, it is not expanded.
+      manifest = nullptr;
+    }
+
+    if (manifest != nullptr) {
+      // The expansion of a manifest without parameters is always the same,
+      // so we can scan it right where it is stored.
+      pending.push_back(PendingExpansion(&manifest->get_simple_expansion(), manifest));
+
+    } else if (ident == "__FILE__") {
+      // Special case: this is a dynamic definition.
+      result += '"';
+      result += loc.file._filename_as_referenced.get_fullpath();
+      result += '"';
+
+    } else if (ident == "__LINE__") {
+      // So is this.
+      result += format_string(loc.first_line);
+
+    } else if (expand_undefined && ident != "true" && ident != "false") {
+      // It is not found.  Expand it to 0, but only if we are currently
+      // parsing an #if expression.
+      result += '0';
 
-  return expr;
+    } else {
+      result += ident;
+    }
+  }
 }
 
 /**
@@ -916,6 +1087,14 @@ internal_get_next_token() {
     c = skip_whitespace(process_directive(c));
   }
 
+  if (c != EOF && !_files.empty()) {
+    // A token outside of the include guard means the file isn't guarded.
+    InputFile &infile = _files.back();
+    if (infile._guard_state != InputFile::GS_open) {
+      infile._guard_state = InputFile::GS_none;
+    }
+  }
+
   if (c == '\'') {
     return get_quoted_char(c);
   } else if (c == '"') {
@@ -1165,6 +1344,16 @@ skip_whitespace(int c) {
     if (!isspace(c)) {
       return c;
     }
+
+    // Quickly skip over the rest of a run of whitespace.
+    InputFile *infile = get_scan_input();
+    if (infile != nullptr) {
+      const char *p = infile->_next;
+      while (p != infile->_end && isspace((unsigned char)*p)) {
+        ++p;
+      }
+      skip_to(*infile, p);
+    }
     c = get();
   }
   return c;
@@ -1230,6 +1419,7 @@ skip_c_comment(int c) {
         }
       } else {
         comment->_comment += c;
+        skip_until('*', &comment->_comment);
         c = get();
       }
     }
@@ -1249,6 +1439,7 @@ skip_c_comment(int c) {
           return get();
         }
       } else {
+        skip_until('*', nullptr);
         c = get();
       }
     }
@@ -1302,6 +1493,7 @@ skip_cpp_comment(int c) {
 
     while (c != EOF && c != '\n') {
       comment->_comment += c;
+      skip_until('\n', &comment->_comment);
       c = get();
     }
 
@@ -1312,6 +1504,7 @@ skip_cpp_comment(int c) {
 
   } else {
     while (c != EOF && c != '\n') {
+      skip_until('\n', nullptr);
       c = get();
     }
   }
@@ -1389,6 +1582,10 @@ process_directive(int c) {
     << "#" << command << " " << args << "\n";
 #endif
 
+  if (!_files.empty()) {
+    check_include_guard(_files.back(), command, args);
+  }
+
   if (command == "define") {
     handle_define_directive(args, loc);
   } else if (command == "undef") {
@@ -1650,6 +1847,13 @@ handle_include_directive(const string &args, const YYLTYPE &loc) {
       return;
     }
 
+    // Nor if its include guard is still defined; reading it would only skip
+    // over its contents.
+    IncludeGuards::const_iterator gi = _include_guards.find(filename.get_fullpath());
+    if (gi != _include_guards.end() && is_manifest_defined(gi->second)) {
+      return;
+    }
+
     if (!push_file(file)) {
       warning("Unable to read " + filename.get_fullpath(), loc);
     }
@@ -1710,6 +1914,68 @@ handle_error_directive(const string &args, const YYLTYPE &loc) {
   error(args, loc);
 }
 
+/**
+ * Called for each directive in the given file, before it is processed, to
+ * detect whether the file is wrapped in an include guard, like this:
+ *
+ * #ifndef FOO_H
+ * #define FOO_H
+ * ...
+ * #endif
+ *
+ * As in other compilers, this only counts if there is nothing but whitespace
+ * and comments outside of the #ifndef block, and the block has no #else.
+ */
+void CPPPreprocessor::
+check_include_guard(InputFile &infile, const string &command, const string &args) {
+  if (infile._guard_state == InputFile::GS_start) {
+    // This is the first directive in the file.  Is it #ifndef FOO_H or #if
+    // !defined(FOO_H), with FOO_H not yet defined?
+    string macro;
+    if (command == "ifndef") {
+      macro = trim_blanks(args);
+    } else if (command == "if") {
+      // Nothing may follow the macro name, or the condition is something
+      // more than an include guard, such as !defined(FOO_H) || defined(BAR).
+      char name[256];
+      char close[2];
+      char rest[2];
+      if (sscanf(args.c_str(), " ! defined ( %255[A-Za-z0-9_] %1[)] %1s", name, close, rest) == 2 ||
+          sscanf(args.c_str(), " ! defined %255[A-Za-z0-9_] %1s", name, rest) == 1) {
+        macro = name;
+      }
+    }
+    if (macro.empty() || is_manifest_defined(macro)) {
+      infile._guard_state = InputFile::GS_none;
+      return;
+    }
+    infile._guard_state = InputFile::GS_open;
+    infile._guard_macro = macro;
+    infile._if_nesting = 0;
+
+  } else if (infile._guard_state != InputFile::GS_open) {
+    infile._guard_state = InputFile::GS_none;
+    return;
+  }
+
+  // Keep track of the nesting of conditional blocks, to find the #endif that
+  // closes the guard.  The #endif of a block that is skipped is found by
+  // skip_false_if_block(), which decrements _if_nesting for it.
+  if (command == "if" || command == "ifdef" || command == "ifndef") {
+    ++infile._if_nesting;
+
+  } else if (command == "else" || command == "elif") {
+    if (infile._if_nesting == 1) {
+      infile._guard_state = InputFile::GS_none;
+    }
+
+  } else if (command == "endif") {
+    if (--infile._if_nesting == 0) {
+      infile._guard_state = InputFile::GS_closed;
+    }
+  }
+}
+
 /**
  * We come here when we fail an #if or an #ifdef test, or when we reach the
  * #else clause to something we didn't fail.  This function skips all text up
@@ -1718,6 +1984,7 @@ handle_error_directive(const string &args, const YYLTYPE &loc) {
 void CPPPreprocessor::
 skip_false_if_block(bool consider_elifs) {
   int level = 0;
+  size_t num_files = _files.size();
   _save_comments = false;
 
   int c = skip_comment(get());
@@ -1756,6 +2023,12 @@ skip_false_if_block(bool consider_elifs) {
         // Skip any args.
         if (level == 0) {
           // Here's the end!
+          if (_files.size() == num_files) {
+            InputFile &infile = _files.back();
+            if (infile._guard_state == InputFile::GS_open && --infile._if_nesting == 0) {
+              infile._guard_state = InputFile::GS_closed;
+            }
+          }
           _save_comments = true;
           return;
         }
@@ -1796,14 +2069,18 @@ bool CPPPreprocessor::
 find_include(Filename &filename, bool angle_quotes, CPPFile::Source &source) {
   // Now look for the filename.  If we didn't use angle quotes, look first in
   // the current directory.
-  if (!angle_quotes && filename.exists()) {
-    source = CPPFile::S_local;
-    return true;
+  if (!angle_quotes) {
+    record_include_probe(filename);
+    if (filename.exists()) {
+      source = CPPFile::S_local;
+      return true;
+    }
   }
 
   // Search the same directory as the includer.
   if (!angle_quotes) {
     Filename match(get_file()._filename.get_dirname(), filename);
+    record_include_probe(match);
     if (match.exists()) {
       filename = match;
       source = CPPFile::S_alternate;
@@ -1812,15 +2089,35 @@ find_include(Filename &filename, bool angle_quotes, CPPFile::Source &source) {
   }
 
   // Now search the angle-include-path
-  if (angle_quotes && filename.resolve_filename(_angle_include_path)) {
-    source = CPPFile::S_system;
-    return true;
+  if (angle_quotes) {
+    Filename original(filename);
+    bool found = filename.resolve_filename(_angle_include_path);
+    if (_record_include_probes) {
+      // The search path may have been indexed, so we work out for ourselves
+      // which directories it must have looked in.
+      if (original.is_local()) {
+        for (size_t dir = 0; dir < _angle_include_path.get_num_directories(); ++dir) {
+          Filename match(_angle_include_path.get_directory(dir), original);
+          record_include_probe(match);
+          if (found && match == filename) {
+            break;
+          }
+        }
+      } else {
+        record_include_probe(original);
+      }
+    }
+    if (found) {
+      source = CPPFile::S_system;
+      return true;
+    }
   }
 
   // Now search the quote-include-path
   if (!angle_quotes) {
     for (size_t dir = 0; dir < _quote_include_path.get_num_directories(); ++dir) {
       Filename match(_quote_include_path.get_directory(dir), filename);
+      record_include_probe(match);
       if (match.exists()) {
         filename = match;
         source = _quote_include_kind[dir];
@@ -1832,6 +2129,16 @@ find_include(Filename &filename, bool angle_quotes, CPPFile::Source &source) {
   return false;
 }
 
+/**
+ * Called by find_include() for each filename that it tries.
+ */
+void CPPPreprocessor::
+record_include_probe(const Filename &filename) {
+  if (_record_include_probes) {
+    _include_probes.insert(filename.get_fullpath());
+  }
+}
+
 /**
  *
  */
@@ -1882,6 +2189,17 @@ get_identifier(int c) {
 
   string name(1, (char)c);
 
+  // Take as much of the identifier as we can directly from the buffer.
+  InputFile *infile = get_scan_input();
+  if (infile != nullptr) {
+    const char *p = infile->_next;
+    while (p != infile->_end && (isalnum((unsigned char)*p) || *p == '_')) {
+      ++p;
+    }
+    name.append(infile->_next, p - infile->_next);
+    skip_to(*infile, p);
+  }
+
   c = peek();
   while (c != EOF && (isalnum(c) || c == '_')) {
     name += get();
@@ -2159,15 +2477,18 @@ get_literal(int token, YYLTYPE loc, const string &str, const YYSTYPE &value) {
  */
 CPPToken CPPPreprocessor::
 expand_manifest(const CPPManifest *manifest) {
-  vector_string args;
+  string expanded(1, ' ');
 
   if (manifest->_has_parameters) {
     // Hmm, we're expecting arguments.
+    vector_string args;
     extract_manifest_args(manifest->_name, manifest->_num_parameters,
                           manifest->_variadic_param, args);
+    expanded += manifest->expand(args);
+  } else {
+    expanded += manifest->get_simple_expansion();
   }
-
-  string expanded = " " + manifest->expand(args) + " ";
+  expanded += ' ';
   push_string(expanded, true);
 
   if (!manifest->_has_parameters) {
@@ -2300,34 +2621,34 @@ extract_manifest_args(const string &name, int num_args, int va_arg,
 
 /**
  * Expands the defined(manifest) function to either 1 or 0, depending on
- * whether the manifest exists.
+ * whether the manifest exists.  On entry, p indicates the character following
+ * "defined"; on return, it indicates the character following the argument.
  */
-void CPPPreprocessor::
-expand_defined_function(string &expr, size_t q, size_t &p) {
-  string result;
-
+string CPPPreprocessor::
+expand_defined_function(const string &expr, size_t &p) {
   vector_string args;
   extract_manifest_args_inline("defined", 1, -1, args, expr, p);
   if (args.size() >= 1) {
     if (is_manifest_defined(args[0])) {
       // The macro is defined; the result is "1".
-      result = "1";
+      return "1";
     } else {
       // The macro is undefined; the result is "0".
-      result = "0";
+      return "0";
     }
   }
 
-  expr = expr.substr(0, q) + result + expr.substr(p);
-  p = q + result.size();
+  return string();
 }
 
 /**
  * Expands the __has_include(manifest) function to either 1 or 0, depending on
- * whether the include file exists.
+ * whether the include file exists.  On entry, p indicates the character
+ * following "__has_include"; on return, it indicates the character following
+ * the argument.
  */
-void CPPPreprocessor::
-expand_has_include_function(string &expr, size_t q, size_t &p, YYLTYPE loc) {
+string CPPPreprocessor::
+expand_has_include_function(const string &expr, size_t &p, YYLTYPE loc) {
   bool found_file = false;
 
   // Skip whitespace till paren.
@@ -2366,9 +2687,7 @@ expand_has_include_function(string &expr, size_t q, size_t &p, YYLTYPE loc) {
       loc.last_column += loc.first_column + p - 2;
       loc.first_column += args_begin;
       warning("invalid argument for __has_include() directive", loc);
-      expr = expr.substr(0, q) + "0" + expr.substr(p);
-      p = q + 1;
-      return;
+      return "0";
     }
 
     filename.set_text();
@@ -2381,26 +2700,7 @@ expand_has_include_function(string &expr, size_t q, size_t &p, YYLTYPE loc) {
     warning("invalid argument for __has_include() directive", loc);
   }
 
-  string result = found_file ? "1" : "0";
-  expr = expr.substr(0, q) + result + expr.substr(p);
-  p = q + result.size();
-}
-
-/**
- *
- */
-void CPPPreprocessor::
-expand_manifest_inline(string &expr, size_t q, size_t &p,
-                       const CPPManifest *manifest) {
-  vector_string args;
-  if (manifest->_has_parameters) {
-    extract_manifest_args_inline(manifest->_name, manifest->_num_parameters,
-                                 manifest->_variadic_param, args, expr, p);
-  }
-  string result = manifest->expand(args);
-
-  expr = expr.substr(0, q) + result + expr.substr(p);
-  p = q + result.size();
+  return found_file ? "1" : "0";
 }
 
 /**
@@ -2907,6 +3207,10 @@ get() {
     indent(cerr, _files.size() * 2)
       << "End of input stream, restoring to previous input\n";
 #endif
+    InputFile &infile = _files.back();
+    if (infile._guard_state == InputFile::GS_closed) {
+      _include_guards[infile._file._filename.get_fullpath()] = infile._guard_macro;
+    }
     _files.pop_back();
 
     // Synthesize a newline, just in case the file doesn't already end with
@@ -2963,6 +3267,72 @@ unget(int c) {
   _unget = c;
 }
 
+/**
+ * Returns the input file that the next call to get() will read from, if the
+ * characters it returns may be taken directly from the file's buffer instead,
+ * or NULL if they may not.  This is used to quickly skip over runs of
+ * characters that need no further processing.
+ */
+CPPPreprocessor::InputFile *CPPPreprocessor::
+get_scan_input() {
+  if (_unget != '\0' || _files.empty()) {
+    return nullptr;
+  }
+  InputFile &infile = _files.back();
+  if (infile._next == infile._end) {
+    return nullptr;
+  }
+  return &infile;
+}
+
+/**
+ * Consumes the characters of the given input file, which must have been
+ * returned by get_scan_input(), up to the given position in its buffer.  This
+ * has the same effect as calling get() for each of them.
+ */
+void CPPPreprocessor::
+skip_to(InputFile &infile, const char *to) {
+  if (to == infile._next) {
+    return;
+  }
+
+  // Only the last newline or non-blank character matters to _start_of_line.
+  const char *p = to;
+  while (p != infile._next) {
+    int c = (unsigned char)*--p;
+    if (c == '\n') {
+      _start_of_line = true;
+      break;
+    } else if (!isspace(c) && c != '#') {
+      _start_of_line = false;
+      break;
+    }
+  }
+
+  infile.advance(to);
+}
+
+/**
+ * Consumes the characters up to the next occurrence of the given character in
+ * the current input file, not including that character itself, and appends
+ * them to the given string if it is not NULL.  The next call to get() will
+ * return either the given character or the end of the input.
+ */
+void CPPPreprocessor::
+skip_until(char delim, string *text) {
+  InputFile *infile = get_scan_input();
+  if (infile != nullptr) {
+    const char *to = (const char *)memchr(infile->_next, delim, infile->_end - infile->_next);
+    if (to == nullptr) {
+      to = infile->_end;
+    }
+    if (text != nullptr) {
+      text->append(infile->_next, to - infile->_next);
+    }
+    skip_to(*infile, to);
+  }
+}
+
 /**
  * Recursively invokes yacc to parse the stuff within angle brackets that's
  * the template instantiation part of an identifier.  This involves setting
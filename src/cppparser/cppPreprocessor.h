@@ -85,12 +85,25 @@ public:
   typedef std::set<CPPFile> ParsedFiles;
   ParsedFiles _parsed_files;
 
+  // The macro that guards each file that was found to be wrapped entirely in
+  // an #ifndef block, by the name of the file.  Such a file need not be read
+  // again as long as that macro is defined.
+  typedef std::map<std::string, std::string> IncludeGuards;
+  IncludeGuards _include_guards;
+
   typedef std::set<std::string> Includes;
   Includes _quote_includes;
   Includes _angle_includes;
 
   std::set<Filename> _explicit_files;
 
+  // If _record_include_probes is set, every filename that was tried while
+  // looking for an #include file, whether or not it existed, is added to
+  // _include_probes.  A file appearing at or disappearing from any of these
+  // could change which file is included.
+  bool _record_include_probes;
+  Includes _include_probes;
+
   // This is normally true, to indicate that the preprocessor should decode
   // identifiers like foo::bar<snarf> into a single IDENTIFIER,
   // TYPENAME_IDENTIFIER, or SCOPING token for yacc's convenience.  When
@@ -145,6 +158,7 @@ private:
   void skip_false_if_block(bool consider_elifs);
   bool is_manifest_defined(const std::string &manifest_name);
   bool find_include(Filename &filename, bool angle_quotes, CPPFile::Source &source);
+  void record_include_probe(const Filename &filename);
 
   CPPToken get_quoted_char(int c);
   CPPToken get_quoted_string(int c);
@@ -154,10 +168,9 @@ private:
   CPPToken expand_manifest(const CPPManifest *manifest);
   void extract_manifest_args(const std::string &name, int num_args,
                              int va_arg, vector_string &args);
-  void expand_defined_function(std::string &expr, size_t q, size_t &p);
-  void expand_has_include_function(std::string &expr, size_t q, size_t &p, YYLTYPE loc);
-  void expand_manifest_inline(std::string &expr, size_t q, size_t &p,
-                              const CPPManifest *manifest);
+  std::string expand_defined_function(const std::string &expr, size_t &p);
+  std::string expand_has_include_function(const std::string &expr, size_t &p,
+                                          YYLTYPE loc);
   void extract_manifest_args_inline(const std::string &name, int num_args,
                                     int va_arg, vector_string &args,
                                     const std::string &expr, size_t &p);
@@ -180,27 +193,69 @@ private:
   void skip_to_end_nested();
   void skip_to_angle_bracket();
 
+  // The entire contents of each file are read into memory up front, so that
+  // they can be scanned with pointer arithmetic.  Carriage returns are
+  // removed while reading.
   class InputFile {
   public:
     InputFile();
-    ~InputFile();
 
     bool open(const CPPFile &file);
     bool connect_input(const std::string &input);
     int get();
     int peek();
+    void advance(const char *to);
 
     const CPPManifest *_ignore_manifest;
     CPPFile _file;
     std::string _input;
-    std::istream *_in;
+    const char *_next;
+    const char *_end;
     int _line_number;
     int _col_number;
     int _next_line_number;
     int _next_col_number;
     bool _lock_position;
     int _prev_last_c;
+
+    // Tracks whether the file is wrapped in an include guard.
+    enum GuardState {
+      GS_start,  // Nothing but whitespace and comments read so far.
+      GS_open,   // Inside the #ifndef block of _guard_macro.
+      GS_closed, // Past the #endif of that block; nothing else so far.
+      GS_none,   // The file is not guarded.
+    };
+    GuardState _guard_state;
+    std::string _guard_macro;
+    int _if_nesting;
+  };
+
+  // This is used by expand_manifests() to keep track of the strings it is in
+  // the middle of scanning: the original expression, and the expansion of
+  // each manifest found in it, which is scanned before continuing with the
+  // rest of the string it was found in.
+  class PendingExpansion {
+  public:
+    PendingExpansion(const std::string *str, const CPPManifest *manifest);
+    PendingExpansion(std::string &&str, const CPPManifest *manifest);
+
+    const std::string &get_str() const;
+
+    const std::string *_str;
+    std::string _owned_str;
+    size_t _pos;
+    const CPPManifest *_manifest;
   };
+  typedef std::vector<PendingExpansion> PendingExpansions;
+
+  void expand_pending(PendingExpansions &pending, bool expand_undefined,
+                      const YYLTYPE &loc, std::string &result);
+
+  InputFile *get_scan_input();
+  void skip_to(InputFile &infile, const char *to);
+  void skip_until(char delim, std::string *text);
+  void check_include_guard(InputFile &infile, const std::string &command,
+                           const std::string &args);
 
   // This must be a list and not a vector because we don't have a good copy
   // constructor defined for InputFile.
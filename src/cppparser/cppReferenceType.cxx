@@ -14,6 +14,7 @@
 #include "cppReferenceType.h"
 #include "cppTypedefType.h"
 #include "cppStructType.h"
+#include "stl_compares.h"
 
 /**
  *
@@ -237,6 +238,15 @@ output_instance(std::ostream &out, int indent_level, CPPScope *scope,
   }
 }
 
+/**
+ *
+ */
+size_t CPPReferenceType::
+add_hash(size_t hash) const {
+  hash = integer_hash<int>::add_hash(hash, (int)_value_category);
+  return pointer_hash::add_hash(hash, _pointing_at);
+}
+
 /**
  *
  */
@@ -57,6 +57,7 @@ public:
                                bool complete, const std::string &prename,
                                const std::string &name) const;
 
+  virtual size_t add_hash(size_t hash) const;
   virtual SubType get_subtype() const;
 
   virtual CPPReferenceType *as_reference_type();
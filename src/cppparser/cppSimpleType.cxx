@@ -13,6 +13,7 @@
 
 #include "cppSimpleType.h"
 #include "cppGlobals.h"
+#include "stl_compares.h"
 
 /**
  *
@@ -226,6 +227,15 @@ output(std::ostream &out, int, CPPScope *, bool) const {
   }
 }
 
+/**
+ *
+ */
+size_t CPPSimpleType::
+add_hash(size_t hash) const {
+  hash = integer_hash<int>::add_hash(hash, (int)_type);
+  return integer_hash<int>::add_hash(hash, _flags);
+}
+
 /**
  *
  */
@@ -15,6 +15,7 @@
 #include "cppIdentifier.h"
 
 #include "cppSimpleType.h"
+#include "stl_compares.h"
 
 /**
  *
@@ -132,6 +133,14 @@ output(std::ostream &out, int, CPPScope *, bool) const {
   out /* << "typename " */ << *_ident;
 }
 
+/**
+ *
+ */
+size_t CPPTBDType::
+add_hash(size_t hash) const {
+  return _ident->add_hash(hash);
+}
+
 /**
  *
  */
@@ -45,6 +45,7 @@ public:
 
   virtual void output(std::ostream &out, int indent_level, CPPScope *scope,
                       bool complete) const;
+  virtual size_t add_hash(size_t hash) const;
   virtual SubType get_subtype() const;
 
   virtual CPPTBDType *as_tbd_type();
@@ -15,6 +15,7 @@
 #include "cppClassTemplateParameter.h"
 #include "cppInstance.h"
 #include "cppExpression.h"
+#include "stl_compares.h"
 
 /**
  *
@@ -168,6 +169,28 @@ operator < (const CPPTemplateParameterList &other) const {
   return false;
 }
 
+/**
+ * Adds a hash of the parameters into the running hash.  This is consistent
+ * with operator ==, which compares the parameters structurally.
+ */
+size_t CPPTemplateParameterList::
+add_hash(size_t hash) const {
+  for (CPPDeclaration *param : _parameters) {
+    hash = integer_hash<int>::add_hash(hash, (int)param->get_subtype());
+
+    CPPType *type = param->as_type();
+    CPPExpression *expr = param->as_expression();
+    if (type != nullptr) {
+      hash = type->add_hash(hash);
+    } else if (expr != nullptr) {
+      hash = expr->add_hash(hash);
+    } else {
+      hash = pointer_hash::add_hash(hash, param);
+    }
+  }
+  return hash;
+}
+
 /**
  *
  */
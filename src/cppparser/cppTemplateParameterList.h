@@ -44,6 +44,7 @@ public:
   bool operator == (const CPPTemplateParameterList &other) const;
   bool operator != (const CPPTemplateParameterList &other) const;
   bool operator < (const CPPTemplateParameterList &other) const;
+  size_t add_hash(size_t hash) const;
 
   CPPTemplateParameterList *substitute_decl(CPPDeclaration::SubstDecl &subst,
                                             CPPScope *current_scope,
@@ -18,17 +18,23 @@
 #include "cppStructType.h"
 #include "cppTypedefType.h"
 #include "cppExtensionType.h"
+#include "stl_compares.h"
 #include <algorithm>
 
 using std::string;
 
-CPPType::Types CPPType::_types;
-CPPType::PreferredNames CPPType::_preferred_names;
-CPPType::AltNames CPPType::_alt_names;
+thread_local CPPType::Types CPPType::_types;
+thread_local CPPType::PreferredNames CPPType::_preferred_names;
+thread_local CPPType::AltNames CPPType::_alt_names;
 
-bool CPPTypeCompare::
+size_t CPPTypeHash::
+operator () (CPPType *type) const {
+  return type->_hash;
+}
+
+bool CPPTypeEqual::
 operator () (CPPType *a, CPPType *b) const {
-  return (*a) < (*b);
+  return !((*a) < (*b)) && !((*b) < (*a));
 }
 
 /**
@@ -42,6 +48,8 @@ CPPType(const CPPFile &file) :
 
   // This is set true by interrogate when the "forcetype" keyword is used.
   _forcetype = false;
+
+  _hash = 0;
 }
 
 /**
@@ -448,14 +456,37 @@ as_type() {
 }
 
 
+/**
+ * Adds a hash of this type into the running hash, and returns the result.
+ * Types that compare equal must add the same value, so this should only look
+ * at what is_equal() and is_less() look at.  The default implementation hashes
+ * the pointer, which suits types that are only ever equal to themselves.
+ */
+size_t CPPType::
+add_hash(size_t hash) const {
+  return pointer_hash::add_hash(hash, this);
+}
+
 /**
  * This should be called whenever a new CPPType object is created.  It will
  * uniquify the type pointers by checking to see if some equivalent CPPType
  * object has previously been created; if it has, it returns the old object
  * and deletes the new one.  Otherwise, it stores the new one and returns it.
+ *
+ * Types are only unique within the thread that created them; a type should
+ * not be passed to new_type() on a different thread.
  */
 CPPType *CPPType::
 new_type(CPPType *type) {
+  if (type->get_subtype() == ST_typedef) {
+    // Typedefs are only ever the same as themselves in this table (see
+    // CPPTypedefType::is_less()), even though is_equal() compares them by
+    // structure, so there is no use hashing the structure here.
+    type->_hash = pointer_hash::add_hash(ST_typedef, type);
+  } else {
+    type->_hash = type->add_hash((size_t)type->get_subtype());
+  }
+
   std::pair<Types::iterator, bool> result = _types.insert(type);
   if (result.second) {
     // The insertion has taken place; thus, this is the first time this type
@@ -467,6 +498,7 @@ new_type(CPPType *type) {
   // If this triggers, we probably messed up by defining is_less()
   // incorrectly; they provide a relative ordering even though they are equal
   // to each other.  Or, we provided an is_equal() that gives false negatives.
+  // An add_hash() that disagrees with them will instead cause duplicates.
   assert(**result.first == *type);
 
   // The insertion has not taken place; thus, there was previously another
@@ -18,15 +18,21 @@
 
 #include "cppDeclaration.h"
 
-#include <set>
+#include <unordered_set>
 
 class CPPType;
 class CPPTypedefType;
 class CPPTypeDeclaration;
 
 
-// This is an STL function object used to uniquely order CPPType pointers.
-class CPPTypeCompare {
+// These are STL function objects used to store unique CPPType pointers in a
+// hash table.  Two types are the same if neither one sorts before the other.
+class CPPTypeHash {
+public:
+  size_t operator () (CPPType *type) const;
+};
+
+class CPPTypeEqual {
 public:
   bool operator () (CPPType *a, CPPType *b) const;
 };
@@ -90,6 +96,7 @@ public:
 
   virtual CPPType *as_type();
 
+  virtual size_t add_hash(size_t hash) const;
 
   static CPPType *new_type(CPPType *type);
 
@@ -100,15 +107,22 @@ public:
   bool _forcetype;
 
 protected:
-  typedef std::set<CPPType *, CPPTypeCompare> Types;
-  static Types _types;
+  // This is computed by new_type(), so that looking up a type in _types only
+  // needs to compare the types whose hashes match.
+  size_t _hash;
+  friend class CPPTypeHash;
+
+  // These are kept per thread, like the rest of the parser state, so that
+  // each thread that parses has its own set of unique types.
+  typedef std::unordered_set<CPPType *, CPPTypeHash, CPPTypeEqual> Types;
+  static thread_local Types _types;
 
   typedef std::map<std::string, std::string> PreferredNames;
-  static PreferredNames _preferred_names;
+  static thread_local PreferredNames _preferred_names;
 
   typedef std::vector<std::string> Names;
   typedef std::map<std::string, Names> AltNames;
-  static AltNames _alt_names;
+  static thread_local AltNames _alt_names;
 };
 
 #endif
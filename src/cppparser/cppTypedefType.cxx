@@ -16,6 +16,7 @@
 #include "cppInstanceIdentifier.h"
 #include "cppTemplateScope.h"
 #include "indent.h"
+#include "stl_compares.h"
 
 using std::string;
 
@@ -399,6 +400,17 @@ output(std::ostream &out, int indent_level, CPPScope *scope, bool complete) cons
   }
 }
 
+/**
+ * This is consistent with is_equal(), which compares typedefs structurally.
+ * See also new_type(), which only uses the pointer.
+ */
+size_t CPPTypedefType::
+add_hash(size_t hash) const {
+  hash = _type->add_hash(hash);
+  hash = _ident->add_hash(hash);
+  return integer_hash<int>::add_hash(hash, _using);
+}
+
 /**
  *
  */
@@ -12,10 +12,14 @@
   #define SOURCES \
     config_dtoolutil.h \
     dSearchPath.I dSearchPath.h \
-    executionEnvironment.I executionEnvironment.h filename.I  \
-    filename.h \
+    executionEnvironment.I executionEnvironment.h \
+    fileStatCache.I fileStatCache.h \
+    filename.I filename.h \
     $[if $[IS_OSX],filename_assist.mm filename_assist.h,] \
+    globMatcher.I globMatcher.h \
     globPattern.I globPattern.h \
+    incrementalTextDecoder.I incrementalTextDecoder.h \
+    incrementalTextEncoder.I incrementalTextEncoder.h \
     lineStream.I lineStream.h \
     lineStreamBuf.I lineStreamBuf.h \
     load_dso.h \
@@ -28,6 +32,7 @@
     string_utils.h string_utils.I \
     stringDecoder.h stringDecoder.I \
     textEncoder.h textEncoder.I \
+    transcodeStream.h transcodeStream.I transcodeStreamBuf.h \
     unicodeLatinMap.h \
     vector_double.h \
     vector_float.h \
@@ -41,8 +46,9 @@
   #define COMPOSITE_SOURCES \
     config_dtoolutil.cxx \
     dSearchPath.cxx \
-    executionEnvironment.cxx filename.cxx \
-    globPattern.cxx \
+    executionEnvironment.cxx fileStatCache.cxx filename.cxx \
+    globMatcher.cxx globPattern.cxx \
+    incrementalTextDecoder.cxx incrementalTextEncoder.cxx \
     lineStream.cxx lineStreamBuf.cxx \
     load_dso.cxx  \
     pandaFileStream.cxx pandaFileStreamBuf.cxx \
@@ -53,6 +59,7 @@
     string_utils.cxx \
     stringDecoder.cxx \
     textEncoder.cxx \
+    transcodeStream.cxx transcodeStreamBuf.cxx \
     unicodeLatinMap.cxx \
     vector_double.cxx \
     vector_float.cxx \
@@ -64,10 +71,14 @@
   #define INSTALL_HEADERS \
     config_dtoolutil.h \
     dSearchPath.I dSearchPath.h \
-    executionEnvironment.I executionEnvironment.h filename.I  \
-    filename.h \
+    executionEnvironment.I executionEnvironment.h \
+    fileStatCache.I fileStatCache.h \
+    filename.I filename.h \
     filename_assist.h \
+    globMatcher.I globMatcher.h \
     globPattern.I globPattern.h \
+    incrementalTextDecoder.I incrementalTextDecoder.h \
+    incrementalTextEncoder.I incrementalTextEncoder.h \
     lineStream.I lineStream.h \
     lineStreamBuf.I lineStreamBuf.h \
     load_dso.h \
@@ -80,6 +91,7 @@
     string_utils.h string_utils.I \
     stringDecoder.h stringDecoder.I \
     textEncoder.h textEncoder.I \
+    transcodeStream.h transcodeStream.I transcodeStreamBuf.h \
     unicodeLatinMap.h \
     vector_double.h \
     vector_float.h \
@@ -105,3 +117,52 @@
 
   #define SOURCES test_touch.cxx
 #end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_copy
+  #define LOCAL_LIBS dtoolbase dtoolutil
+
+  #define SOURCES test_copy.cxx
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_dsearchpath
+  #define LOCAL_LIBS dtoolbase dtoolutil
+
+  #define SOURCES test_dsearchpath.cxx
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_filestatcache
+  #define LOCAL_LIBS dtoolbase dtoolutil
+
+  #define SOURCES test_filestatcache.cxx
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_glob
+  #define LOCAL_LIBS dtoolbase dtoolutil
+
+  #define SOURCES test_glob.cxx
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_globmatcher
+  #define LOCAL_LIBS dtoolbase dtoolutil
+
+  #define SOURCES test_globmatcher.cxx
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_textencoder
+  #define LOCAL_LIBS dtoolbase dtoolutil
+
+  #define SOURCES test_textencoder.cxx
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_transcode
+  #define LOCAL_LIBS dtoolbase dtoolutil
+
+  #define SOURCES test_transcode.cxx
+#end test_bin_target
@@ -14,12 +14,39 @@
 #include "dSearchPath.h"
 #include "filename.h"
 
+#include "string_utils.h"
+
 #include <algorithm>
+#include <chrono>
 #include <iterator>
 
 using std::ostream;
 using std::string;
 
+/**
+ * Returns a monotonically increasing time in seconds, used for scheduling
+ * index checks.
+ */
+static double
+get_index_time() {
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Returns the key under which the indicated directory entry is stored in the
+ * index.  On filesystems that are usually case-insensitive, this folds the
+ * case so that lookups behave as exists() would.
+ */
+static string
+get_index_key(const string &name) {
+#if defined(_WIN32) || defined(IS_OSX)
+  return downcase(name);
+#else
+  return name;
+#endif
+}
+
 /**
  *
  */
@@ -120,7 +147,10 @@ write(ostream &out, int indent_level) const {
  *
  */
 DSearchPath::
-DSearchPath(const string &path, const string &separator) {
+DSearchPath(const string &path, const string &separator) :
+  _index(nullptr),
+  _index_check_interval(1.0)
+{
   append_path(path, separator);
 }
 
@@ -128,16 +158,67 @@ DSearchPath(const string &path, const string &separator) {
  *
  */
 DSearchPath::
-DSearchPath(const Filename &directory) {
+DSearchPath(const Filename &directory) :
+  _index(nullptr),
+  _index_check_interval(1.0)
+{
   append_directory(directory);
 }
 
+/**
+ * The copy is indexed if the original is, but builds its own index when it is
+ * first searched.
+ */
+DSearchPath::
+DSearchPath(const DSearchPath &copy) :
+  _directories(copy._directories),
+  _index(nullptr),
+  _index_check_interval(copy._index_check_interval)
+{
+  set_indexed(copy.is_indexed());
+}
+
+/**
+ *
+ */
+DSearchPath::
+~DSearchPath() {
+  delete _index;
+}
+
+/**
+ *
+ */
+DSearchPath &DSearchPath::
+operator = (const DSearchPath &copy) {
+  if (this != &copy) {
+    _directories = copy._directories;
+    _index_check_interval = copy._index_check_interval;
+    set_indexed(copy.is_indexed());
+    invalidate_index();
+  }
+  return *this;
+}
+
+/**
+ *
+ */
+DSearchPath &DSearchPath::
+operator = (DSearchPath &&from) noexcept {
+  _directories = std::move(from._directories);
+  _index_check_interval = from._index_check_interval;
+  std::swap(_index, from._index);
+  from.invalidate_index();
+  return *this;
+}
+
 /**
  * Removes all the directories from the search list.
  */
 void DSearchPath::
 clear() {
   _directories.clear();
+  invalidate_index();
 }
 
 /**
@@ -146,6 +227,7 @@ clear() {
 void DSearchPath::
 append_directory(const Filename &directory) {
   _directories.push_back(directory);
+  invalidate_index();
 }
 
 /**
@@ -154,6 +236,7 @@ append_directory(const Filename &directory) {
 void DSearchPath::
 prepend_directory(const Filename &directory) {
   _directories.insert(_directories.begin(), directory);
+  invalidate_index();
 }
 
 /**
@@ -176,13 +259,14 @@ append_path(const string &path, const string &separator) {
       size_t q = path.find_first_of(pathsep, p);
       if (q == string::npos) {
         _directories.push_back(Filename::from_os_specific(path.substr(p)));
-        return;
+        break;
       }
       if (q != p) {
         _directories.push_back(Filename::from_os_specific(path.substr(p, q - p)));
       }
       p = q + 1;
     }
+    invalidate_index();
   }
 }
 
@@ -194,6 +278,7 @@ void DSearchPath::
 append_path(const DSearchPath &path) {
   std::copy(path._directories.begin(), path._directories.end(),
             std::back_inserter(_directories));
+  invalidate_index();
 }
 
 /**
@@ -207,6 +292,62 @@ prepend_path(const DSearchPath &path) {
     std::copy(_directories.begin(), _directories.end(),
               std::back_inserter(new_directories));
     _directories.swap(new_directories);
+    invalidate_index();
+  }
+}
+
+/**
+ * Enables or disables indexed mode.  In indexed mode, the first lookup lists
+ * the contents of every directory on the search path and remembers them, and
+ * subsequent lookups are answered from memory instead of probing each
+ * directory in turn.  This is worthwhile for long search paths that are
+ * searched many times.
+ *
+ * The index is rebuilt when the search path is modified, when
+ * invalidate_index() is called, or when one of the directories is found to
+ * have been modified; see set_index_check_interval().
+ *
+ * Files whose names begin with a dot are not listed by
+ * Filename::scan_directory(), so lookups for those always probe the
+ * filesystem.
+ */
+void DSearchPath::
+set_indexed(bool indexed) {
+  if (indexed && _index == nullptr) {
+    _index = new Index;
+  } else if (!indexed && _index != nullptr) {
+    delete _index;
+    _index = nullptr;
+  }
+}
+
+/**
+ * Specifies how often, in seconds, an indexed search path checks whether any
+ * of its directories have been modified since they were listed.  A value of 0
+ * checks on every lookup; a negative value never checks, in which case
+ * invalidate_index() must be called explicitly when the directories change.
+ */
+void DSearchPath::
+set_index_check_interval(double interval) {
+  _index_check_interval = interval;
+  if (_index != nullptr) {
+    _index->_lock.lock();
+    _index->_next_check = 0.0;
+    _index->_lock.unlock();
+  }
+}
+
+/**
+ * Discards the directory listings of an indexed search path, so that they
+ * will be read again on the next lookup.  This has no effect if the search
+ * path is not indexed.
+ */
+void DSearchPath::
+invalidate_index() {
+  if (_index != nullptr) {
+    _index->_lock.lock();
+    _index->_valid = false;
+    _index->_lock.unlock();
   }
 }
 
@@ -242,6 +383,9 @@ get_directory(size_t n) const {
  */
 Filename DSearchPath::
 find_file(const Filename &filename) const {
+  Candidates candidates;
+  bool verify;
+
   if (filename.is_local()) {
     if (_directories.empty()) {
       // Let's say an empty search path is the same as a search path
@@ -250,6 +394,16 @@ find_file(const Filename &filename) const {
         return filename;
       }
 
+    } else if (get_candidates(filename, candidates, verify)) {
+      // Only the directories listed in the index can contain the file.
+      Candidates::const_iterator ci;
+      for (ci = candidates.begin(); ci != candidates.end(); ++ci) {
+        Filename match(_directories[*ci], filename);
+        if (!verify || match.exists()) {
+          return match;
+        }
+      }
+
     } else {
       Directories::const_iterator di;
       for (di = _directories.begin(); di != _directories.end(); ++di) {
@@ -283,6 +437,9 @@ find_file(const Filename &filename) const {
 size_t DSearchPath::
 find_all_files(const Filename &filename,
                DSearchPath::Results &results) const {
+  Candidates candidates;
+  bool verify;
+
   size_t num_added = 0;
 
   if (filename.is_local()) {
@@ -293,6 +450,16 @@ find_all_files(const Filename &filename,
         results.add_file(filename);
       }
 
+    } else if (get_candidates(filename, candidates, verify)) {
+      Candidates::const_iterator ci;
+      for (ci = candidates.begin(); ci != candidates.end(); ++ci) {
+        Filename match(_directories[*ci], filename);
+        if (!verify || match.exists()) {
+          results.add_file(match);
+          num_added++;
+        }
+      }
+
     } else {
       Directories::const_iterator di;
       for (di = _directories.begin(); di != _directories.end(); ++di) {
@@ -353,3 +520,121 @@ write(ostream &out, int indent_level) const {
     out << (*di) << "\n";
   }
 }
+
+/**
+ * If this search path is indexed, fills candidates with the indices of the
+ * directories that may contain the indicated local filename, in search order,
+ * and returns true.  If verify is set true, only the first component of the
+ * filename was found in the index, and the caller must still check that the
+ * file exists within each candidate directory.
+ *
+ * Returns false if the index can't be used for this filename, in which case
+ * the caller should probe every directory as usual.
+ */
+bool DSearchPath::
+get_candidates(const Filename &filename, Candidates &candidates,
+               bool &verify) const {
+  if (_index == nullptr) {
+    return false;
+  }
+
+  string fullpath = filename.get_fullpath();
+  size_t slash = fullpath.find('/');
+  string first = fullpath.substr(0, slash);
+  if (first.empty() || first[0] == '.') {
+    // This includes . and .., as well as hidden files, none of which appear
+    // in the directory listings.
+    return false;
+  }
+  verify = (slash != string::npos);
+
+  _index->_lock.lock();
+  if (_index->_valid && _index_check_interval >= 0.0) {
+    double now = get_index_time();
+    if (now >= _index->_next_check) {
+      if (_index->is_stale(_directories)) {
+        _index->_valid = false;
+      } else {
+        _index->_next_check = now + _index_check_interval;
+      }
+    }
+  }
+  if (!_index->_valid) {
+    _index->build(_directories);
+    _index->_next_check = get_index_time() + _index_check_interval;
+  }
+
+  Index::Names::const_iterator ni = _index->_names.find(get_index_key(first));
+  if (ni != _index->_names.end()) {
+    candidates = (*ni).second;
+  }
+  _index->_lock.unlock();
+  return true;
+}
+
+/**
+ * Lists the contents of each of the indicated directories, and records which
+ * directories contain each name.  Assumes the lock is held.
+ */
+void DSearchPath::Index::
+build(const Directories &directories) {
+  _names.clear();
+  _timestamps.clear();
+  _build_time = time(nullptr);
+
+  for (size_t n = 0; n < directories.size(); ++n) {
+    Filename directory = directories[n];
+    if (directory.empty()) {
+      directory = ".";
+    }
+
+    // We don't call scan_directory() on a directory that doesn't exist, since
+    // that would print an error message.
+    Filename::StatInfo info = directory.stat_all();
+    _timestamps.push_back(info._timestamp);
+
+    if (info._is_directory) {
+      vector_string contents;
+      directory.scan_directory(contents);
+
+      vector_string::const_iterator ci;
+      for (ci = contents.begin(); ci != contents.end(); ++ci) {
+        DirectoryList &list = _names[get_index_key(*ci)];
+        if (list.empty() || list.back() != n) {
+          list.push_back(n);
+        }
+      }
+    }
+  }
+
+  _valid = true;
+}
+
+/**
+ * Returns true if any of the indicated directories has been modified since
+ * the index was built.  Assumes the lock is held.
+ */
+bool DSearchPath::Index::
+is_stale(const Directories &directories) const {
+  if (_timestamps.size() != directories.size()) {
+    return true;
+  }
+
+  for (size_t n = 0; n < directories.size(); ++n) {
+    Filename directory = directories[n];
+    if (directory.empty()) {
+      directory = ".";
+    }
+
+    // Timestamps only have a resolution of one second, so if the directory
+    // was modified during the second in which we listed it, we can't be sure
+    // that we saw the modification, and we have to list it again.  A
+    // timestamp in the future doesn't count, or we would list it every time.
+    time_t timestamp = directory.get_timestamp();
+    if (timestamp != _timestamps[n] || timestamp == _build_time) {
+      return true;
+    }
+  }
+
+  return false;
+}
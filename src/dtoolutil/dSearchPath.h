@@ -18,6 +18,8 @@
 
 #include "filename.h"
 #include "pvector.h"
+#include "pmap.h"
+#include "mutexImpl.h"
 
 /**
  * This class stores a list of directories that can be searched, in order, to
@@ -52,15 +54,15 @@ PUBLISHED:
     Files _files;
   };
 
-  DSearchPath() = default;
+  INLINE DSearchPath();
   DSearchPath(const std::string &path, const std::string &separator = std::string());
   DSearchPath(const Filename &directory);
-  DSearchPath(const DSearchPath &copy) = default;
-  DSearchPath(DSearchPath &&from) = default;
-  ~DSearchPath() = default;
+  DSearchPath(const DSearchPath &copy);
+  INLINE DSearchPath(DSearchPath &&from) noexcept;
+  ~DSearchPath();
 
-  DSearchPath &operator = (const DSearchPath &copy) = default;
-  DSearchPath &operator = (DSearchPath &&from) = default;
+  DSearchPath &operator = (const DSearchPath &copy);
+  DSearchPath &operator = (DSearchPath &&from) noexcept;
 
   void clear();
   void append_directory(const Filename &directory);
@@ -70,6 +72,16 @@ PUBLISHED:
   void append_path(const DSearchPath &path);
   void prepend_path(const DSearchPath &path);
 
+  void set_indexed(bool indexed);
+  INLINE bool is_indexed() const;
+  void set_index_check_interval(double interval);
+  INLINE double get_index_check_interval() const;
+  void invalidate_index();
+
+  MAKE_PROPERTY(indexed, is_indexed, set_indexed);
+  MAKE_PROPERTY(index_check_interval, get_index_check_interval,
+                                      set_index_check_interval);
+
   bool is_empty() const;
   size_t get_num_directories() const;
   const Filename &get_directory(size_t n) const;
@@ -88,8 +100,35 @@ PUBLISHED:
   void write(std::ostream &out, int indent_level = 0) const;
 
 private:
+  typedef pvector<size_t> Candidates;
+  bool get_candidates(const Filename &filename, Candidates &candidates,
+                      bool &verify) const;
+
   typedef pvector<Filename> Directories;
   Directories _directories;
+
+  // In indexed mode, this records the contents of each directory on the
+  // search path, so that most lookups don't need to touch the filesystem.
+  class Index {
+  public:
+    INLINE Index();
+
+    void build(const Directories &directories);
+    bool is_stale(const Directories &directories) const;
+
+    typedef pvector<size_t> DirectoryList;
+    typedef phash_map<std::string, DirectoryList, sequence_hash<std::string> > Names;
+    typedef pvector<time_t> Timestamps;
+
+    MutexImpl _lock;
+    bool _valid;
+    double _next_check;
+    time_t _build_time;
+    Timestamps _timestamps;
+    Names _names;
+  };
+  Index *_index;
+  double _index_check_interval;
 };
 
 INLINE std::ostream &operator << (std::ostream &out, const DSearchPath &sp) {
@@ -0,0 +1,400 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file fileStatCache.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "fileStatCache.h"
+
+#include <algorithm>
+#include <chrono>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+
+TVOLATILE AtomicAdjust::Pointer FileStatCache::_global_ptr = nullptr;
+
+#ifdef __linux__
+// The events that may change the result of stat() on a directory entry.
+static const uint32_t watch_mask =
+  IN_ATTRIB | IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+  IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+#endif
+
+/**
+ * Returns a monotonically increasing time in seconds, used for expiring cache
+ * entries.
+ */
+static double
+get_now() {
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Don't try to construct a FileStatCache object; there is only one of these,
+ * and it constructs itself.  Use get_global_ptr() to get a pointer to the one
+ * FileStatCache.
+ */
+FileStatCache::
+FileStatCache() :
+  _ttl(0.0),
+  _enabled(0),
+  _watch_changes(false),
+  _inotify_fd(-1),
+  _num_entries(0),
+  _num_hits(0),
+  _num_misses(0)
+{
+}
+
+/**
+ * Don't try to destruct the global FileStatCache object.
+ */
+FileStatCache::
+~FileStatCache() {
+  set_watch_changes(false);
+}
+
+/**
+ * Enables the cache, trusting each result for the indicated number of
+ * seconds.  A value of 0 disables the cache and discards its contents.
+ */
+void FileStatCache::
+set_ttl(double ttl) {
+  _lock.lock();
+  _ttl = std::max(ttl, 0.0);
+  AtomicAdjust::set(_enabled, (_ttl > 0.0) ? 1 : 0);
+  if (_ttl <= 0.0) {
+    clear_watches();
+    _dirs.clear();
+    _num_entries = 0;
+  }
+  _lock.unlock();
+}
+
+/**
+ * Specifies whether to ask the operating system to report changes to the
+ * directories containing cached files, so that cached results are discarded
+ * as soon as they go stale rather than only when the ttl expires.
+ *
+ * This is currently only supported on Linux, where it uses inotify.  Returns
+ * true if the setting was applied, false if it is not supported.
+ */
+bool FileStatCache::
+set_watch_changes(bool watch_changes) {
+  bool success = true;
+  _lock.lock();
+
+  if (watch_changes != _watch_changes) {
+    if (watch_changes) {
+#ifdef __linux__
+      _inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+      if (_inotify_fd >= 0) {
+        // Directories that are already in the cache aren't watched, so we
+        // can't trust what we have.
+        _dirs.clear();
+        _num_entries = 0;
+        _watch_changes = true;
+      } else {
+        success = false;
+      }
+#else
+      success = false;
+#endif  // __linux__
+
+    } else {
+      clear_watches();
+#ifdef __linux__
+      close(_inotify_fd);
+#endif
+      _inotify_fd = -1;
+      _watch_changes = false;
+    }
+  }
+
+  _lock.unlock();
+  return success;
+}
+
+/**
+ * Discards any cached information about the indicated file.  Filename calls
+ * this automatically when it modifies a file itself.
+ */
+void FileStatCache::
+invalidate(const Filename &filename) {
+  if (!is_enabled() || filename.empty()) {
+    return;
+  }
+
+  string os_specific = filename.get_filename_index(0).to_os_specific();
+
+  _lock.lock();
+  erase_entry(os_specific);
+  _lock.unlock();
+}
+
+/**
+ * Discards all cached information.
+ */
+void FileStatCache::
+flush() {
+  _lock.lock();
+  clear_watches();
+  _dirs.clear();
+  _num_entries = 0;
+  _lock.unlock();
+}
+
+/**
+ * Returns the number of files whose attributes are currently cached,
+ * including those whose entries have expired but not yet been discarded.
+ */
+size_t FileStatCache::
+get_num_entries() const {
+  return _num_entries;
+}
+
+/**
+ * Returns a pointer to the global FileStatCache object.
+ */
+FileStatCache *FileStatCache::
+get_global_ptr() {
+  FileStatCache *ptr = (FileStatCache *)AtomicAdjust::get_ptr(_global_ptr);
+  if (ptr == nullptr) {
+    // This may be called from several threads at once, for instance by
+    // Filename::copy_files(), so only one of them gets to store it.
+    FileStatCache *new_ptr = new FileStatCache;
+    ptr = (FileStatCache *)AtomicAdjust::compare_and_exchange_ptr(_global_ptr, nullptr, new_ptr);
+    if (ptr == nullptr) {
+      ptr = new_ptr;
+    } else {
+      // Someone else stored one first.
+      delete new_ptr;
+    }
+  }
+  return ptr;
+}
+
+/**
+ * Looks up the attributes of the indicated file in the cache.  If they are
+ * present and still valid, fills in info and returns true; otherwise, returns
+ * false, and the caller should determine the attributes and store() them.
+ */
+bool FileStatCache::
+lookup(const string &os_specific, Filename::StatInfo &info) {
+  string dirname, basename;
+  split_path(os_specific, dirname, basename);
+
+  _lock.lock();
+  process_events();
+
+  Directories::iterator di = _dirs.find(dirname);
+  if (di != _dirs.end()) {
+    Entries &entries = (*di).second._entries;
+    Entries::iterator ei = entries.find(basename);
+    if (ei != entries.end()) {
+      if ((*ei).second._expires > get_now()) {
+        info = (*ei).second._info;
+        ++_num_hits;
+        _lock.unlock();
+        return true;
+      }
+
+      // It's gone stale.
+      entries.erase(ei);
+      --_num_entries;
+    }
+  }
+
+  ++_num_misses;
+  _lock.unlock();
+  return false;
+}
+
+/**
+ * Records the attributes of the indicated file, as just returned by the
+ * operating system.
+ */
+void FileStatCache::
+store(const string &os_specific, const Filename::StatInfo &info) {
+  string dirname, basename;
+  split_path(os_specific, dirname, basename);
+
+  _lock.lock();
+  if (_ttl <= 0.0) {
+    // The cache was disabled in the meantime.
+    _lock.unlock();
+    return;
+  }
+
+  std::pair<Directories::iterator, bool> result =
+    _dirs.insert(Directories::value_type(dirname, Directory()));
+  Directory &dir = (*result.first).second;
+
+  if (result.second) {
+    dir._watch = -1;
+#ifdef __linux__
+    if (_watch_changes) {
+      // If this fails (for instance, because the directory doesn't exist), we
+      // simply fall back to relying on the ttl.
+      const char *path = dirname.empty() ? "." : dirname.c_str();
+      dir._watch = inotify_add_watch(_inotify_fd, path, watch_mask);
+      if (dir._watch >= 0) {
+        _watches.insert(Watches::value_type(dir._watch, dirname));
+      }
+    }
+#endif  // __linux__
+  }
+
+  Entry entry;
+  entry._info = info;
+  entry._expires = get_now() + _ttl;
+
+  std::pair<Entries::iterator, bool> eresult =
+    dir._entries.insert(Entries::value_type(basename, entry));
+  if (eresult.second) {
+    ++_num_entries;
+  } else {
+    (*eresult.first).second = entry;
+  }
+  _lock.unlock();
+}
+
+/**
+ * Splits an OS-specific pathname into the directory part and the basename
+ * part.  The directory part is empty for a relative filename in the current
+ * directory.
+ */
+void FileStatCache::
+split_path(const string &os_specific, string &dirname, string &basename) {
+#ifdef _WIN32
+  size_t slash = os_specific.find_last_of("\\/");
+#else
+  size_t slash = os_specific.rfind('/');
+#endif
+  if (slash == string::npos) {
+    dirname = string();
+    basename = os_specific;
+  } else {
+    dirname = os_specific.substr(0, (slash == 0) ? 1 : slash);
+    basename = os_specific.substr(slash + 1);
+  }
+}
+
+/**
+ * Removes the cache entry for the indicated file, if any.  Assumes the lock
+ * is held.
+ */
+void FileStatCache::
+erase_entry(const string &os_specific) {
+  string dirname, basename;
+  split_path(os_specific, dirname, basename);
+
+  Directories::iterator di = _dirs.find(dirname);
+  if (di != _dirs.end()) {
+    _num_entries -= (*di).second._entries.erase(basename);
+  }
+}
+
+/**
+ * Reads any pending change notifications from the operating system, and
+ * discards the affected cache entries.  Assumes the lock is held.
+ */
+void FileStatCache::
+process_events() {
+#ifdef __linux__
+  if (!_watch_changes) {
+    return;
+  }
+
+  alignas(struct inotify_event) char buffer[4096];
+  ssize_t length = read(_inotify_fd, buffer, sizeof(buffer));
+  while (length > 0) {
+    const char *p = buffer;
+    while (p < buffer + length) {
+      const struct inotify_event *event = (const struct inotify_event *)p;
+      p += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        // We missed some events, so we can't trust anything.
+        for (Directories::iterator di = _dirs.begin(); di != _dirs.end(); ++di) {
+          (*di).second._entries.clear();
+        }
+        _num_entries = 0;
+        continue;
+      }
+
+      std::pair<Watches::iterator, Watches::iterator> range =
+        _watches.equal_range(event->wd);
+      for (Watches::iterator wi = range.first; wi != range.second; ++wi) {
+        const string &dirname = (*wi).second;
+        Directories::iterator di = _dirs.find(dirname);
+        if (di == _dirs.end()) {
+          continue;
+        }
+
+        Entries &entries = (*di).second._entries;
+        if (event->len > 0 && (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) == 0) {
+          _num_entries -= entries.erase(string(event->name));
+        } else {
+          _num_entries -= entries.size();
+          entries.clear();
+        }
+
+        // The modification time of the directory itself has changed too.
+        if (!dirname.empty()) {
+          erase_entry(dirname);
+        }
+      }
+
+      if (event->mask & IN_IGNORED) {
+        // The watch has gone away, probably because the directory was
+        // deleted.  Make sure we don't trust its entries from now on.
+        for (Watches::iterator wi = range.first; wi != range.second; ++wi) {
+          Directories::iterator di = _dirs.find((*wi).second);
+          if (di != _dirs.end()) {
+            _num_entries -= (*di).second._entries.size();
+            _dirs.erase(di);
+          }
+        }
+        _watches.erase(range.first, range.second);
+      }
+    }
+
+    length = read(_inotify_fd, buffer, sizeof(buffer));
+  }
+#endif  // __linux__
+}
+
+/**
+ * Removes all of the operating system watches on cached directories.  Assumes
+ * the lock is held.
+ */
+void FileStatCache::
+clear_watches() {
+#ifdef __linux__
+  if (_inotify_fd >= 0) {
+    for (Watches::iterator wi = _watches.begin(); wi != _watches.end(); ++wi) {
+      inotify_rm_watch(_inotify_fd, (*wi).first);
+    }
+  }
+#endif
+  _watches.clear();
+
+  for (Directories::iterator di = _dirs.begin(); di != _dirs.end(); ++di) {
+    (*di).second._watch = -1;
+  }
+}
@@ -0,0 +1,106 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file fileStatCache.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef FILESTATCACHE_H
+#define FILESTATCACHE_H
+
+#include "dtoolbase.h"
+#include "filename.h"
+#include "mutexImpl.h"
+#include "atomicAdjust.h"
+#include "pmap.h"
+
+/**
+ * An optional, process-wide cache of the results of Filename::stat_all(), and
+ * therefore of Filename::exists(), is_regular_file(), is_directory(),
+ * get_timestamp() and get_file_size().  Code that walks a long search path
+ * tends to ask about the same (mostly nonexistent) files over and over; with
+ * the cache enabled, most of those questions are answered without a system
+ * call.
+ *
+ * The cache is disabled by default.  A cached result is trusted for the
+ * number of seconds given to set_ttl().  On Linux, set_watch_changes() may
+ * also be used to discard results as soon as the operating system reports a
+ * change to the containing directory.
+ */
+class EXPCL_DTOOL_DTOOLUTIL FileStatCache {
+protected:
+  FileStatCache();
+  ~FileStatCache();
+
+PUBLISHED:
+  void set_ttl(double ttl);
+  INLINE double get_ttl() const;
+  INLINE bool is_enabled() const;
+
+  bool set_watch_changes(bool watch_changes);
+  INLINE bool get_watch_changes() const;
+
+  void invalidate(const Filename &filename);
+  void flush();
+
+  size_t get_num_entries() const;
+  INLINE size_t get_num_hits() const;
+  INLINE size_t get_num_misses() const;
+
+  static FileStatCache *get_global_ptr();
+
+  MAKE_PROPERTY(ttl, get_ttl, set_ttl);
+  MAKE_PROPERTY(enabled, is_enabled);
+
+public:
+  bool lookup(const std::string &os_specific, Filename::StatInfo &info);
+  void store(const std::string &os_specific, const Filename::StatInfo &info);
+
+private:
+  static void split_path(const std::string &os_specific,
+                         std::string &dirname, std::string &basename);
+  void erase_entry(const std::string &os_specific);
+  void process_events();
+  void clear_watches();
+
+  class Entry {
+  public:
+    Filename::StatInfo _info;
+    double _expires;
+  };
+  typedef phash_map<std::string, Entry, sequence_hash<std::string> > Entries;
+
+  class Directory {
+  public:
+    Entries _entries;
+    int _watch;
+  };
+  typedef phash_map<std::string, Directory, sequence_hash<std::string> > Directories;
+
+  // Maps inotify watch descriptors back to the directories they watch.  The
+  // same directory may have been reached via more than one path string.
+  typedef pmultimap<int, std::string> Watches;
+
+  MutexImpl _lock;
+  Directories _dirs;
+  Watches _watches;
+  double _ttl;
+  TVOLATILE AtomicAdjust::Integer _enabled;
+  bool _watch_changes;
+  int _inotify_fd;
+  size_t _num_entries;
+  size_t _num_hits;
+  size_t _num_misses;
+
+  static TVOLATILE AtomicAdjust::Pointer _global_ptr;
+};
+
+#include "fileStatCache.I"
+
+#endif
@@ -19,6 +19,7 @@
 #include "typeHandle.h"
 #include "register_type.h"
 #include "vector_string.h"
+#include "pvector.h"
 #include "textEncoder.h"
 
 #include <assert.h>
@@ -241,6 +242,28 @@ PUBLISHED:
   INLINE static TextEncoder::Encoding get_filesystem_encoding();
 
 public:
+  /**
+   * All of the attributes of a file that can be determined with a single
+   * system call.  Returned by stat_all().
+   */
+  class StatInfo {
+  public:
+    INLINE StatInfo();
+
+    bool _exists;
+    bool _is_regular_file;
+    bool _is_directory;
+    time_t _timestamp;
+    time_t _access_timestamp;
+    std::streamsize _file_size;
+  };
+
+  StatInfo stat_all() const;
+
+  static size_t copy_files(const pvector<Filename> &sources,
+                           const pvector<Filename> &dests,
+                           int num_threads = 0);
+
   bool atomic_compare_and_exchange_contents(std::string &orig_contents, const std::string &old_contents, const std::string &new_contents) const;
   bool atomic_read_contents(std::string &contents) const;
 
@@ -0,0 +1,477 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file globMatcher.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "globMatcher.h"
+#include "globPattern.h"
+
+#include <ctype.h>
+#include <string.h>
+
+using std::string;
+
+/**
+ * Removes all of the patterns.
+ */
+void GlobMatcher::
+clear() {
+  _patterns.clear();
+  _num_states = 0;
+  _num_words = 0;
+  _masks.clear();
+  _star_mask.clear();
+}
+
+/**
+ * Adds the indicated pattern, taking its case sensitivity and nomatch
+ * characters into account.  Returns the index of the new pattern, which is
+ * the value find_match() returns when a candidate matches it.
+ */
+int GlobMatcher::
+add_pattern(const GlobPattern &pattern) {
+  return add_pattern(pattern.get_pattern(), pattern.get_case_sensitive(),
+                     pattern.get_nomatch_chars());
+}
+
+/**
+ * Returns the index of the first pattern that the candidate string matches,
+ * or -1 if it doesn't match any of them.
+ */
+int GlobMatcher::
+find_match(const string &candidate) const {
+  int best = -1;
+  bool any_started = false;
+
+  // We need a few words of scratch space to hold the set of live states.
+  Word local_states[8];
+  Masks heap_states;
+  Word *states = local_states;
+  if (_num_words > 8) {
+    heap_states.resize(_num_words);
+    states = &heap_states[0];
+  }
+  if (_num_words > 0) {
+    memset(states, 0, _num_words * sizeof(Word));
+  }
+
+  for (size_t pi = 0; pi < _patterns.size(); ++pi) {
+    const Pattern &pat = _patterns[pi];
+    if (!pat.check_bounds(candidate)) {
+      continue;
+    }
+    if (pat._trivial) {
+      // No need to look any further; none of the later patterns can beat
+      // this one.
+      best = (int)pi;
+      break;
+    }
+    states[pat._start_state / word_bits] |= (Word)1 << (pat._start_state % word_bits);
+    any_started = true;
+  }
+
+  if (!any_started) {
+    return best;
+  }
+
+  const unsigned char *cp = (const unsigned char *)candidate.data();
+  const unsigned char *cend = cp + candidate.size();
+
+  if (_num_words == 1) {
+    // The common case, when all of the states fit in a single word.
+    Word live = states[0];
+    Word star = _star_mask[0];
+    for (; cp != cend && live != 0; ++cp) {
+      // A * may also match nothing, so we can skip over it.
+      Word skip;
+      while ((skip = ((live & star) << 1) & ~live) != 0) {
+        live |= skip;
+      }
+      live = ((live & get_advance_mask(*cp)[0]) << 1) |
+             (live & get_stay_mask(*cp)[0]);
+    }
+    states[0] = live;
+
+  } else {
+    for (; cp != cend; ++cp) {
+      bool changed = true;
+      while (changed) {
+        changed = false;
+        Word carry = 0;
+        for (size_t wi = 0; wi < _num_words; ++wi) {
+          Word skip = states[wi] & _star_mask[wi];
+          Word next = states[wi] | (skip << 1) | carry;
+          carry = skip >> (word_bits - 1);
+          if (next != states[wi]) {
+            states[wi] = next;
+            changed = true;
+          }
+        }
+      }
+
+      const Word *advance = get_advance_mask(*cp);
+      const Word *stay = get_stay_mask(*cp);
+      Word carry = 0;
+      Word any_live = 0;
+      for (size_t wi = 0; wi < _num_words; ++wi) {
+        Word moving = states[wi] & advance[wi];
+        states[wi] = (moving << 1) | carry | (states[wi] & stay[wi]);
+        carry = moving >> (word_bits - 1);
+        any_live |= states[wi];
+      }
+      if (any_live == 0) {
+        break;
+      }
+    }
+  }
+
+  // Now see which patterns made it to the end.
+  size_t num_patterns = (best >= 0) ? (size_t)best : _patterns.size();
+  for (size_t pi = 0; pi < num_patterns; ++pi) {
+    const Pattern &pat = _patterns[pi];
+    if (pat._trivial || pat._end_state == pat._start_state) {
+      // This pattern has no states of its own.
+      continue;
+    }
+    size_t state = pat._end_state;
+    if ((states[state / word_bits] >> (state % word_bits)) & 1) {
+      return (int)pi;
+    }
+    // A * at the end of the pattern is also allowed to match the empty
+    // string at the end of the candidate.
+    --state;
+    if (pat._trailing_star &&
+        ((states[state / word_bits] >> (state % word_bits)) & 1)) {
+      return (int)pi;
+    }
+  }
+
+  return best;
+}
+
+/**
+ * Adds each of the candidates that matches any of the patterns to the results
+ * vector.  Returns the number of candidates added.
+ */
+size_t GlobMatcher::
+filter(const vector_string &candidates, vector_string &results) const {
+  size_t num_matched = 0;
+  for (const string &candidate : candidates) {
+    if (find_match(candidate) >= 0) {
+      results.push_back(candidate);
+      ++num_matched;
+    }
+  }
+  return num_matched;
+}
+
+/**
+ * Fills results with the value of find_match() for each of the candidates.
+ */
+void GlobMatcher::
+find_matches(const vector_string &candidates, vector_int &results) const {
+  results.resize(candidates.size());
+  for (size_t ci = 0; ci < candidates.size(); ++ci) {
+    results[ci] = find_match(candidates[ci]);
+  }
+}
+
+/**
+ * Adds a pattern with the indicated properties.  See the GlobPattern
+ * documentation for the meaning of these.
+ */
+int GlobMatcher::
+add_pattern(const string &pattern, bool case_sensitive,
+            const string &nomatch_chars) {
+  int index = (int)_patterns.size();
+  _patterns.push_back(Pattern());
+  Pattern &pat = _patterns.back();
+  pat._pattern = pattern;
+  pat._case_sensitive = case_sensitive;
+  pat._start_state = 0;
+  pat._end_state = 0;
+  pat._min_length = 0;
+  pat._exact_length = true;
+  pat._trivial = false;
+  pat._trailing_star = false;
+
+  // First, break the pattern into its elements.  For each element, we record
+  // the set of characters it can consume.
+  enum ElementType {
+    T_literal,
+    T_set,
+    T_star,
+  };
+  class Element {
+  public:
+    ElementType _type;
+    char _literal;
+    bool _chars[256];
+  };
+  pvector<Element> elements;
+  bool all_literal = true;
+  bool broken = false;
+
+  size_t p = 0;
+  while (p < pattern.size() && !broken) {
+    Element elem;
+    elem._type = T_set;
+    memset(elem._chars, 0, sizeof(elem._chars));
+
+    switch (pattern[p]) {
+    case '*':
+      elem._type = T_star;
+      for (int ch = 0; ch < 256; ++ch) {
+        elem._chars[ch] = (nomatch_chars.find((char)ch) == string::npos);
+      }
+      ++p;
+      break;
+
+    case '?':
+      memset(elem._chars, 1, sizeof(elem._chars));
+      ++p;
+      break;
+
+    case '[':
+      {
+        ++p;
+        bool negate = false;
+        if (p < pattern.size() && pattern[p] == '!') {
+          negate = true;
+          ++p;
+        }
+        size_t end = p;
+        for (int ch = 0; ch < 256; ++ch) {
+          end = p;
+          elem._chars[ch] = (matches_set(pattern, end, (char)ch, case_sensitive) != negate);
+        }
+        if (end >= pattern.size()) {
+          // There wasn't a closing square bracket, so nothing can get past
+          // this point.
+          broken = true;
+        }
+        p = end + 1;
+      }
+      break;
+
+    case '\\':
+      // A backslash escapes the next special character.
+      ++p;
+      if (p >= pattern.size()) {
+        broken = true;
+        break;
+      }
+      // fall through.
+
+    default:
+      elem._type = T_literal;
+      {
+        elem._literal = pattern[p];
+        unsigned char lit = (unsigned char)pattern[p];
+        for (int ch = 0; ch < 256; ++ch) {
+          elem._chars[ch] = case_sensitive ? (ch == lit) : (tolower(ch) == tolower(lit));
+        }
+      }
+      ++p;
+    }
+
+    if (!broken) {
+      if (elem._type != T_literal) {
+        all_literal = false;
+      }
+      if (elem._type == T_star) {
+        pat._exact_length = false;
+      } else {
+        ++pat._min_length;
+      }
+      elements.push_back(elem);
+    }
+  }
+
+  if (broken) {
+    // A malformed pattern can't match anything.
+    pat._min_length = (size_t)-1;
+    pat._exact_length = false;
+    return index;
+  }
+
+  // The literal elements at either end make up the prefix and suffix that
+  // every match must have.
+  size_t num_prefix = 0;
+  while (num_prefix < elements.size() &&
+         elements[num_prefix]._type == T_literal) {
+    pat._prefix += elements[num_prefix]._literal;
+    ++num_prefix;
+  }
+
+  if (all_literal) {
+    // The prefilter does all of the work.
+    pat._trivial = true;
+    return index;
+  }
+
+  if (elements.size() == 1 && elements[0]._type == T_star &&
+      nomatch_chars.empty()) {
+    // Matches everything.
+    pat._trivial = true;
+    return index;
+  }
+
+  size_t num_suffix = 0;
+  while (num_suffix < elements.size() &&
+         elements[elements.size() - 1 - num_suffix]._type == T_literal) {
+    ++num_suffix;
+  }
+  for (size_t ei = elements.size() - num_suffix; ei < elements.size(); ++ei) {
+    pat._suffix += elements[ei]._literal;
+  }
+
+  pat._trailing_star = (elements.back()._type == T_star);
+
+  // Now allocate the states for the elements, and fill in the masks.
+  pat._start_state = _num_states;
+  pat._end_state = _num_states + elements.size();
+  grow_states(_num_states + elements.size() + 1);
+
+  for (size_t ei = 0; ei < elements.size(); ++ei) {
+    const Element &elem = elements[ei];
+    size_t state = pat._start_state + ei;
+    size_t wi = state / word_bits;
+    Word bit = (Word)1 << (state % word_bits);
+
+    if (elem._type == T_star) {
+      _star_mask[wi] |= bit;
+    }
+    for (int ch = 0; ch < 256; ++ch) {
+      if (elem._chars[ch]) {
+        if (elem._type == T_star) {
+          get_stay_mask((unsigned char)ch)[wi] |= bit;
+        } else {
+          get_advance_mask((unsigned char)ch)[wi] |= bit;
+        }
+      }
+    }
+  }
+
+  return index;
+}
+
+/**
+ * Extends the automaton to the indicated number of states, reorganizing the
+ * masks if they need more words.
+ */
+void GlobMatcher::
+grow_states(size_t num_states) {
+  size_t num_words = (num_states + word_bits - 1) / word_bits;
+  if (num_words != _num_words) {
+    Masks masks(256 * 2 * num_words, 0);
+    for (size_t row = 0; row < 256 * 2 && _num_words > 0; ++row) {
+      memcpy(&masks[row * num_words], &_masks[row * _num_words],
+             _num_words * sizeof(Word));
+    }
+    _masks.swap(masks);
+    _star_mask.resize(num_words, 0);
+    _num_words = num_words;
+  }
+  _num_states = num_states;
+}
+
+/**
+ * Called with p positioned after the opening square bracket of a set, scans
+ * the set sequence, leaving p positioned on the closing square bracket, and
+ * returns true if the indicated character matches the set of characters
+ * indicated, false otherwise.  This follows the same rules that GlobPattern
+ * always has.
+ */
+bool GlobMatcher::
+matches_set(const string &pattern, size_t &p, char ch, bool case_sensitive) {
+  bool matched = false;
+  size_t pend = pattern.size();
+
+  while (p != pend && pattern[p] != ']') {
+    if (pattern[p] == '\\') {
+      // Backslash escapes the next character.
+      ++p;
+      if (p == pend) {
+        return false;
+      }
+    }
+
+    if (ch == pattern[p]) {
+      matched = true;
+    }
+
+    // Maybe it's an a-z style range?
+    char start = pattern[p];
+    ++p;
+    if (p != pend && pattern[p] == '-') {
+      ++p;
+      if (p != pend && pattern[p] != ']') {
+        // Yes, we have a range: start-end.
+
+        if (pattern[p] == '\\') {
+          // Backslash escapes.
+          ++p;
+          if (p == pend) {
+            return false;
+          }
+        }
+
+        char end = pattern[p];
+        ++p;
+
+        if ((ch >= start && ch <= end) ||
+            (!case_sensitive &&
+             ((tolower(ch) >= start && tolower(ch) <= end) ||
+              (toupper(ch) >= start && toupper(ch) <= end)))) {
+          matched = true;
+        }
+      } else {
+        // This was a - at the end of the string.
+        if (ch == '-') {
+          matched = true;
+        }
+      }
+    }
+  }
+
+  return matched;
+}
+
+/**
+ * Returns true if the candidate is of the right length and has the right
+ * prefix and suffix to possibly match this pattern.
+ */
+bool GlobMatcher::Pattern::
+check_bounds(const string &candidate) const {
+  size_t length = candidate.size();
+  if (_exact_length ? (length != _min_length) : (length < _min_length)) {
+    return false;
+  }
+
+  size_t suffix_start = length - _suffix.size();
+  if (_case_sensitive) {
+    return candidate.compare(0, _prefix.size(), _prefix) == 0 &&
+           candidate.compare(suffix_start, _suffix.size(), _suffix) == 0;
+  }
+
+  for (size_t i = 0; i < _prefix.size(); ++i) {
+    if (tolower((unsigned char)candidate[i]) != tolower((unsigned char)_prefix[i])) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < _suffix.size(); ++i) {
+    if (tolower((unsigned char)candidate[suffix_start + i]) != tolower((unsigned char)_suffix[i])) {
+      return false;
+    }
+  }
+  return true;
+}
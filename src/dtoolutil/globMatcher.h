@@ -0,0 +1,111 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file globMatcher.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef GLOBMATCHER_H
+#define GLOBMATCHER_H
+
+#include "dtoolbase.h"
+#include "vector_string.h"
+#include "vector_int.h"
+
+class GlobPattern;
+
+/**
+ * A compiled form of one or more GlobPatterns, for testing many candidate
+ * strings against the same patterns.
+ *
+ * Each pattern is translated into a small automaton, and all of the patterns
+ * are run side by side over the candidate string, so the time taken is linear
+ * in the length of the candidate no matter how many * operators the patterns
+ * contain.  Candidates that can't possibly match a pattern, because they
+ * don't begin or end with the pattern's literal prefix or suffix or are too
+ * short, are rejected without running its automaton at all.
+ *
+ * GlobPattern uses this internally to implement matches().
+ */
+class EXPCL_DTOOL_DTOOLUTIL GlobMatcher {
+PUBLISHED:
+  INLINE GlobMatcher();
+
+  void clear();
+  int add_pattern(const GlobPattern &pattern);
+
+  INLINE size_t get_num_patterns() const;
+  INLINE const std::string &get_pattern(size_t n) const;
+  MAKE_SEQ_PROPERTY(patterns, get_num_patterns, get_pattern);
+
+  INLINE bool matches(const std::string &candidate) const;
+  int find_match(const std::string &candidate) const;
+  size_t filter(const vector_string &candidates, vector_string &results) const;
+  void find_matches(const vector_string &candidates, vector_int &results) const;
+
+public:
+  int add_pattern(const std::string &pattern, bool case_sensitive,
+                  const std::string &nomatch_chars);
+
+private:
+  typedef uint64_t Word;
+  static const size_t word_bits = 64;
+
+  INLINE Word *get_advance_mask(unsigned char ch);
+  INLINE const Word *get_advance_mask(unsigned char ch) const;
+  INLINE Word *get_stay_mask(unsigned char ch);
+  INLINE const Word *get_stay_mask(unsigned char ch) const;
+
+  void grow_states(size_t num_states);
+  static bool matches_set(const std::string &pattern, size_t &p,
+                          char ch, bool case_sensitive);
+
+  // Each pattern occupies a run of consecutive states in the automaton, one
+  // for each pattern element plus one for the end of the pattern.
+  class Pattern {
+  public:
+    bool check_bounds(const std::string &candidate) const;
+
+    std::string _pattern;
+    bool _case_sensitive;
+    size_t _start_state;
+    size_t _end_state;
+
+    // The prefilter.
+    std::string _prefix;
+    std::string _suffix;
+    size_t _min_length;
+    bool _exact_length;
+
+    // True if passing the prefilter is already enough to match.
+    bool _trivial;
+
+    // True if the pattern ends in a *, which is also allowed to match when
+    // the candidate runs out.
+    bool _trailing_star;
+  };
+  typedef pvector<Pattern> Patterns;
+  Patterns _patterns;
+
+  size_t _num_states;
+  size_t _num_words;
+
+  // For each character, the states that consume it and move to the next
+  // state, followed by the states (only ever * elements) that consume it and
+  // stay put.
+  typedef pvector<Word> Masks;
+  Masks _masks;
+
+  // The states for * elements, which may be skipped without consuming.
+  Masks _star_mask;
+};
+
+#include "globMatcher.I"
+
+#endif
@@ -14,9 +14,291 @@
 #include "globPattern.h"
 #include "string_utils.h"
 #include <ctype.h>
+#include <algorithm>
+
+#ifdef PHAVE_DIRENT_H
+#include <dirent.h>
+#endif
+
+#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
 
 using std::string;
 
+// What we know about a directory entry without calling stat() on it.
+enum EntryType {
+  ET_unknown,
+  ET_directory,
+  ET_other,
+};
+typedef std::pair<string, EntryType> DirEntry;
+typedef pvector<DirEntry> DirEntries;
+
+/**
+ * Walks the directory tree on behalf of GlobPattern::match_files(), handing
+ * out the subdirectories to be searched to a pool of threads, and passing the
+ * matches to the caller's callback.
+ */
+class GlobPattern::MatchWalker {
+public:
+  MatchWalker(MatchCallback *callback, void *data, const Filename &cwd,
+              int num_threads);
+
+  void run(const GlobPattern &glob, const Filename &prefix,
+           const string &suffix);
+  void recurse(const GlobPattern &glob, const Filename &prefix,
+               const string &suffix);
+  void add_match(const Filename &filename);
+  int get_num_matched() const;
+
+private:
+  void thread_main();
+
+public:
+  const Filename _cwd;
+
+private:
+  MatchCallback *_callback;
+  void *_data;
+  int _num_threads;
+  int _num_matched;
+
+#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+  class Task {
+  public:
+    GlobPattern _glob;
+    Filename _prefix;
+    string _suffix;
+  };
+  typedef pvector<Task> Tasks;
+
+  std::mutex _lock;
+  std::condition_variable _cvar;
+  Tasks _tasks;
+  int _num_busy;
+#endif
+};
+
+/**
+ * Lists the contents of the indicated directory, as
+ * Filename::scan_directory() does, but also records for each entry whether
+ * it is a directory, if the operating system told us so while listing it.
+ * This saves a stat() call per entry on most filesystems.
+ */
+static bool
+scan_directory_entries(const Filename &dirname, DirEntries &entries) {
+#if defined(PHAVE_DIRENT_H) && defined(DT_DIR)
+  string os_dirname = dirname.empty() ? string(".") : dirname.to_os_specific();
+  DIR *root = opendir(os_dirname.c_str());
+  if (root == nullptr) {
+    return false;
+  }
+
+  struct dirent *d = readdir(root);
+  while (d != nullptr) {
+    if (d->d_name[0] != '.') {
+      EntryType type;
+      switch (d->d_type) {
+      case DT_DIR:
+        type = ET_directory;
+        break;
+
+      case DT_UNKNOWN:
+      case DT_LNK:
+        // We have to follow a symbolic link to find out what it is.
+        type = ET_unknown;
+        break;
+
+      default:
+        type = ET_other;
+      }
+      entries.push_back(DirEntry(d->d_name, type));
+    }
+    d = readdir(root);
+  }
+  closedir(root);
+
+#else
+  vector_string contents;
+  if (!dirname.scan_directory(contents)) {
+    return false;
+  }
+  entries.reserve(contents.size());
+  for (const string &name : contents) {
+    entries.push_back(DirEntry(name, ET_unknown));
+  }
+#endif
+
+  std::sort(entries.begin(), entries.end());
+  return true;
+}
+
+/**
+ * The MatchCallback used by the vector_string variant of match_files().
+ */
+static void
+add_match_result(const string &filename, void *data) {
+  ((vector_string *)data)->push_back(filename);
+}
+
+/**
+ * Orders filenames the way a depth-first walk of sorted directories would
+ * produce them, by treating the slash as lower than any other character.
+ */
+static bool
+compare_match_order(const string &a, const string &b) {
+  size_t length = std::min(a.size(), b.size());
+  for (size_t i = 0; i < length; ++i) {
+    if (a[i] != b[i]) {
+      if (a[i] == '/') {
+        return true;
+      } else if (b[i] == '/') {
+        return false;
+      }
+      return (unsigned char)a[i] < (unsigned char)b[i];
+    }
+  }
+  return a.size() < b.size();
+}
+
+/**
+ *
+ */
+GlobPattern::MatchWalker::
+MatchWalker(MatchCallback *callback, void *data, const Filename &cwd,
+            int num_threads) :
+  _cwd(cwd),
+  _callback(callback),
+  _data(data),
+  _num_threads(1),
+  _num_matched(0)
+{
+#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+  _num_threads = num_threads;
+  if (_num_threads <= 0) {
+    _num_threads = (int)std::thread::hardware_concurrency();
+  }
+  _num_threads = std::max(_num_threads, 1);
+  _num_busy = 0;
+#endif
+}
+
+/**
+ * Searches the tree for matches to the indicated pattern, and returns when
+ * the search is complete.
+ */
+void GlobPattern::MatchWalker::
+run(const GlobPattern &glob, const Filename &prefix, const string &suffix) {
+#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+  if (_num_threads > 1) {
+    recurse(glob, prefix, suffix);
+
+    pvector<std::thread> threads;
+    threads.reserve(_num_threads - 1);
+    for (int ti = 1; ti < _num_threads; ++ti) {
+      threads.push_back(std::thread(&MatchWalker::thread_main, this));
+    }
+    thread_main();
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+    return;
+  }
+#endif  // HAVE_THREADS && !SIMPLE_THREADS
+
+  glob.r_match_files(prefix, suffix, *this);
+}
+
+/**
+ * Arranges for the indicated subdirectory to be searched.  With a single
+ * thread, this happens immediately; otherwise, it is queued for the next idle
+ * thread.
+ */
+void GlobPattern::MatchWalker::
+recurse(const GlobPattern &glob, const Filename &prefix, const string &suffix) {
+#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+  if (_num_threads > 1) {
+    Task task;
+    task._glob = glob;
+    task._prefix = prefix;
+    task._suffix = suffix;
+
+    _lock.lock();
+    _tasks.push_back(std::move(task));
+    _lock.unlock();
+    _cvar.notify_one();
+    return;
+  }
+#endif  // HAVE_THREADS && !SIMPLE_THREADS
+
+  glob.r_match_files(prefix, suffix, *this);
+}
+
+/**
+ * Reports a matching filename to the callback.
+ */
+void GlobPattern::MatchWalker::
+add_match(const Filename &filename) {
+#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+  if (_num_threads > 1) {
+    std::lock_guard<std::mutex> guard(_lock);
+    ++_num_matched;
+    (*_callback)(filename, _data);
+    return;
+  }
+#endif  // HAVE_THREADS && !SIMPLE_THREADS
+
+  ++_num_matched;
+  (*_callback)(filename, _data);
+}
+
+/**
+ * Returns the number of matches reported so far.
+ */
+int GlobPattern::MatchWalker::
+get_num_matched() const {
+  return _num_matched;
+}
+
+/**
+ * The body of each thread that walks the tree.  It repeatedly takes the most
+ * recently queued directory and searches it, until there are no directories
+ * left and no other thread is in a position to queue any more.
+ */
+void GlobPattern::MatchWalker::
+thread_main() {
+#if defined(HAVE_THREADS) && !defined(SIMPLE_THREADS)
+  std::unique_lock<std::mutex> guard(_lock);
+  while (true) {
+    while (_tasks.empty() && _num_busy > 0) {
+      _cvar.wait(guard);
+    }
+    if (_tasks.empty()) {
+      // Everyone's idle, so we're done.
+      break;
+    }
+
+    // Taking the most recent task keeps the walk roughly depth-first, which
+    // keeps the queue short.
+    Task task = std::move(_tasks.back());
+    _tasks.pop_back();
+    ++_num_busy;
+
+    guard.unlock();
+    task._glob.r_match_files(task._prefix, task._suffix, *this);
+    guard.lock();
+
+    --_num_busy;
+    if (_num_busy == 0 && _tasks.empty()) {
+      _cvar.notify_all();
+    }
+  }
+#endif  // HAVE_THREADS && !SIMPLE_THREADS
+}
+
 /**
  * Returns true if the pattern includes any special globbing characters, or
  * false if it is just a literal string.
@@ -83,11 +365,41 @@ get_const_prefix() const {
  * to be relative to; otherwise, the actual current working directory is
  * assumed.
  *
+ * If num_threads is other than 1, the directory tree is walked by that many
+ * threads at once (or one per CPU core, if it is 0), which is worthwhile for
+ * patterns that search a large tree.  In this case the matches are returned
+ * in sorted order, rather than in the order in which they were found.
+ *
  * The return value is the number of files matched, which are added to the
  * results vector.
  */
 int GlobPattern::
-match_files(vector_string &results, const Filename &cwd) const {
+match_files(vector_string &results, const Filename &cwd,
+            int num_threads) const {
+  size_t orig_size = results.size();
+  int num_matched = match_files(&add_match_result, &results, cwd, num_threads);
+
+  if (num_threads != 1) {
+    std::sort(results.begin() + orig_size, results.end(), compare_match_order);
+  }
+  return num_matched;
+}
+
+/**
+ * This variant of match_files() delivers each match to the indicated callback
+ * function as soon as it is found, instead of collecting them in a vector.
+ * This allows the caller to start processing the matches while the rest of
+ * the tree is still being searched.
+ *
+ * If num_threads is other than 1, the callback is called from the threads
+ * that walk the tree, in no particular order, but never by more than one
+ * thread at a time.
+ *
+ * The return value is the number of files matched.
+ */
+int GlobPattern::
+match_files(MatchCallback *callback, void *data, const Filename &cwd,
+            int num_threads) const {
   string prefix, pattern, suffix;
 
   string source = _pattern;
@@ -107,15 +419,18 @@ match_files(vector_string &results, const Filename &cwd) const {
 
   GlobPattern glob(pattern);
   glob.set_case_sensitive(_case_sensitive);
-  return glob.r_match_files(prefix, suffix, results, cwd);
+
+  MatchWalker walker(callback, data, cwd, num_threads);
+  walker.run(glob, prefix, suffix);
+  return walker.get_num_matched();
 }
 
 /**
  * The recursive implementation of match_files().
  */
-int GlobPattern::
+void GlobPattern::
 r_match_files(const Filename &prefix, const string &suffix,
-              vector_string &results, const Filename &cwd) {
+              MatchWalker &walker) const {
   string next_pattern, next_suffix;
 
   size_t slash = suffix.find('/');
@@ -133,12 +448,13 @@ r_match_files(const Filename &prefix, const string &suffix,
 
   if (_pattern == "**" && next_pattern == "**") {
     // Collapse consecutive globstar patterns.
-    return r_match_files(prefix, next_suffix, results, cwd);
+    r_match_files(prefix, next_suffix, walker);
+    return;
   }
 
   Filename parent_dir;
-  if (prefix.is_local() && !cwd.empty()) {
-    parent_dir = Filename(cwd, prefix);
+  if (prefix.is_local() && !walker._cwd.empty()) {
+    parent_dir = Filename(walker._cwd, prefix);
   } else {
     parent_dir = prefix;
   }
@@ -153,77 +469,93 @@ r_match_files(const Filename &prefix, const string &suffix,
     if (suffix.empty()) {
       // Time to stop.
       if (fn.exists()) {
-        results.push_back(Filename(prefix, _pattern));
-        return 1;
+        walker.add_match(Filename(prefix, _pattern));
       }
-      return 0;
+      return;
     } else if (fn.is_directory()) {
       // If the pattern ends with a slash, match a directory only.
       if (suffix == "/") {
-        results.push_back(Filename(prefix, _pattern + "/"));
-        return 1;
+        walker.add_match(Filename(prefix, _pattern + "/"));
       } else {
-        return next_glob.r_match_files(Filename(prefix, _pattern),
-                                       next_suffix, results, cwd);
+        next_glob.r_match_files(Filename(prefix, _pattern), next_suffix, walker);
       }
+      return;
     }
   }
 
   // If there *are* special glob characters, we must attempt to match the
   // pattern against the files in this directory.
 
-  vector_string dir_files;
-  if (!parent_dir.scan_directory(dir_files)) {
+  DirEntries dir_entries;
+  if (!scan_directory_entries(parent_dir, dir_entries)) {
     // Not a directory, or unable to read directory; stop here.
-    return 0;
+    return;
   }
 
-  // Now go through each file in the directory looking for one that matches
-  // the pattern.
-  int num_matched = 0;
-
   // A globstar pattern matches zero or more directories.
   if (_pattern == "**") {
     // Try to match this directory (as if the globstar wasn't there)
     if (suffix.empty()) {
       // This is a directory.  Add it.
-      results.push_back(Filename(prefix));
-      num_matched++;
+      walker.add_match(Filename(prefix));
     } else if (suffix == "/") {
       // Keep the trailing slash, but be sure not to duplicate it.
-      results.push_back(Filename(prefix, ""));
-      num_matched++;
+      walker.add_match(Filename(prefix, ""));
     } else {
-      num_matched += next_glob.r_match_files(prefix, next_suffix, results, cwd);
+      next_glob.r_match_files(prefix, next_suffix, walker);
     }
     next_suffix = suffix;
     next_glob = *this;
   }
 
-  for (const string &local_file : dir_files) {
-    if (_pattern[0] == '.' || (local_file.empty() || local_file[0] != '.')) {
-      if (matches(local_file)) {
-        // We have a match; continue.
-        if (Filename(parent_dir, local_file).is_directory()) {
-          if (suffix.empty() && _pattern != "**") {
-            results.push_back(Filename(prefix, local_file));
-            num_matched++;
-          } else if (suffix == "/" && _pattern != "**") {
-            results.push_back(Filename(prefix, local_file + "/"));
-            num_matched++;
-          } else {
-            num_matched += next_glob.r_match_files(Filename(prefix, local_file),
-                                                   next_suffix, results, cwd);
-          }
-        } else if (suffix.empty()) {
-          results.push_back(Filename(prefix, local_file));
-          num_matched++;
-        }
+  // Now go through each file in the directory looking for one that matches
+  // the pattern.  Since the entries are sorted, we can skip straight to the
+  // ones that begin with the constant part of the pattern.
+  string const_prefix = get_const_prefix();
+  DirEntries::const_iterator ei = dir_entries.begin();
+  if (_case_sensitive && !const_prefix.empty()) {
+    ei = std::lower_bound(dir_entries.begin(), dir_entries.end(),
+                          DirEntry(const_prefix, ET_unknown));
+  }
+
+  for (; ei != dir_entries.end(); ++ei) {
+    const string &local_file = (*ei).first;
+    if (_case_sensitive &&
+        local_file.compare(0, const_prefix.size(), const_prefix) != 0) {
+      // We've passed the last entry that could possibly match.
+      break;
+    }
+    if (_pattern[0] != '.' && !local_file.empty() && local_file[0] == '.') {
+      continue;
+    }
+    if (!matches(local_file)) {
+      continue;
+    }
+
+    // We have a match.  If this is the last part of the pattern, it doesn't
+    // matter whether it's a directory, so don't waste a stat() finding out.
+    if (suffix.empty() && _pattern != "**") {
+      walker.add_match(Filename(prefix, local_file));
+      continue;
+    }
+
+    bool is_dir;
+    if ((*ei).second == ET_unknown) {
+      is_dir = Filename(parent_dir, local_file).is_directory();
+    } else {
+      is_dir = ((*ei).second == ET_directory);
+    }
+
+    if (is_dir) {
+      if (suffix == "/" && _pattern != "**") {
+        walker.add_match(Filename(prefix, local_file + "/"));
+      } else {
+        walker.recurse(next_glob, Filename(prefix, local_file), next_suffix);
       }
+    } else if (suffix.empty()) {
+      walker.add_match(Filename(prefix, local_file));
     }
   }
-
-  return num_matched;
 }
 
 /**
@@ -244,37 +576,21 @@ matches_file(Filename candidate) const {
     return false;
   }
 
-  return r_matches_file(_pattern, candidate);
+  return r_matches_file(get_file_components(), 0, candidate);
 }
 
 /**
- * The recursive implementation of matches_file().
+ * The recursive implementation of matches_file().  Matches the candidate
+ * against the components of the pattern from pi on.
  */
 bool GlobPattern::
-r_matches_file(const string &pattern, const Filename &candidate) const {
-  // Split off the next bit of pattern.
-  std::string next_pattern;
-  GlobPattern glob;
-  glob.set_case_sensitive(get_case_sensitive());
-  glob.set_nomatch_chars(get_nomatch_chars());
-
-  bool pattern_end;
-  size_t slash = pattern.find('/');
-  if (slash == string::npos) {
-    glob.set_pattern(pattern);
-    pattern_end = true;
-  } else {
-    glob.set_pattern(pattern.substr(0, slash));
-    next_pattern = pattern.substr(slash + 1);
-    pattern_end = false;
+r_matches_file(const FileComponents &components, size_t pi,
+               const Filename &candidate) const {
+  const FileComponent &component = components[pi];
+  const string &pattern = component._pattern;
+  bool pattern_end = (pi + 1 == components.size());
 
-    if (slash == 0 || (slash == 1 && pattern[0] == '.')) {
-      // Ignore // and /./ in patterns
-      return r_matches_file(next_pattern, candidate);
-    }
-  }
-
-  // Also split off the next component in the candidate filename.
+  // Split off the next component in the candidate filename.
   std::string part;
   Filename next_candidate;
 
@@ -290,13 +606,13 @@ r_matches_file(const string &pattern, const Filename &candidate) const {
 
     // Ignore // and /./ in filenames.
     if (fn_slash == 0 || part == ".") {
-      return r_matches_file(pattern, next_candidate);
+      return r_matches_file(components, pi, next_candidate);
     }
   }
 
   // Now check if the current part matches the current pattern.
   bool part_matches;
-  if (glob.get_pattern() == "**") {
+  if (pattern == "**") {
     // This matches any number of parts.
     if (pattern_end) {
       // We might as well stop checking here; it matches whatever might come.
@@ -304,27 +620,27 @@ r_matches_file(const string &pattern, const Filename &candidate) const {
     }
     // We branch out to three options: either we match nothing, we match this
     // part only, or we match this part and maybe more.
-    return r_matches_file(next_pattern, candidate)
-        || (!candidate_end && r_matches_file(next_pattern, next_candidate))
-        || (!candidate_end && r_matches_file(pattern, next_candidate));
+    return r_matches_file(components, pi + 1, candidate)
+        || (!candidate_end && r_matches_file(components, pi + 1, next_candidate))
+        || (!candidate_end && r_matches_file(components, pi, next_candidate));
   }
-  else if (glob.get_pattern() == "*" && _nomatch_chars.empty()) {
+  else if (pattern == "*" && _nomatch_chars.empty()) {
     // Matches any part (faster version of below)
     part_matches = true;
   }
-  else if ((glob.get_pattern() == "." && part.empty())
-        || (glob.get_pattern().empty() && part == ".")) {
+  else if ((pattern == "." && part.empty())
+        || (pattern.empty() && part == ".")) {
     // So that /path/. matches /path/, and vice versa.
     part_matches = true;
   }
-  else if (glob.has_glob_characters()) {
-    part_matches = glob.matches(part);
+  else if (component._has_glob) {
+    part_matches = component._matcher.matches(part);
   }
   else if (get_case_sensitive()) {
-    part_matches = (part == glob.get_pattern());
+    part_matches = (part == pattern);
   }
   else {
-    part_matches = (cmp_nocase(part, glob.get_pattern()) == 0);
+    part_matches = (cmp_nocase(part, pattern) == 0);
   }
 
   if (!part_matches) {
@@ -343,151 +659,69 @@ r_matches_file(const string &pattern, const Filename &candidate) const {
   }
 
   // It matches; move on to the next part.
-  return r_matches_file(next_pattern, next_candidate);
+  return r_matches_file(components, pi + 1, next_candidate);
 }
 
 /**
- * The recursive implementation of matches().  This returns true if the
- * pattern substring [pi, pend) matches the candidate substring [ci, cend),
- * false otherwise.
+ * Returns the GlobMatcher for this pattern, compiling it first if it hasn't
+ * been needed before.  This may be called by several threads at once.
  */
-bool GlobPattern::
-matches_substr(string::const_iterator pi, string::const_iterator pend,
-               string::const_iterator ci, string::const_iterator cend) const {
-  // If we run out of pattern or candidate string, it's a match only if they
-  // both ran out at the same time.
-  if (pi == pend || ci == cend) {
-    // A special exception: we allow ci to reach the end before pi, only if pi
-    // is one character before the end and that last character is '*'.
-    if ((ci == cend) && (std::distance(pi, pend) == 1) && (*pi) == '*') {
-      return true;
-    }
-    return (pi == pend && ci == cend);
-  }
-
-  switch (*pi) {
-
-  case '*':
-    // A '*' in the pattern string means to match any sequence of zero or more
-    // characters in the candidate string.  This means we have to recurse
-    // twice: either consume one character of the candidate string and
-    // continue to try matching the *, or stop trying to match the * here.
-    if (_nomatch_chars.find(*ci) == string::npos) {
-      return
-        matches_substr(pi, pend, ci + 1, cend) ||
-        matches_substr(pi + 1, pend, ci, cend);
-    } else {
-      // On the other hand, if this is one of the nomatch chars, we can only
-      // stop here.
-      return matches_substr(pi + 1, pend, ci, cend);
-    }
-
-  case '?':
-    // A '?' in the pattern string means to match exactly one character in the
-    // candidate string.  That's easy.
-    return matches_substr(pi + 1, pend, ci + 1, cend);
-
-  case '[':
-    // An open square bracket begins a set.
-    ++pi;
-    if ((*pi) == '!') {
-      ++pi;
-      if (matches_set(pi, pend, *ci)) {
-        return false;
-      }
-    } else {
-      if (!matches_set(pi, pend, *ci)) {
-        return false;
-      }
-    }
-    if (pi == pend) {
-      // Oops, there wasn't a closing square bracket.
-      return false;
-    }
-    return matches_substr(pi + 1, pend, ci + 1, cend);
-
-  case '\\':
-    // A backslash escapes the next special character.
-    ++pi;
-    if (pi == pend) {
-      return false;
-    }
-    // fall through.
-
-  default:
-    // Anything else means to match exactly that.
-    if (_case_sensitive) {
-      if ((*pi) != (*ci)) {
-        return false;
-      }
+const GlobMatcher &GlobPattern::
+get_matcher() const {
+  GlobMatcher *matcher = (GlobMatcher *)AtomicAdjust::get_ptr(_matcher);
+  if (matcher == nullptr) {
+    GlobMatcher *new_matcher = new GlobMatcher;
+    new_matcher->add_pattern(_pattern, _case_sensitive, _nomatch_chars);
+    matcher = (GlobMatcher *)AtomicAdjust::compare_and_exchange_ptr(_matcher, nullptr, new_matcher);
+    if (matcher == nullptr) {
+      matcher = new_matcher;
     } else {
-      if (tolower(*pi) != tolower(*ci)) {
-        return false;
-      }
+      // Another thread got there first.
+      delete new_matcher;
     }
-    return matches_substr(pi + 1, pend, ci + 1, cend);
   }
+  return *matcher;
 }
 
-
 /**
- * Called when an unescaped open square bracked is scanned, this is called
- * with pi positioned after the opening square bracket, scans the set
- * sequence, leaving pi positioned on the closing square bracket, and returns
- * true if the indicated character matches the set of characters indicated,
- * false otherwise.
+ * Returns the pattern split into the path components that matches_file()
+ * tests one at a time, compiling them first if they haven't been needed
+ * before.  This may be called by several threads at once.
  */
-bool GlobPattern::
-matches_set(string::const_iterator &pi, string::const_iterator pend,
-            char ch) const {
-  bool matched = false;
-
-  while (pi != pend && (*pi) != ']') {
-    if ((*pi) == '\\') {
-      // Backslash escapes the next character.
-      ++pi;
-      if (pi == pend) {
-        return false;
+const GlobPattern::FileComponents &GlobPattern::
+get_file_components() const {
+  FileComponents *components = (FileComponents *)AtomicAdjust::get_ptr(_file_components);
+  if (components == nullptr) {
+    FileComponents *new_components = new FileComponents;
+    size_t p = 0;
+    while (true) {
+      size_t slash = _pattern.find('/', p);
+      string part = _pattern.substr(p, slash - p);
+
+      // Ignore // and /./ in patterns, but not at the end.
+      if (slash == string::npos || !(part.empty() || part == ".")) {
+        FileComponent component;
+        component._pattern = part;
+        component._has_glob = GlobPattern(part).has_glob_characters();
+        if (component._has_glob) {
+          component._matcher.add_pattern(part, _case_sensitive, _nomatch_chars);
+        }
+        new_components->push_back(std::move(component));
       }
-    }
 
-    if (ch == (*pi)) {
-      matched = true;
+      if (slash == string::npos) {
+        break;
+      }
+      p = slash + 1;
     }
 
-    // Maybe it's an a-z style range?
-    char start = (*pi);
-    ++pi;
-    if (pi != pend && (*pi) == '-') {
-      ++pi;
-      if (pi != pend && (*pi) != ']') {
-        // Yes, we have a range: start-end.
-
-        if ((*pi) == '\\') {
-          // Backslash escapes.
-          ++pi;
-          if (pi == pend) {
-            return false;
-          }
-        }
-
-        char end = (*pi);
-        ++pi;
-
-        if ((ch >= start && ch <= end) ||
-            (!_case_sensitive &&
-             ((tolower(ch) >= start && tolower(ch) <= end) ||
-              (toupper(ch) >= start && toupper(ch) <= end)))) {
-          matched = true;
-        }
-      } else {
-        // This was a - at the end of the string.
-        if (ch == '-') {
-          matched = true;
-        }
-      }
+    components = (FileComponents *)AtomicAdjust::compare_and_exchange_ptr(_file_components, nullptr, new_components);
+    if (components == nullptr) {
+      components = new_components;
+    } else {
+      // Another thread got there first.
+      delete new_components;
     }
   }
-
-  return matched;
+  return *components;
 }
@@ -17,6 +17,8 @@
 #include "dtoolbase.h"
 #include "filename.h"
 #include "vector_string.h"
+#include "globMatcher.h"
+#include "atomicAdjust.h"
 
 /**
  * This class can be used to test for string matches against standard Unix-
@@ -28,11 +30,17 @@
  * strings; for each candidate, it will indicate whether the string matches
  * the pattern or not.  It can be used, for example, to scan a directory for
  * all files matching a particular pattern.
+ *
+ * The pattern is compiled into a GlobMatcher the first time it is tested
+ * against a candidate, so that testing each candidate takes time proportional
+ * to its length.  To test candidates against several patterns at once, use a
+ * GlobMatcher directly.
  */
 class EXPCL_DTOOL_DTOOLUTIL GlobPattern {
 PUBLISHED:
   INLINE GlobPattern(const std::string &pattern = std::string());
   INLINE GlobPattern(const GlobPattern &copy);
+  INLINE ~GlobPattern();
   INLINE void operator = (const GlobPattern &copy);
 
   INLINE bool operator == (const GlobPattern &other) const;
@@ -58,28 +66,47 @@ PUBLISHED:
 
   bool has_glob_characters() const;
   std::string get_const_prefix() const;
-  int match_files(vector_string &results, const Filename &cwd = Filename()) const;
+  int match_files(vector_string &results, const Filename &cwd = Filename(),
+                  int num_threads = 1) const;
 #ifdef HAVE_PYTHON
   EXTENSION(PyObject *match_files(const Filename &cwd = Filename()) const);
 #endif
 
-private:
-  bool matches_substr(std::string::const_iterator pi,
-                      std::string::const_iterator pend,
-                      std::string::const_iterator ci,
-                      std::string::const_iterator cend) const;
-
-  bool matches_set(std::string::const_iterator &pi,
-                   std::string::const_iterator pend,
-                   char ch) const;
+public:
+  typedef void MatchCallback(const std::string &filename, void *data);
+  int match_files(MatchCallback *callback, void *data,
+                  const Filename &cwd = Filename(), int num_threads = 1) const;
 
-  int r_match_files(const Filename &prefix, const std::string &suffix,
-                    vector_string &results, const Filename &cwd);
-  bool r_matches_file(const std::string &suffix, const Filename &candidate) const;
+private:
+  class MatchWalker;
+
+  // The pattern split at the slashes, for matches_file().  Each component
+  // that contains glob characters has its own compiled GlobMatcher.
+  class FileComponent {
+  public:
+    std::string _pattern;
+    bool _has_glob;
+    GlobMatcher _matcher;
+  };
+  typedef pvector<FileComponent> FileComponents;
+
+  const GlobMatcher &get_matcher() const;
+  const FileComponents &get_file_components() const;
+  INLINE void clear_matcher();
+
+  void r_match_files(const Filename &prefix, const std::string &suffix,
+                     MatchWalker &walker) const;
+  bool r_matches_file(const FileComponents &components, size_t pi,
+                      const Filename &candidate) const;
 
   std::string _pattern;
   bool _case_sensitive;
   std::string _nomatch_chars;
+
+  // The compiled GlobMatcher and FileComponents, or nullptr if they haven't
+  // been needed yet.
+  mutable TVOLATILE AtomicAdjust::Pointer _matcher;
+  mutable TVOLATILE AtomicAdjust::Pointer _file_components;
 };
 
 INLINE std::ostream &operator << (std::ostream &out, const GlobPattern &glob) {
@@ -0,0 +1,194 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file incrementalTextDecoder.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "incrementalTextDecoder.h"
+#include "stringDecoder.h"
+
+/**
+ * Decodes as much of the indicated piece of text as will fit in the output
+ * buffer, and advances both pointers past the data that was converted.  A
+ * character that is cut off by the end of the piece is consumed, but not
+ * written until the rest of it is passed to the next call.
+ *
+ * Set flush to true when passing the last piece of the text, to indicate that
+ * no more is coming.  If the text ends partway through a character, this is
+ * reported, and the partial character discarded.
+ *
+ * Returns true if all of the input was consumed, or false if the output
+ * buffer filled up first, in which case this should be called again with the
+ * rest of the input and a fresh output buffer.
+ */
+bool IncrementalTextDecoder::
+decode(const char *&in, const char *in_end,
+       wchar_t *&out, wchar_t *out_end, bool flush) {
+  const char *start = in;
+  bool all_consumed = true;
+
+  while (true) {
+    if (_num_pending != 0) {
+      // First finish the character that was cut off at the end of the last
+      // piece of text.
+      size_t length = get_pending_length();
+      while (_num_pending < length && in < in_end) {
+        _pending[_num_pending++] = (unsigned char)*in++;
+        length = get_pending_length();
+      }
+
+      if (_num_pending < length) {
+        if (!flush) {
+          // We'll need more text to finish it.
+          break;
+        }
+
+        // There is no more text coming.
+        if (out == out_end) {
+          all_consumed = false;
+          break;
+        }
+        if (_encoding == TextEncoder::E_utf16be && _num_pending >= 2) {
+          // An unpaired high surrogate is kept, as by decode_text().
+          *out++ = (wchar_t)((_pending[0] << 8) | _pending[1]);
+          if ((_num_pending & 1) != 0) {
+            report_truncated(_num_bytes + (in - start) - 1);
+          }
+        } else {
+          report_truncated(_num_bytes + (in - start) - _num_pending);
+        }
+        _num_pending = 0;
+        continue;
+      }
+
+      const char *p = (const char *)_pending;
+      TextEncoder::decode_chunk(p, p + _num_pending, out, out_end, _encoding);
+      size_t used = p - (const char *)_pending;
+      if (used == 0) {
+        // There's no room for it.
+        all_consumed = false;
+        break;
+      }
+      _num_pending -= used;
+      memmove(_pending, _pending + used, _num_pending);
+      continue;
+    }
+
+    if (in == in_end) {
+      break;
+    }
+
+    TextEncoder::ChunkResult result =
+      TextEncoder::decode_chunk(in, in_end, out, out_end, _encoding);
+
+    if (result == TextEncoder::CR_done) {
+      break;
+
+    } else if (result == TextEncoder::CR_output_full) {
+      all_consumed = false;
+      break;
+
+    } else if (result == TextEncoder::CR_invalid) {
+      if (out == out_end) {
+        all_consumed = false;
+        break;
+      }
+      report_invalid((unsigned char)*in, _num_bytes + (in - start));
+      *out++ = 0xfffd;
+      ++in;
+
+    } else {
+      // The piece ends partway through a character.  Hold on to what there
+      // is of it, and go around again to finish it if this is the last one.
+      _num_pending = in_end - in;
+      assert(_num_pending < sizeof(_pending));
+      memcpy(_pending, in, _num_pending);
+      in = in_end;
+    }
+  }
+
+  _num_bytes += in - start;
+  return all_consumed;
+}
+
+/**
+ * Decodes the indicated piece of text, and appends the characters to the end
+ * of the result string.  See the other flavor of decode().
+ */
+void IncrementalTextDecoder::
+decode(const std::string &text, std::wstring &result, bool flush) {
+  // No byte decodes to more than one wide character, and neither does any of
+  // a character held over from the previous piece.
+  size_t start = result.size();
+  result.resize(start + text.size() + sizeof(_pending));
+
+  const char *in = text.data();
+  wchar_t *begin = &result[0];
+  wchar_t *out = begin + start;
+  bool all_consumed = decode(in, in + text.size(), out, begin + result.size(), flush);
+  assert(all_consumed);
+  (void)all_consumed;
+
+  result.resize(out - begin);
+}
+
+/**
+ * Returns the total number of bytes that make up the character whose
+ * beginning is held in _pending.
+ */
+size_t IncrementalTextDecoder::
+get_pending_length() const {
+  if (_encoding == TextEncoder::E_utf16be) {
+    // A high surrogate should be followed by a low surrogate.
+    if (_num_pending >= 2 && (_pending[0] & 0xfc) == 0xd8) {
+      return 4;
+    }
+    return 2;
+  }
+
+  unsigned int lead = _pending[0];
+  if ((lead & 0xe0) == 0xc0) {
+    return 2;
+  } else if ((lead & 0xf0) == 0xe0) {
+    return 3;
+  } else {
+    return 4;
+  }
+}
+
+/**
+ * Reports a byte that can't begin a UTF-8 sequence.
+ */
+void IncrementalTextDecoder::
+report_invalid(unsigned char byte, uint64_t offset) const {
+  std::ostream *notify_ptr = StringDecoder::get_notify_ptr();
+  if (notify_ptr != nullptr) {
+    (*notify_ptr)
+      << "Non utf-8 byte in text: 0x" << std::hex << (unsigned int)byte
+      << std::dec << " at offset " << offset << "\n";
+  }
+}
+
+/**
+ * Reports that the text ends partway through a character.
+ */
+void IncrementalTextDecoder::
+report_truncated(uint64_t offset) const {
+  std::ostream *notify_ptr = StringDecoder::get_notify_ptr();
+  if (notify_ptr != nullptr) {
+    if (_encoding == TextEncoder::E_utf16be) {
+      (*notify_ptr)
+        << "Unicode-encoded text has odd number of bytes.\n";
+    } else {
+      (*notify_ptr)
+        << "utf-8 encoded text ends abruptly at offset " << offset << ".\n";
+    }
+  }
+}
@@ -0,0 +1,64 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file incrementalTextDecoder.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef INCREMENTALTEXTDECODER_H
+#define INCREMENTALTEXTDECODER_H
+
+#include "dtoolbase.h"
+#include "textEncoder.h"
+
+/**
+ * Decodes text that arrives a piece at a time, for instance while reading a
+ * large file in blocks, into wide characters.  The pieces may be split at any
+ * byte, even in the middle of a multi-byte character; the decoder holds on to
+ * the beginning of such a character until the rest of it arrives.
+ *
+ * The characters are written into a buffer supplied by the caller, so that
+ * text of any length may be decoded in a fixed amount of memory.  See also
+ * IncrementalTextEncoder, and TranscodeStreamBuf, which uses both to convert
+ * a stream from one encoding to another.
+ */
+class EXPCL_DTOOL_DTOOLUTIL IncrementalTextDecoder {
+public:
+  INLINE explicit IncrementalTextDecoder(TextEncoder::Encoding encoding = TextEncoder::get_default_encoding());
+
+  INLINE void set_encoding(TextEncoder::Encoding encoding);
+  INLINE TextEncoder::Encoding get_encoding() const;
+
+  INLINE void reset();
+  INLINE bool has_pending() const;
+  INLINE uint64_t get_num_bytes() const;
+
+  bool decode(const char *&in, const char *in_end,
+              wchar_t *&out, wchar_t *out_end, bool flush = false);
+  void decode(const std::string &text, std::wstring &result,
+              bool flush = false);
+
+private:
+  size_t get_pending_length() const;
+  void report_invalid(unsigned char byte, uint64_t offset) const;
+  void report_truncated(uint64_t offset) const;
+
+  TextEncoder::Encoding _encoding;
+
+  // The beginning of a character that was cut off by the end of the previous
+  // piece of text.
+  unsigned char _pending[4];
+  size_t _num_pending;
+
+  uint64_t _num_bytes;
+};
+
+#include "incrementalTextDecoder.I"
+
+#endif
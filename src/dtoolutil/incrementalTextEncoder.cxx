@@ -0,0 +1,119 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file incrementalTextEncoder.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "incrementalTextEncoder.h"
+
+/**
+ * Encodes as much of the indicated piece of text as will fit in the output
+ * buffer, and advances both pointers past the data that was converted.  The
+ * output buffer should have room for at least four bytes, the most that any
+ * one character takes.
+ *
+ * Set flush to true when passing the last piece of the text, to indicate that
+ * no more is coming.
+ *
+ * Returns true if all of the input was consumed, or false if the output
+ * buffer filled up first, in which case this should be called again with the
+ * rest of the input and a fresh output buffer.
+ */
+bool IncrementalTextEncoder::
+encode(const wchar_t *&in, const wchar_t *in_end,
+       char *&out, char *out_end, bool flush) {
+  while (true) {
+    if (_pending != 0) {
+      if (in == in_end && !flush) {
+        // We'll need more text to see whether it is part of a pair.
+        return true;
+      }
+
+      // Encode it together with the first character of this piece.
+      wchar_t pair[2] = { _pending, 0 };
+      size_t num_units = 1;
+      if (in < in_end) {
+        pair[1] = *in;
+        num_units = 2;
+      }
+
+      const wchar_t *p = pair;
+      TextEncoder::ChunkResult result =
+        TextEncoder::encode_chunk(p, pair + num_units, out, out_end, _encoding);
+
+      if (p == pair) {
+        if (result != TextEncoder::CR_incomplete) {
+          // There's no room for it.
+          return false;
+        }
+
+        // The text ends in an unpaired high surrogate, which is encoded by
+        // itself, as by encode_wtext().
+        std::string encoded = TextEncoder::encode_wchar((char32_t)_pending, _encoding);
+        if (encoded.size() > (size_t)(out_end - out)) {
+          return false;
+        }
+        memcpy(out, encoded.data(), encoded.size());
+        out += encoded.size();
+      }
+
+      _pending = 0;
+      if (p == pair + 2) {
+        // The first character of this piece was encoded along with it.
+        ++in;
+      }
+      continue;
+    }
+
+    if (in == in_end) {
+      return true;
+    }
+
+    TextEncoder::ChunkResult result =
+      TextEncoder::encode_chunk(in, in_end, out, out_end, _encoding);
+
+    if (result == TextEncoder::CR_done) {
+      return true;
+
+    } else if (result == TextEncoder::CR_output_full) {
+      return false;
+    }
+
+    // The piece ends in a high surrogate.  Hold on to it, and go around again
+    // to encode it by itself if this is the last piece.
+    _pending = *in++;
+  }
+}
+
+/**
+ * Encodes the indicated piece of text, and appends the result to the end of
+ * the result string.  See the other flavor of encode().
+ */
+void IncrementalTextEncoder::
+encode(const std::wstring &wtext, std::string &result, bool flush) {
+  const wchar_t *in = wtext.data();
+  const wchar_t *in_end = in + wtext.size();
+
+  size_t pos = result.size();
+  result.resize(pos + wtext.size() + 4);
+
+  while (true) {
+    char *begin = &result[0];
+    char *out = begin + pos;
+    bool all_consumed = encode(in, in_end, out, begin + result.size(), flush);
+    pos = out - begin;
+    if (all_consumed) {
+      break;
+    }
+    result.resize(std::max(pos + (in_end - in) + 4, result.size() + result.size() / 2));
+  }
+
+  result.resize(pos);
+}
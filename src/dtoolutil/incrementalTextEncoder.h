@@ -0,0 +1,50 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file incrementalTextEncoder.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef INCREMENTALTEXTENCODER_H
+#define INCREMENTALTEXTENCODER_H
+
+#include "dtoolbase.h"
+#include "textEncoder.h"
+
+/**
+ * The counterpart of IncrementalTextDecoder: encodes wide-character text that
+ * is produced a piece at a time into a buffer supplied by the caller.  Where
+ * wchar_t is 16 bits, a piece may end between the two halves of a surrogate
+ * pair; the encoder holds on to the first half until the second arrives.
+ */
+class EXPCL_DTOOL_DTOOLUTIL IncrementalTextEncoder {
+public:
+  INLINE explicit IncrementalTextEncoder(TextEncoder::Encoding encoding = TextEncoder::get_default_encoding());
+
+  INLINE void set_encoding(TextEncoder::Encoding encoding);
+  INLINE TextEncoder::Encoding get_encoding() const;
+
+  INLINE void reset();
+  INLINE bool has_pending() const;
+
+  bool encode(const wchar_t *&in, const wchar_t *in_end,
+              char *&out, char *out_end, bool flush = false);
+  void encode(const std::wstring &wtext, std::string &result,
+              bool flush = false);
+
+private:
+  TextEncoder::Encoding _encoding;
+
+  // A high surrogate that ended the previous piece of text, or 0.
+  wchar_t _pending;
+};
+
+#include "incrementalTextEncoder.I"
+
+#endif
@@ -2,8 +2,12 @@
 #include "config_dtoolutil.cxx"
 #include "dSearchPath.cxx"
 #include "executionEnvironment.cxx"
+#include "fileStatCache.cxx"
 #include "filename.cxx"
+#include "globMatcher.cxx"
 #include "globPattern.cxx"
+#include "incrementalTextDecoder.cxx"
+#include "incrementalTextEncoder.cxx"
 #include "lineStream.cxx"
 #include "lineStreamBuf.cxx"
 #include "load_dso.cxx"
@@ -7,6 +7,8 @@
 #include "string_utils.cxx"
 #include "stringDecoder.cxx"
 #include "textEncoder.cxx"
+#include "transcodeStream.cxx"
+#include "transcodeStreamBuf.cxx"
 #include "unicodeLatinMap.cxx"
 #include "vector_double.cxx"
 #include "vector_float.cxx"
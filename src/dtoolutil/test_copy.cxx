@@ -0,0 +1,137 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_copy.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "dtoolbase.h"
+#include "filename.h"
+
+#include <chrono>
+#include <stdlib.h>
+
+/**
+ * Returns true if the two files exist and have exactly the same contents.
+ */
+static bool
+same_contents(Filename a, Filename b) {
+  a.set_binary();
+  b.set_binary();
+  pifstream in_a, in_b;
+  if (!a.open_read(in_a) || !b.open_read(in_b)) {
+    return false;
+  }
+
+  static const size_t buffer_size = 65536;
+  char buffer_a[buffer_size];
+  char buffer_b[buffer_size];
+  while (true) {
+    in_a.read(buffer_a, buffer_size);
+    in_b.read(buffer_b, buffer_size);
+    std::streamsize count = in_a.gcount();
+    if (count != in_b.gcount() ||
+        memcmp(buffer_a, buffer_b, (size_t)count) != 0) {
+      return false;
+    }
+    if (count == 0) {
+      return !in_a.bad() && !in_b.bad();
+    }
+  }
+}
+
+/**
+ * Measures the throughput of Filename::copy_to() and Filename::copy_files()
+ * by copying a scratch file of the indicated size into the given directory.
+ */
+int
+main(int argc, char *argv[]) {
+  if (argc < 3) {
+    std::cout << "test_copy size_mb dirname [num_copies [num_threads]]\n";
+    return (1);
+  }
+
+  size_t size_mb = (size_t)atoi(argv[1]);
+  Filename dirname = Filename::from_os_specific(argv[2]);
+  int num_copies = (argc > 3) ? atoi(argv[3]) : 8;
+  int num_threads = (argc > 4) ? atoi(argv[4]) : 0;
+
+  // Write out a source file with some non-trivial contents.
+  Filename source = Filename::temporary(dirname, "copy_src");
+  source.set_binary();
+  {
+    pofstream out;
+    if (!source.open_write(out)) {
+      std::cerr << "Couldn't write " << source << "\n";
+      return (1);
+    }
+    std::string block(1024 * 1024, '\0');
+    for (size_t i = 0; i < block.size(); ++i) {
+      block[i] = (char)(i * 7 + (i >> 10));
+    }
+    for (size_t i = 0; i < size_mb; ++i) {
+      out.write(block.data(), block.size());
+    }
+  }
+
+  typedef std::chrono::steady_clock Clock;
+  double total_mb = (double)size_mb;
+
+  // First, a single copy.
+  Filename dest = Filename::temporary(dirname, "copy_dst");
+  Clock::time_point start = Clock::now();
+  bool success = source.copy_to(dest);
+  double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+  if (!success) {
+    std::cerr << "Couldn't copy " << source << " to " << dest << "\n";
+    dest.unlink();
+    source.unlink();
+    return (1);
+  }
+  if (!same_contents(source, dest)) {
+    std::cerr << "Contents of " << dest << " differ from " << source << "\n";
+    dest.unlink();
+    source.unlink();
+    return (1);
+  }
+  dest.unlink();
+  std::cout << "copy_to: " << total_mb << " MB in " << elapsed << " s, "
+            << total_mb / elapsed << " MB/s\n";
+
+  // Now, many copies at once.
+  pvector<Filename> sources(num_copies, source);
+  pvector<Filename> dests;
+  for (int i = 0; i < num_copies; ++i) {
+    dests.push_back(Filename::temporary(dirname, "copy_dst"));
+  }
+
+  start = Clock::now();
+  size_t num_copied = Filename::copy_files(sources, dests, num_threads);
+  elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+  size_t num_correct = 0;
+  for (const Filename &filename : dests) {
+    if (same_contents(source, filename)) {
+      ++num_correct;
+    } else {
+      std::cerr << "Contents of " << filename << " differ from " << source << "\n";
+    }
+    filename.unlink();
+  }
+  source.unlink();
+
+  total_mb *= num_copies;
+  std::cout << "copy_files: " << num_copied << " of " << num_copies
+            << " files, " << total_mb << " MB in " << elapsed << " s, "
+            << total_mb / elapsed << " MB/s\n";
+
+  return (num_copied == (size_t)num_copies &&
+          num_correct == (size_t)num_copies) ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_dsearchpath.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "dtoolbase.h"
+#include "dSearchPath.h"
+#include "filename.h"
+
+#include <chrono>
+#include <sstream>
+#include <stdlib.h>
+
+/**
+ * Times a series of lookups on the search path, and returns the number of
+ * lookups that found a file.
+ */
+static int
+run_lookups(const DSearchPath &path, int num_dirs, int num_lookups,
+            double &elapsed) {
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point start = Clock::now();
+
+  int num_found = 0;
+  for (int i = 0; i < num_lookups; ++i) {
+    // Half of the lookups are for files that don't exist anywhere.
+    std::ostringstream strm;
+    strm << "file" << (i % (num_dirs * 2)) << ".txt";
+    if (!path.find_file(strm.str()).empty()) {
+      ++num_found;
+    }
+  }
+
+  elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  return num_found;
+}
+
+/**
+ * Compares the time taken by DSearchPath::find_file() on a long search path,
+ * with and without indexing.
+ */
+int
+main(int argc, char *argv[]) {
+  if (argc < 2) {
+    std::cout << "test_dsearchpath dirname [num_dirs [num_lookups]]\n";
+    return (1);
+  }
+
+  Filename root = Filename::from_os_specific(argv[1]);
+  int num_dirs = (argc > 2) ? atoi(argv[2]) : 50;
+  int num_lookups = (argc > 3) ? atoi(argv[3]) : 100000;
+
+  // Make a directory tree in which directory n contains file n.
+  DSearchPath path;
+  for (int n = 0; n < num_dirs; ++n) {
+    std::ostringstream dstrm;
+    dstrm << "dir" << n;
+    Filename dirname(root, dstrm.str());
+    dirname.mkdir();
+    path.append_directory(dirname);
+
+    std::ostringstream fstrm;
+    fstrm << "file" << n << ".txt";
+    Filename(dirname, fstrm.str()).touch();
+  }
+
+  double plain_time;
+  int plain_found = run_lookups(path, num_dirs, num_lookups, plain_time);
+  std::cout << "plain: " << plain_found << " of " << num_lookups
+            << " found in " << plain_time << " s\n";
+
+  path.set_indexed(true);
+  double indexed_time;
+  int indexed_found = run_lookups(path, num_dirs, num_lookups, indexed_time);
+  std::cout << "indexed: " << indexed_found << " of " << num_lookups
+            << " found in " << indexed_time << " s\n";
+
+  // Clean up after ourselves.
+  for (int n = 0; n < num_dirs; ++n) {
+    std::ostringstream fstrm;
+    fstrm << "file" << n << ".txt";
+    Filename dirname = path.get_directory(n);
+    Filename(dirname, fstrm.str()).unlink();
+    dirname.rmdir();
+  }
+
+  return (plain_found == indexed_found) ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_filestatcache.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "dtoolbase.h"
+#include "fileStatCache.h"
+#include "filename.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+/**
+ * Reports a single case, returning true if the result was as expected.
+ */
+static bool
+check(const char *what, bool result, bool expected) {
+  if (result == expected) {
+    return true;
+  }
+  std::cout << what << ": gave " << result << ", expected " << expected << "\n";
+  return false;
+}
+
+/**
+ * Creates or removes the file behind Filename's back, so that the cache is
+ * not told about it.
+ */
+static void
+create_file(const Filename &filename) {
+  FILE *file = fopen(filename.to_os_specific().c_str(), "w");
+  if (file != nullptr) {
+    fclose(file);
+  }
+}
+
+static void
+remove_file(const Filename &filename) {
+  remove(filename.to_os_specific().c_str());
+}
+
+/**
+ * Checks that the FileStatCache reuses a result within its ttl, and asks the
+ * operating system again after the ttl expires or after the file has been
+ * invalidated.
+ */
+int
+main(int argc, char *argv[]) {
+  if (argc < 2) {
+    std::cout << "test_filestatcache dirname [ttl]\n";
+    return (1);
+  }
+
+  Filename root = Filename::from_os_specific(argv[1]);
+  double ttl = (argc > 2) ? atof(argv[2]) : 0.5;
+  root.mkdir();
+
+  Filename filename(root, "cached.txt");
+  remove_file(filename);
+
+  FileStatCache *cache = FileStatCache::get_global_ptr();
+  cache->set_ttl(ttl);
+
+  int num_failed = 0;
+
+  // The first question goes to the operating system; the second one, within
+  // the ttl, is answered from the cache even though the file has appeared.
+  size_t num_misses = cache->get_num_misses();
+  if (!check("initial", filename.exists(), false)) {
+    ++num_failed;
+  }
+  create_file(filename);
+  size_t num_hits = cache->get_num_hits();
+  if (!check("within ttl", filename.exists(), false)) {
+    ++num_failed;
+  }
+  if (cache->get_num_hits() != num_hits + 1 ||
+      cache->get_num_misses() != num_misses + 1) {
+    std::cout << "within ttl: expected one hit and one miss\n";
+    ++num_failed;
+  }
+
+  // Once the ttl has expired, we look again.
+  std::this_thread::sleep_for(std::chrono::duration<double>(ttl * 1.5));
+  if (!check("after ttl", filename.exists(), true)) {
+    ++num_failed;
+  }
+
+  // Now the file goes away, which we don't notice until it is invalidated.
+  remove_file(filename);
+  if (!check("before invalidate", filename.exists(), true)) {
+    ++num_failed;
+  }
+  cache->invalidate(filename);
+  if (!check("after invalidate", filename.exists(), false)) {
+    ++num_failed;
+  }
+
+  // Filename invalidates the file itself when it changes it.
+  filename.touch();
+  if (!check("after touch", filename.exists(), true)) {
+    ++num_failed;
+  }
+  filename.unlink();
+  if (!check("after unlink", filename.exists(), false)) {
+    ++num_failed;
+  }
+
+  cache->set_ttl(0.0);
+  root.rmdir();
+
+  if (num_failed == 0) {
+    std::cout << "All cached results were as expected.\n";
+  }
+  return (num_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_glob.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "dtoolbase.h"
+#include "globPattern.h"
+#include "filename.h"
+
+#include <chrono>
+#include <sstream>
+#include <stdlib.h>
+
+/**
+ * Returns the name of the nth entry at one level of the synthetic tree.
+ */
+static std::string
+get_name(const char *prefix, int n, const char *suffix = "") {
+  std::ostringstream strm;
+  strm << prefix << (n / 10) << (n % 10) << suffix;
+  return strm.str();
+}
+
+/**
+ * Creates or removes a tree of fanout^3 files under the indicated directory.
+ */
+static void
+make_tree(const Filename &root, int fanout, bool create) {
+  for (int i = 0; i < fanout; ++i) {
+    Filename dir1(root, get_name("d", i));
+    if (create) {
+      dir1.mkdir();
+    }
+    for (int j = 0; j < fanout; ++j) {
+      Filename dir2(dir1, get_name("e", j));
+      if (create) {
+        dir2.mkdir();
+      }
+      for (int k = 0; k < fanout; ++k) {
+        Filename file(dir2, get_name("file", k, (k & 1) ? ".dat" : ".txt"));
+        if (create) {
+          file.touch();
+        } else {
+          file.unlink();
+        }
+      }
+      if (!create) {
+        dir2.rmdir();
+      }
+    }
+    if (!create) {
+      dir1.rmdir();
+    }
+  }
+}
+
+/**
+ * Measures the time taken by GlobPattern::match_files() to search a synthetic
+ * tree of a million files, with one thread and with several.
+ */
+int
+main(int argc, char *argv[]) {
+  if (argc < 2) {
+    std::cout << "test_glob dirname [fanout [num_threads]]\n";
+    return (1);
+  }
+
+  Filename root = Filename::from_os_specific(argv[1]);
+  int fanout = (argc > 2) ? atoi(argv[2]) : 100;
+  int num_threads = (argc > 3) ? atoi(argv[3]) : 0;
+
+  // Reuse the tree from a previous run if it's there, since it takes a while
+  // to make.
+  bool made_tree = !Filename(root, get_name("d", 0)).is_directory();
+  if (made_tree) {
+    std::cout << "Creating " << fanout * fanout * fanout << " files in "
+              << root << "\n";
+    make_tree(root, fanout, true);
+  }
+
+  static const char *const patterns[] = {
+    "**/*.txt",
+    "d*/e*/*",
+    "d1*/e*/file0?.dat",
+    "d42/e*/file[0-4]*",
+  };
+
+  typedef std::chrono::steady_clock Clock;
+  bool success = true;
+
+  for (const char *pattern : patterns) {
+    GlobPattern glob(pattern);
+
+    vector_string serial_results;
+    Clock::time_point start = Clock::now();
+    glob.match_files(serial_results, root, 1);
+    double serial_time = std::chrono::duration<double>(Clock::now() - start).count();
+
+    vector_string parallel_results;
+    start = Clock::now();
+    glob.match_files(parallel_results, root, num_threads);
+    double parallel_time = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << pattern << ": " << serial_results.size() << " matches, "
+              << serial_time << " s with 1 thread, " << parallel_time
+              << " s with " << num_threads << " threads\n";
+
+    if (serial_results.size() != parallel_results.size()) {
+      std::cout << "  mismatch: " << parallel_results.size()
+                << " matches with " << num_threads << " threads\n";
+      success = false;
+    }
+  }
+
+  if (made_tree) {
+    make_tree(root, fanout, false);
+  }
+
+  return success ? 0 : 1;
+}
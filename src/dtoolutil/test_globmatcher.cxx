@@ -0,0 +1,417 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_globmatcher.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "dtoolbase.h"
+#include "globMatcher.h"
+#include "globPattern.h"
+
+#include <ctype.h>
+
+using std::string;
+
+static const int num_random_patterns = 20000;
+static const int num_candidates_per_pattern = 20;
+
+/**
+ * The matching rules as GlobPattern has always implemented them, by
+ * recursive backtracking.  Slow, but easy to check by eye.
+ */
+class ReferenceMatcher {
+public:
+  ReferenceMatcher(const string &pattern, bool case_sensitive,
+                   const string &nomatch_chars) :
+    _pattern(pattern),
+    _case_sensitive(case_sensitive),
+    _nomatch_chars(nomatch_chars) {}
+
+  bool matches(const string &candidate) const {
+    return matches_substr(0, 0, candidate);
+  }
+
+private:
+  bool matches_substr(size_t pi, size_t ci, const string &candidate) const;
+  bool matches_set(size_t &pi, char ch) const;
+
+  string _pattern;
+  bool _case_sensitive;
+  string _nomatch_chars;
+};
+
+/**
+ * Returns true if the pattern from pi on matches the candidate from ci on.
+ */
+bool ReferenceMatcher::
+matches_substr(size_t pi, size_t ci, const string &candidate) const {
+  size_t pend = _pattern.size();
+  size_t cend = candidate.size();
+  if (pi == pend || ci == cend) {
+    // A * as the very last character may match the end of the candidate.
+    if (ci == cend && pi + 1 == pend && _pattern[pi] == '*') {
+      return true;
+    }
+    return (pi == pend && ci == cend);
+  }
+
+  switch (_pattern[pi]) {
+  case '*':
+    if (_nomatch_chars.find(candidate[ci]) == string::npos) {
+      return matches_substr(pi, ci + 1, candidate) ||
+             matches_substr(pi + 1, ci, candidate);
+    }
+    return matches_substr(pi + 1, ci, candidate);
+
+  case '?':
+    return matches_substr(pi + 1, ci + 1, candidate);
+
+  case '[':
+    ++pi;
+    if (pi != pend && _pattern[pi] == '!') {
+      ++pi;
+      if (matches_set(pi, candidate[ci])) {
+        return false;
+      }
+    } else {
+      if (!matches_set(pi, candidate[ci])) {
+        return false;
+      }
+    }
+    if (pi == pend) {
+      return false;
+    }
+    return matches_substr(pi + 1, ci + 1, candidate);
+
+  case '\\':
+    ++pi;
+    if (pi == pend) {
+      return false;
+    }
+    // fall through.
+
+  default:
+    if (_case_sensitive) {
+      if (_pattern[pi] != candidate[ci]) {
+        return false;
+      }
+    } else {
+      if (tolower(_pattern[pi]) != tolower(candidate[ci])) {
+        return false;
+      }
+    }
+    return matches_substr(pi + 1, ci + 1, candidate);
+  }
+}
+
+/**
+ * Called with pi after the opening square bracket of a set, leaves pi on the
+ * closing bracket and returns true if ch is in the set.
+ */
+bool ReferenceMatcher::
+matches_set(size_t &pi, char ch) const {
+  size_t pend = _pattern.size();
+  bool matched = false;
+
+  while (pi != pend && _pattern[pi] != ']') {
+    if (_pattern[pi] == '\\') {
+      ++pi;
+      if (pi == pend) {
+        return false;
+      }
+    }
+
+    if (ch == _pattern[pi]) {
+      matched = true;
+    }
+
+    char start = _pattern[pi];
+    ++pi;
+    if (pi != pend && _pattern[pi] == '-') {
+      ++pi;
+      if (pi != pend && _pattern[pi] != ']') {
+        if (_pattern[pi] == '\\') {
+          ++pi;
+          if (pi == pend) {
+            return false;
+          }
+        }
+
+        char end = _pattern[pi];
+        ++pi;
+
+        if ((ch >= start && ch <= end) ||
+            (!_case_sensitive &&
+             ((tolower(ch) >= start && tolower(ch) <= end) ||
+              (toupper(ch) >= start && toupper(ch) <= end)))) {
+          matched = true;
+        }
+      } else {
+        if (ch == '-') {
+          matched = true;
+        }
+      }
+    }
+  }
+
+  return matched;
+}
+
+/**
+ * A small deterministic random number generator, so that any failure can be
+ * reproduced.
+ */
+static unsigned int random_state = 12345;
+static unsigned int
+random_int(unsigned int range) {
+  random_state = random_state * 1103515245u + 12345u;
+  return (random_state >> 16) % range;
+}
+
+/**
+ * Returns a random string of up to max_length characters from the alphabet.
+ */
+static string
+random_string(const char *alphabet, size_t max_length) {
+  size_t alphabet_size = strlen(alphabet);
+  size_t length = random_int((unsigned int)max_length + 1);
+  string result;
+  for (size_t i = 0; i < length; ++i) {
+    result += alphabet[random_int((unsigned int)alphabet_size)];
+  }
+  return result;
+}
+
+/**
+ * Reports a single case, returning true if the result was as expected.
+ */
+static bool
+check(const string &pattern, const string &candidate, bool result,
+      bool expected, const char *what) {
+  if (result == expected) {
+    return true;
+  }
+  std::cout << what << ": \"" << pattern << "\" against \"" << candidate
+            << "\" gave " << result << ", expected " << expected << "\n";
+  return false;
+}
+
+struct FixedCase {
+  const char *pattern;
+  const char *candidate;
+  bool case_sensitive;
+  const char *nomatch_chars;
+  bool expected;
+};
+
+static const FixedCase fixed_cases[] = {
+  { "", "", true, "", true },
+  { "", "a", true, "", false },
+  { "abc", "abc", true, "", true },
+  { "abc", "abcd", true, "", false },
+  { "abc", "ABC", false, "", true },
+  { "abc", "ABC", true, "", false },
+  { "*", "", true, "", true },
+  { "*", "anything", true, "", true },
+  { "*.txt", "notes.txt", true, "", true },
+  { "*.txt", "notes.txt.bak", true, "", false },
+  { "a*b*c", "aXXbYYc", true, "", true },
+  { "a*b*c", "aXXcYYb", true, "", false },
+  { "a*a*a*a*b", "aaaaaaaaaaaaaaaaaaaaaaaa", true, "", false },
+  { "a*", "a", true, "", true },
+  { "a**", "ab", true, "", true },
+  { "?", "", true, "", false },
+  { "?", "x", true, "", true },
+  { "??", "x", true, "", false },
+  { "[abc]", "b", true, "", true },
+  { "[abc]", "d", true, "", false },
+  { "[!abc]", "d", true, "", true },
+  { "[!abc]", "a", true, "", false },
+  { "[a-c]x", "bx", true, "", true },
+  { "[a-c]x", "Bx", false, "", true },
+  { "[a-c]x", "Bx", true, "", false },
+  { "[a-]", "-", true, "", true },
+  { "[abc", "a", true, "", false },
+  { "\\*", "*", true, "", true },
+  { "\\*", "a", true, "", false },
+  { "[\\]]", "]", true, "", true },
+  { "a\\", "a", true, "", false },
+  { "*.egg", "models/panda.egg", true, "/", false },
+  { "*/*.egg", "models/panda.egg", true, "/", true },
+  { "*", "a/b", true, "/", false },
+};
+
+struct FileCase {
+  const char *pattern;
+  const char *candidate;
+  bool expected;
+};
+
+static const FileCase file_cases[] = {
+  { "*.egg", "panda.egg", true },
+  { "*.egg", "models/panda.egg", false },
+  { "*/*.egg", "models/panda.egg", true },
+  { "models/*.egg", "models/panda.egg", true },
+  { "models/*.egg", "maps/panda.egg", false },
+  { "models//./*.egg", "models/panda.egg", true },
+  { "models/*.egg", "models/./panda.egg", true },
+  { "**/*.egg", "panda.egg", true },
+  { "**/*.egg", "a/b/c/panda.egg", true },
+  { "**/*.egg", "a/b/c/panda.bam", false },
+  { "a/**/b/*.egg", "a/x/y/b/panda.egg", true },
+  { "a/**/b/*.egg", "a/b/panda.egg", true },
+  { "a/**/b/*.egg", "a/x/y/c/panda.egg", false },
+  { "a/**", "a/b/c", true },
+  { "/usr/*/lib", "/usr/local/lib", true },
+  { "/usr/*/lib", "usr/local/lib", false },
+  { "models/.", "models/", true },
+  { "models/", "models/.", true },
+  { "m?dels/[a-p]*.egg", "models/panda.egg", true },
+  { "m?dels/[a-p]*.egg", "models/teapot.egg", false },
+};
+
+/**
+ * Checks the GlobMatcher against a table of known results and against the
+ * reference implementation for many random patterns, alone and combined.
+ */
+int
+main(int argc, char *argv[]) {
+  int num_failed = 0;
+
+  // First, the fixed cases, which pin down the expected behavior.
+  for (const FixedCase &fc : fixed_cases) {
+    GlobPattern glob(fc.pattern);
+    glob.set_case_sensitive(fc.case_sensitive);
+    glob.set_nomatch_chars(fc.nomatch_chars);
+    if (!check(fc.pattern, fc.candidate, glob.matches(fc.candidate),
+               fc.expected, "fixed")) {
+      ++num_failed;
+    }
+    ReferenceMatcher ref(fc.pattern, fc.case_sensitive, fc.nomatch_chars);
+    if (!check(fc.pattern, fc.candidate, ref.matches(fc.candidate),
+               fc.expected, "reference")) {
+      ++num_failed;
+    }
+  }
+
+  // Now, compare each random pattern with the reference implementation.
+  const char *pattern_chars = "abAB*?[]!-\\.";
+  const char *candidate_chars = "abAB-.!/";
+  for (int i = 0; i < num_random_patterns && num_failed < 20; ++i) {
+    string pattern = random_string(pattern_chars, 8);
+    bool case_sensitive = (random_int(2) == 0);
+    string nomatch_chars = (random_int(4) == 0) ? "." : "";
+
+    GlobMatcher matcher;
+    matcher.add_pattern(pattern, case_sensitive, nomatch_chars);
+    GlobPattern glob(pattern);
+    glob.set_case_sensitive(case_sensitive);
+    glob.set_nomatch_chars(nomatch_chars);
+    ReferenceMatcher ref(pattern, case_sensitive, nomatch_chars);
+
+    for (int j = 0; j < num_candidates_per_pattern; ++j) {
+      string candidate = random_string(candidate_chars, 10);
+      bool expected = ref.matches(candidate);
+      if (!check(pattern, candidate, matcher.matches(candidate), expected, "GlobMatcher") ||
+          !check(pattern, candidate, glob.matches(candidate), expected, "GlobPattern")) {
+        ++num_failed;
+      }
+    }
+  }
+
+  // Several patterns at once, enough to need more than one word of states,
+  // must report the first pattern that matches.
+  for (int i = 0; i < 500 && num_failed < 20; ++i) {
+    GlobMatcher matcher;
+    pvector<ReferenceMatcher> refs;
+    pvector<string> patterns;
+    int num_patterns = 1 + random_int(30);
+    for (int pi = 0; pi < num_patterns; ++pi) {
+      string pattern = random_string(pattern_chars, 8);
+      patterns.push_back(pattern);
+      matcher.add_pattern(pattern, true, "");
+      refs.push_back(ReferenceMatcher(pattern, true, ""));
+    }
+
+    vector_string candidates;
+    for (int j = 0; j < 50; ++j) {
+      candidates.push_back(random_string(candidate_chars, 10));
+    }
+
+    vector_int results;
+    matcher.find_matches(candidates, results);
+    vector_string filtered;
+    matcher.filter(candidates, filtered);
+
+    size_t num_matching = 0;
+    for (size_t ci = 0; ci < candidates.size(); ++ci) {
+      int expected = -1;
+      for (int pi = 0; pi < num_patterns; ++pi) {
+        if (refs[pi].matches(candidates[ci])) {
+          expected = pi;
+          break;
+        }
+      }
+      if (expected >= 0) {
+        ++num_matching;
+      }
+      if (results[ci] != expected ||
+          matcher.find_match(candidates[ci]) != expected) {
+        std::cout << "find_match: \"" << candidates[ci] << "\" gave "
+                  << results[ci] << ", expected " << expected
+                  << " with " << num_patterns << " patterns\n";
+        ++num_failed;
+      }
+    }
+    if (filtered.size() != num_matching) {
+      std::cout << "filter: " << filtered.size() << " matches, expected "
+                << num_matching << "\n";
+      ++num_failed;
+    }
+  }
+
+  // GlobPattern::matches_file() tests each path component on its own.  Each
+  // case is tested twice, to exercise the compiled components.
+  for (const FileCase &fc : file_cases) {
+    GlobPattern glob(fc.pattern);
+    for (int i = 0; i < 2; ++i) {
+      if (!check(fc.pattern, fc.candidate, glob.matches_file(fc.candidate),
+                 fc.expected, "matches_file")) {
+        ++num_failed;
+      }
+    }
+  }
+
+  // Changing the pattern must discard the previously compiled matcher, and a
+  // copy must match the same way as the original.
+  GlobPattern glob("*.cxx");
+  if (!glob.matches("a.cxx") || glob.matches("a.h")) {
+    std::cout << "*.cxx did not match as expected\n";
+    ++num_failed;
+  }
+  glob.set_pattern("*.h");
+  GlobPattern copy(glob);
+  if (glob.matches("a.cxx") || !glob.matches("a.h") ||
+      copy.matches("a.cxx") || !copy.matches("a.h")) {
+    std::cout << "*.h did not match as expected after set_pattern()\n";
+    ++num_failed;
+  }
+  glob.set_case_sensitive(false);
+  if (!glob.matches("A.H") || copy.matches("A.H") ||
+      !glob.matches_file("A.H") || copy.matches_file("A.H")) {
+    std::cout << "set_case_sensitive() was not honored\n";
+    ++num_failed;
+  }
+
+  if (num_failed == 0) {
+    std::cout << "All glob matches agree.\n";
+  }
+  return (num_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_textencoder.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "dtoolbase.h"
+#include "textEncoder.h"
+
+#include <chrono>
+#include <stdlib.h>
+
+// Samples of text in various scripts, in UTF-8.
+static const char *const samples[][2] = {
+  { "ascii", "The quick brown fox jumps over the lazy dog, again and again. " },
+  { "latin", "Fa\xc3\xa7" "ade na\xc3\xafve d\xc3\xa9j\xc3\xa0 vu, \xc3\xbc" "ber Stra\xc3\x9f" "e und K\xc3\xa4se. " },
+  { "cyrillic", "\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82, \xd0\xbc\xd0\xb8\xd1\x80! \xd0\xa1\xd1\x8a\xd0\xb5\xd1\x88\xd1\x8c \xd0\xb5\xd1\x89\xd1\x91. " },
+  { "cjk", "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe3\x81\xae\xe3\x83\x86\xe3\x82\xad\xe3\x82\xb9\xe3\x83\x88\xe3\x80\x82" },
+  { "emoji", "ok \xf0\x9f\x98\x80 fine \xf0\x9f\x8e\x89 done \xf0\x9f\x91\x8d " },
+};
+
+/**
+ * Returns the number of megabytes per second for the indicated work.
+ */
+static double
+get_rate(size_t num_bytes, double elapsed) {
+  return (double)num_bytes / (1024.0 * 1024.0) / elapsed;
+}
+
+/**
+ * Measures the throughput of TextEncoder's UTF-8 and UTF-16 conversions on
+ * corpora of several scripts, and checks that the conversions round-trip.
+ */
+int
+main(int argc, char *argv[]) {
+  size_t size_kb = (argc > 1) ? (size_t)atoi(argv[1]) : 4096;
+  int num_passes = (argc > 2) ? atoi(argv[2]) : 10;
+
+  typedef std::chrono::steady_clock Clock;
+  bool success = true;
+
+  for (const auto &sample : samples) {
+    // Build a corpus of the indicated size; every corpus also contains a
+    // sprinkling of ASCII, as real text does.
+    std::string text;
+    while (text.size() < size_kb * 1024) {
+      text += sample[1];
+      text += "id=42; ";
+    }
+
+    std::wstring wtext;
+    std::string utf8, utf16;
+    bool valid = false;
+
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < num_passes; ++i) {
+      valid = TextEncoder::is_valid_utf8(text);
+    }
+    double validate_time = std::chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (int i = 0; i < num_passes; ++i) {
+      wtext = TextEncoder::decode_text(text, TextEncoder::E_utf8);
+    }
+    double decode_time = std::chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (int i = 0; i < num_passes; ++i) {
+      utf8 = TextEncoder::encode_wtext(wtext, TextEncoder::E_utf8);
+    }
+    double encode_time = std::chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (int i = 0; i < num_passes; ++i) {
+      utf16 = TextEncoder::encode_wtext(wtext, TextEncoder::E_utf16be);
+    }
+    double encode16_time = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::wstring wtext16;
+    start = Clock::now();
+    for (int i = 0; i < num_passes; ++i) {
+      wtext16 = TextEncoder::decode_text(utf16, TextEncoder::E_utf16be);
+    }
+    double decode16_time = std::chrono::duration<double>(Clock::now() - start).count();
+
+    size_t total = text.size() * num_passes;
+    std::cout << sample[0] << ": validate " << get_rate(total, validate_time)
+              << " MB/s, decode " << get_rate(total, decode_time)
+              << " MB/s, encode " << get_rate(total, encode_time)
+              << " MB/s, utf-16 encode " << get_rate(total, encode16_time)
+              << " MB/s, utf-16 decode " << get_rate(total, decode16_time)
+              << " MB/s\n";
+
+    if (!valid || utf8 != text || wtext16 != wtext) {
+      std::cout << "  round trip failed\n";
+      success = false;
+    }
+  }
+
+  // Make sure that errors are caught at the right place.
+  std::string bad = std::string(40, 'a') + "\xe2\x82" + std::string(40, 'b');
+  size_t offset = TextEncoder::find_invalid_utf8(bad.data(), bad.size());
+  if (offset != 40) {
+    std::cout << "invalid sequence reported at " << offset << ", expected 40\n";
+    success = false;
+  }
+
+  return success ? 0 : 1;
+}
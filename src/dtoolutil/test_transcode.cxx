@@ -0,0 +1,175 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_transcode.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "dtoolbase.h"
+#include "incrementalTextDecoder.h"
+#include "incrementalTextEncoder.h"
+#include "transcodeStream.h"
+#include "pandaFileStream.h"
+#include "filename.h"
+
+#include <chrono>
+#include <stdlib.h>
+
+/**
+ * Converts the text a few bytes at a time, into output buffers of a few
+ * characters at a time, so that characters are split every which way.
+ */
+static std::string
+transcode_in_pieces(const std::string &text, TextEncoder::Encoding from,
+                    TextEncoder::Encoding to) {
+  IncrementalTextDecoder decoder(from);
+  IncrementalTextEncoder encoder(to);
+
+  std::string result;
+  size_t p = 0;
+  unsigned int seed = 1;
+  while (p <= text.size()) {
+    seed = seed * 1103515245 + 12345;
+    size_t piece = std::min((size_t)((seed >> 16) % 13), text.size() - p);
+    bool flush = (p + piece == text.size());
+
+    const char *in = text.data() + p;
+    const char *in_end = in + piece;
+    bool decoded;
+    do {
+      wchar_t wide[3];
+      wchar_t *wide_end = wide;
+      decoded = decoder.decode(in, in_end, wide_end, wide + 3, flush);
+
+      const wchar_t *wide_in = wide;
+      bool encoded;
+      do {
+        char bytes[5];
+        char *out = bytes;
+        encoded = encoder.encode(wide_in, wide_end, out, bytes + 5, flush && decoded);
+        result.append(bytes, out - bytes);
+      } while (!encoded);
+    } while (!decoded);
+
+    p += piece;
+    if (flush) {
+      break;
+    }
+  }
+  return result;
+}
+
+/**
+ * Returns the number of megabytes per second for the indicated work.
+ */
+static double
+get_rate(size_t num_bytes, double elapsed) {
+  return (double)num_bytes / (1024.0 * 1024.0) / elapsed;
+}
+
+/**
+ * Checks that text transcoded in arbitrary pieces comes out the same as text
+ * transcoded all at once, then measures the throughput of transcoding a file
+ * through ITranscodeStream and OTranscodeStream.
+ */
+int
+main(int argc, char *argv[]) {
+  size_t size_kb = (argc > 1) ? (size_t)atoi(argv[1]) : 16384;
+
+  typedef std::chrono::steady_clock Clock;
+  bool success = true;
+
+  std::string text;
+  while (text.size() < size_kb * 1024) {
+    text +=
+      "The quick brown fox, Fa\xc3\xa7" "ade na\xc3\xafve, "
+      "\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82, "
+      "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e, ok \xf0\x9f\x98\x80\n";
+  }
+
+  // Piecewise conversion, on a smaller sample.
+  std::string sample = text.substr(0, 64 * 1024);
+  static const TextEncoder::Encoding encodings[] = {
+    TextEncoder::E_utf8, TextEncoder::E_utf16be, TextEncoder::E_iso8859,
+  };
+  for (TextEncoder::Encoding to : encodings) {
+    std::string expected = TextEncoder::reencode_text(sample, TextEncoder::E_utf8, to);
+    if (transcode_in_pieces(sample, TextEncoder::E_utf8, to) != expected) {
+      std::cout << "piecewise conversion to " << to << " failed\n";
+      success = false;
+    }
+    if (to != TextEncoder::E_iso8859 &&
+        transcode_in_pieces(expected, to, TextEncoder::E_utf8) != sample) {
+      std::cout << "piecewise conversion from " << to << " failed\n";
+      success = false;
+    }
+  }
+
+  Filename utf8_file = Filename::temporary("", "transcode_", ".txt");
+  Filename utf16_file = Filename::temporary("", "transcode_", ".txt");
+  utf8_file.set_binary();
+  utf16_file.set_binary();
+  {
+    pofstream out;
+    utf8_file.open_write(out, true);
+    out.write(text.data(), text.size());
+  }
+
+  // UTF-8 to UTF-16, reading from a file.
+  Clock::time_point start = Clock::now();
+  {
+    pifstream *in = new pifstream;
+    utf8_file.open_read(*in);
+    ITranscodeStream transcoder(in, true, TextEncoder::E_utf8, TextEncoder::E_utf16be);
+
+    pofstream out;
+    utf16_file.open_write(out, true);
+    char buffer[65536];
+    while (transcoder.read(buffer, sizeof(buffer)) || transcoder.gcount() != 0) {
+      out.write(buffer, transcoder.gcount());
+    }
+  }
+  double read_time = std::chrono::duration<double>(Clock::now() - start).count();
+
+  // And back again, writing to a file.
+  start = Clock::now();
+  {
+    pofstream *out = new pofstream;
+    utf8_file.open_write(*out, true);
+    OTranscodeStream transcoder(out, true, TextEncoder::E_utf16be, TextEncoder::E_utf8);
+
+    pifstream in;
+    utf16_file.open_read(in);
+    char buffer[65536];
+    while (in.read(buffer, sizeof(buffer)) || in.gcount() != 0) {
+      transcoder.write(buffer, in.gcount());
+    }
+  }
+  double write_time = std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::cout << "utf-8 to utf-16 " << get_rate(text.size(), read_time)
+            << " MB/s, utf-16 to utf-8 " << get_rate(text.size(), write_time)
+            << " MB/s\n";
+
+  {
+    pifstream in;
+    utf8_file.open_read(in);
+    std::string round_trip((std::istreambuf_iterator<char>(in)),
+                           std::istreambuf_iterator<char>());
+    if (round_trip != text) {
+      std::cout << "file round trip failed\n";
+      success = false;
+    }
+  }
+
+  utf8_file.unlink();
+  utf16_file.unlink();
+
+  return success ? 0 : 1;
+}
@@ -16,6 +16,19 @@
 #include "unicodeLatinMap.h"
 #include "config_dtoolutil.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXTENCODER_SSE2
+#endif
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 using std::istream;
 using std::ostream;
 using std::string;
@@ -59,6 +72,606 @@ static char16_t cp437_table[256] = {
 
 TextEncoder::Encoding TextEncoder::_default_encoding = TextEncoder::E_utf8;
 
+/**
+ * Returns the index of the lowest bit that is set in the indicated nonzero
+ * mask.
+ */
+static inline unsigned int
+get_lowest_bit(unsigned int mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return (unsigned int)index;
+#else
+  return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+/**
+ * Returns the number of bytes at the start of the indicated buffer that are
+ * 7-bit ASCII characters.  This checks 16 or 32 bytes at a time where the
+ * processor allows it.
+ */
+static size_t
+count_ascii(const unsigned char *data, size_t size) {
+  size_t i = 0;
+#ifdef __AVX2__
+  for (; i + 32 <= size; i += 32) {
+    __m256i chunk = _mm256_loadu_si256((const __m256i *)(data + i));
+    unsigned int mask = (unsigned int)_mm256_movemask_epi8(chunk);
+    if (mask != 0) {
+      return i + get_lowest_bit(mask);
+    }
+  }
+#endif
+#ifdef TEXTENCODER_SSE2
+  for (; i + 16 <= size; i += 16) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *)(data + i));
+    unsigned int mask = (unsigned int)_mm_movemask_epi8(chunk);
+    if (mask != 0) {
+      return i + get_lowest_bit(mask);
+    }
+  }
+#endif
+  while (i < size && data[i] < 0x80) {
+    ++i;
+  }
+  return i;
+}
+
+#ifdef TEXTENCODER_SSE2
+/**
+ * Stores the eight 16-bit values in the indicated vector as wide characters.
+ */
+static inline void
+store_wide16(wchar_t *out, __m128i units) {
+#if WCHAR_MAX > 0xffff
+  __m128i zero = _mm_setzero_si128();
+  _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi16(units, zero));
+  _mm_storeu_si128((__m128i *)(out + 4), _mm_unpackhi_epi16(units, zero));
+#else
+  _mm_storeu_si128((__m128i *)out, units);
+#endif
+}
+#endif  // TEXTENCODER_SSE2
+
+/**
+ * Copies the indicated number of 7-bit or 8-bit characters into a wide-
+ * character buffer.
+ */
+static inline void
+widen_bytes(wchar_t *out, const unsigned char *data, size_t size) {
+  size_t i = 0;
+#ifdef TEXTENCODER_SSE2
+  __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= size; i += 16) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *)(data + i));
+    store_wide16(out + i, _mm_unpacklo_epi8(chunk, zero));
+    store_wide16(out + i + 8, _mm_unpackhi_epi8(chunk, zero));
+  }
+#endif
+  for (; i < size; ++i) {
+    out[i] = (wchar_t)data[i];
+  }
+}
+
+/**
+ * Returns the number of wide characters at the start of the indicated buffer
+ * that are 7-bit ASCII characters.
+ */
+static size_t
+count_ascii_wide(const wchar_t *data, size_t size) {
+  size_t i = 0;
+#ifdef TEXTENCODER_SSE2
+  const size_t per_vector = 16 / sizeof(wchar_t);
+  for (; i + 2 * per_vector <= size; i += 2 * per_vector) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(data + i));
+    __m128i b = _mm_loadu_si128((const __m128i *)(data + i + per_vector));
+#if WCHAR_MAX > 0xffff
+    __m128i high = _mm_set1_epi32(~0x7f);
+#else
+    __m128i high = _mm_set1_epi16(~0x7f);
+#endif
+    __m128i bits = _mm_and_si128(_mm_or_si128(a, b), high);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(bits, _mm_setzero_si128())) != 0xffff) {
+      break;
+    }
+  }
+#endif
+  while (i < size && (data[i] & ~0x7f) == 0) {
+    ++i;
+  }
+  return i;
+}
+
+/**
+ * Copies the indicated number of 7-bit wide characters into a byte buffer.
+ */
+static inline void
+narrow_ascii(char *out, const wchar_t *data, size_t size) {
+  size_t i = 0;
+#ifdef TEXTENCODER_SSE2
+  for (; i + 16 <= size; i += 16) {
+#if WCHAR_MAX > 0xffff
+    __m128i a = _mm_packs_epi32(_mm_loadu_si128((const __m128i *)(data + i)),
+                                _mm_loadu_si128((const __m128i *)(data + i + 4)));
+    __m128i b = _mm_packs_epi32(_mm_loadu_si128((const __m128i *)(data + i + 8)),
+                                _mm_loadu_si128((const __m128i *)(data + i + 12)));
+#else
+    __m128i a = _mm_loadu_si128((const __m128i *)(data + i));
+    __m128i b = _mm_loadu_si128((const __m128i *)(data + i + 8));
+#endif
+    _mm_storeu_si128((__m128i *)(out + i), _mm_packus_epi16(a, b));
+  }
+#endif
+  for (; i < size; ++i) {
+    out[i] = (char)data[i];
+  }
+}
+
+/**
+ * Reports that the indicated UTF-8 string ends in the middle of a sequence.
+ */
+static void
+report_truncated_utf8(const string &text) {
+  std::ostream *notify_ptr = StringDecoder::get_notify_ptr();
+  if (notify_ptr != nullptr) {
+    (*notify_ptr)
+      << "utf-8 encoded string '" << text << "' ends abruptly.\n";
+  }
+}
+
+/**
+ * Decodes as much of the indicated UTF-8 buffer as fits in the output buffer,
+ * advancing both pointers past what was converted.  Runs of ASCII characters,
+ * which make up most text, are copied 16 or 32 bytes at a time.
+ *
+ * This is lenient in the same way StringUtf8Decoder is: the continuation
+ * bytes are not checked.  Stops at a byte that can't begin a sequence, and at
+ * a sequence that is cut off by the end of the buffer.
+ */
+static TextEncoder::ChunkResult
+decode_utf8_chunk(const unsigned char *&in, const unsigned char *in_end,
+                  wchar_t *&out, wchar_t *out_end) {
+  const unsigned char *p = in;
+  wchar_t *o = out;
+  TextEncoder::ChunkResult result = TextEncoder::CR_done;
+
+  while (p < in_end) {
+    unsigned int lead = *p;
+    if (lead < 0x80) {
+      size_t room = (size_t)(out_end - o);
+      if (room == 0) {
+        result = TextEncoder::CR_output_full;
+        break;
+      }
+      size_t num_ascii = count_ascii(p, std::min((size_t)(in_end - p), room));
+      widen_bytes(o, p, num_ascii);
+      o += num_ascii;
+      p += num_ascii;
+      continue;
+    }
+
+    size_t avail = (size_t)(in_end - p);
+    size_t length;
+    char32_t ch;
+    if ((lead & 0xe0) == 0xc0) {
+      // First byte of two.
+      length = 2;
+      if (avail < length) {
+        result = TextEncoder::CR_incomplete;
+        break;
+      }
+      ch = ((lead & 0x1f) << 6) | (p[1] & 0x3f);
+
+    } else if ((lead & 0xf0) == 0xe0) {
+      // First byte of three.
+      length = 3;
+      if (avail < length) {
+        result = TextEncoder::CR_incomplete;
+        break;
+      }
+      ch = ((lead & 0x0f) << 12) | ((p[1] & 0x3f) << 6) | (p[2] & 0x3f);
+
+    } else if ((lead & 0xf8) == 0xf0) {
+      // First byte of four.
+      length = 4;
+      if (avail < length) {
+        result = TextEncoder::CR_incomplete;
+        break;
+      }
+      ch = ((lead & 0x07) << 18) | ((p[1] & 0x3f) << 12) |
+           ((p[2] & 0x3f) << 6) | (p[3] & 0x3f);
+
+    } else {
+      // The high bit is set but it is not one of the introductory utf-8
+      // bytes.
+      result = TextEncoder::CR_invalid;
+      break;
+    }
+
+#if WCHAR_MAX < 0x10FFFF
+    if (ch > WCHAR_MAX) {
+      // We need to encode this as a surrogate pair.
+      if (out_end - o < 2) {
+        result = TextEncoder::CR_output_full;
+        break;
+      }
+      uint32_t v = (uint32_t)ch - 0x10000u;
+      *o++ = (wchar_t)((v >> 10u) | 0xd800u);
+      *o++ = (wchar_t)((v & 0x3ffu) | 0xdc00u);
+      p += length;
+      continue;
+    }
+#endif
+    if (o == out_end) {
+      result = TextEncoder::CR_output_full;
+      break;
+    }
+    *o++ = (wchar_t)ch;
+    p += length;
+  }
+
+  in = p;
+  out = o;
+  return result;
+}
+
+/**
+ * Decodes as much of the indicated big-endian UTF-16 buffer as fits in the
+ * output buffer, eight characters at a time until a surrogate is encountered.
+ * Stops at an odd byte or a high surrogate at the end of the buffer.
+ */
+static TextEncoder::ChunkResult
+decode_utf16be_chunk(const unsigned char *&in, const unsigned char *in_end,
+                     wchar_t *&out, wchar_t *out_end) {
+  const unsigned char *p = in;
+  wchar_t *o = out;
+  TextEncoder::ChunkResult result = TextEncoder::CR_done;
+
+  while (in_end - p >= 2) {
+#ifdef TEXTENCODER_SSE2
+    size_t num_units = std::min((size_t)(in_end - p) / 2, (size_t)(out_end - o));
+    const unsigned char *block_end = p + (num_units & ~(size_t)7) * 2;
+    __m128i surrogate_mask = _mm_set1_epi16((short)0xf800);
+    __m128i surrogate_bits = _mm_set1_epi16((short)0xd800);
+    while (p < block_end) {
+      __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+      __m128i units = _mm_or_si128(_mm_slli_epi16(chunk, 8), _mm_srli_epi16(chunk, 8));
+      __m128i is_surrogate = _mm_cmpeq_epi16(_mm_and_si128(units, surrogate_mask), surrogate_bits);
+      if (_mm_movemask_epi8(is_surrogate) != 0) {
+        break;
+      }
+      store_wide16(o, units);
+      o += 8;
+      p += 16;
+    }
+    if (in_end - p < 2) {
+      break;
+    }
+#endif
+
+    // Decode the next several characters one at a time; there is a surrogate
+    // among them, or we are near the end of one of the buffers.
+    const unsigned char *slow_end = p + std::min((size_t)(in_end - p) / 2, (size_t)8) * 2;
+    while (p < slow_end) {
+      if (o == out_end) {
+        result = TextEncoder::CR_output_full;
+        break;
+      }
+
+      char32_t ch = ((char32_t)p[0] << 8) | p[1];
+      if (ch >= 0xd800 && ch < 0xdc00) {
+        // This is a high surrogate.  Look for a subsequent low surrogate.
+        if (in_end - p < 4) {
+          result = TextEncoder::CR_incomplete;
+          break;
+        }
+        char32_t ch2 = ((char32_t)p[2] << 8) | p[3];
+        if (ch2 >= 0xdc00 && ch2 < 0xe000) {
+          // Yes, this is a low surrogate.
+#if WCHAR_MAX < 0x10FFFF
+          if (out_end - o < 2) {
+            result = TextEncoder::CR_output_full;
+            break;
+          }
+          *o++ = (wchar_t)ch;
+          *o++ = (wchar_t)ch2;
+#else
+          *o++ = (wchar_t)(0x10000 + ((ch - 0xd800) << 10) + (ch2 - 0xdc00));
+#endif
+          p += 4;
+          continue;
+        }
+      }
+
+      // No, this is just a regular character, or an unpaired surrogate.
+      *o++ = (wchar_t)ch;
+      p += 2;
+    }
+    if (result != TextEncoder::CR_done) {
+      break;
+    }
+  }
+
+  if (result == TextEncoder::CR_done && p < in_end) {
+    // There is an odd byte left over.
+    result = TextEncoder::CR_incomplete;
+  }
+
+  in = p;
+  out = o;
+  return result;
+}
+
+/**
+ * Reads the next character from the indicated wide-character buffer, which
+ * may be a surrogate pair if wchar_t is 16 bits.  Returns the number of
+ * wchar_t units it takes up, or 0 if the buffer ends in a high surrogate.
+ */
+static inline size_t
+read_wchar(const wchar_t *p, const wchar_t *end, char32_t &ch) {
+  ch = (char32_t)p[0];
+
+  // On some systems, wstring may be UTF-16, and contain surrogate pairs.
+#if WCHAR_MAX < 0x10FFFF
+  if (ch >= 0xd800 && ch < 0xdc00) {
+    // This is a high surrogate.  Look for a subsequent low surrogate.
+    if (p + 1 >= end) {
+      return 0;
+    }
+    char32_t ch2 = (char32_t)p[1];
+    if (ch2 >= 0xdc00 && ch2 < 0xe000) {
+      // Yes, this is a low surrogate.
+      ch = 0x10000 + ((ch - 0xd800) << 10) + (ch2 - 0xdc00);
+      return 2;
+    }
+  }
+#endif
+  return 1;
+}
+
+/**
+ * Stores the indicated character as UTF-8, and returns the number of bytes
+ * written, which is at most four.
+ */
+static inline size_t
+store_utf8(char *out, char32_t ch) {
+  if ((ch & ~0x7f) == 0) {
+    out[0] = (char)ch;
+    return 1;
+  } else if ((ch & ~0x7ff) == 0) {
+    out[0] = (char)((ch >> 6) | 0xc0);
+    out[1] = (char)((ch & 0x3f) | 0x80);
+    return 2;
+  } else if ((ch & ~0xffff) == 0) {
+    out[0] = (char)((ch >> 12) | 0xe0);
+    out[1] = (char)(((ch >> 6) & 0x3f) | 0x80);
+    out[2] = (char)((ch & 0x3f) | 0x80);
+    return 3;
+  } else {
+    out[0] = (char)((ch >> 18) | 0xf0);
+    out[1] = (char)(((ch >> 12) & 0x3f) | 0x80);
+    out[2] = (char)(((ch >> 6) & 0x3f) | 0x80);
+    out[3] = (char)((ch & 0x3f) | 0x80);
+    return 4;
+  }
+}
+
+/**
+ * Stores the indicated wide character as big-endian UTF-16, and returns the
+ * number of bytes written, which is at most four.
+ */
+static inline size_t
+store_utf16be(char *out, char32_t ch) {
+  // On some systems, wstring may be UTF-16, and contain surrogate pairs,
+  // which we can copy as they are.
+#if WCHAR_MAX >= 0x10FFFF
+  if ((ch & ~0xffff) != 0) {
+    // Use a surrogate pair.
+    uint32_t v = (uint32_t)ch - 0x10000u;
+    uint16_t hi = (v >> 10u) | 0xd800u;
+    uint16_t lo = (v & 0x3ffu) | 0xdc00u;
+    out[0] = (char)(hi >> 8);
+    out[1] = (char)(hi & 0xff);
+    out[2] = (char)(lo >> 8);
+    out[3] = (char)(lo & 0xff);
+    return 4;
+  }
+#endif
+
+  // Note that this passes through surrogates and BOMs unharmed.
+  out[0] = (char)(ch >> 8);
+  out[1] = (char)(ch & 0xff);
+  return 2;
+}
+
+/**
+ * Encodes as much of the indicated wide-character buffer as UTF-8 as fits in
+ * the output buffer, copying runs of ASCII characters 16 at a time.  Stops at
+ * a high surrogate at the end of the buffer, if wchar_t is 16 bits.
+ */
+static TextEncoder::ChunkResult
+encode_utf8_chunk(const wchar_t *&in, const wchar_t *in_end,
+                  char *&out, char *out_end) {
+  const wchar_t *p = in;
+  char *o = out;
+  TextEncoder::ChunkResult result = TextEncoder::CR_done;
+
+  while (p < in_end) {
+    // No character takes more than four bytes, so we only need to check for
+    // room before each character once the output buffer is nearly full.
+    size_t num_safe = std::min((size_t)(in_end - p), (size_t)(out_end - o) / 4);
+    if (num_safe == 0) {
+      char32_t ch;
+      size_t length = read_wchar(p, in_end, ch);
+      if (length == 0) {
+        result = TextEncoder::CR_incomplete;
+        break;
+      }
+      char encoded[4];
+      size_t num_bytes = store_utf8(encoded, ch);
+      if (num_bytes > (size_t)(out_end - o)) {
+        result = TextEncoder::CR_output_full;
+        break;
+      }
+      memcpy(o, encoded, num_bytes);
+      o += num_bytes;
+      p += length;
+      continue;
+    }
+
+    const wchar_t *safe_end = p + num_safe;
+    while (p < safe_end) {
+      size_t num_ascii = count_ascii_wide(p, safe_end - p);
+      narrow_ascii(o, p, num_ascii);
+      o += num_ascii;
+      p += num_ascii;
+      if (p >= safe_end) {
+        break;
+      }
+
+      char32_t ch;
+      size_t length = read_wchar(p, in_end, ch);
+      if (length == 0) {
+        result = TextEncoder::CR_incomplete;
+        break;
+      }
+      o += store_utf8(o, ch);
+      p += length;
+    }
+    if (result != TextEncoder::CR_done) {
+      break;
+    }
+  }
+
+  in = p;
+  out = o;
+  return result;
+}
+
+/**
+ * Encodes as much of the indicated wide-character buffer as big-endian
+ * UTF-16 as fits in the output buffer, eight characters at a time until one
+ * is encountered that needs a surrogate pair.
+ */
+static TextEncoder::ChunkResult
+encode_utf16be_chunk(const wchar_t *&in, const wchar_t *in_end,
+                     char *&out, char *out_end) {
+  const wchar_t *p = in;
+  char *o = out;
+  TextEncoder::ChunkResult result = TextEncoder::CR_done;
+
+  while (p < in_end) {
+    // As in encode_utf8_chunk(), we only need to check for room before each
+    // character once the output buffer is nearly full.
+    size_t num_safe = std::min((size_t)(in_end - p), (size_t)(out_end - o) / 4);
+    if (num_safe == 0) {
+      char encoded[4];
+      size_t num_bytes = store_utf16be(encoded, (char32_t)*p);
+      if (num_bytes > (size_t)(out_end - o)) {
+        result = TextEncoder::CR_output_full;
+        break;
+      }
+      memcpy(o, encoded, num_bytes);
+      o += num_bytes;
+      ++p;
+      continue;
+    }
+
+    const wchar_t *safe_end = p + num_safe;
+    while (p < safe_end) {
+#ifdef TEXTENCODER_SSE2
+      const wchar_t *block_end = p + ((size_t)(safe_end - p) & ~(size_t)7);
+      while (p < block_end) {
+#if WCHAR_MAX > 0xffff
+        __m128i a = _mm_loadu_si128((const __m128i *)p);
+        __m128i b = _mm_loadu_si128((const __m128i *)(p + 4));
+        __m128i high = _mm_srli_epi32(_mm_or_si128(a, b), 16);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) != 0xffff) {
+          break;
+        }
+        // Sign-extend the low halves, so that they pack without saturating.
+        a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+        b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+        __m128i units = _mm_packs_epi32(a, b);
+#else
+        __m128i units = _mm_loadu_si128((const __m128i *)p);
+#endif
+        units = _mm_or_si128(_mm_slli_epi16(units, 8), _mm_srli_epi16(units, 8));
+        _mm_storeu_si128((__m128i *)o, units);
+        p += 8;
+        o += 16;
+      }
+#endif
+
+      // Encode the next several characters one at a time; one of them needs
+      // a surrogate pair, or we are near the end of the buffer.
+      const wchar_t *slow_end = p + std::min((size_t)(safe_end - p), (size_t)8);
+      while (p < slow_end) {
+        o += store_utf16be(o, (char32_t)*p);
+        ++p;
+      }
+    }
+  }
+
+  in = p;
+  out = o;
+  return result;
+}
+
+/**
+ * Encodes as much of the indicated wide-character buffer as fits in the
+ * output buffer, in one of the single-byte encodings.  Characters that the
+ * encoding doesn't have are handled as by encode_wchar().
+ */
+static TextEncoder::ChunkResult
+encode_8bit_chunk(const wchar_t *&in, const wchar_t *in_end,
+                  char *&out, char *out_end, TextEncoder::Encoding encoding) {
+  const wchar_t *p = in;
+  char *o = out;
+  TextEncoder::ChunkResult result = TextEncoder::CR_done;
+
+  while (p < in_end) {
+    size_t num_ascii = count_ascii_wide(p, std::min((size_t)(in_end - p), (size_t)(out_end - o)));
+    narrow_ascii(o, p, num_ascii);
+    o += num_ascii;
+    p += num_ascii;
+    if (p >= in_end) {
+      break;
+    }
+    if (o == out_end) {
+      result = TextEncoder::CR_output_full;
+      break;
+    }
+
+    char32_t ch = (char32_t)*p;
+    if (encoding == TextEncoder::E_iso8859 && (ch & ~0xff) == 0) {
+      *o++ = (char)ch;
+      ++p;
+      continue;
+    }
+
+    size_t length = read_wchar(p, in_end, ch);
+    if (length == 0) {
+      result = TextEncoder::CR_incomplete;
+      break;
+    }
+    string encoded = TextEncoder::encode_wchar(ch, encoding);
+    if (encoded.size() > (size_t)(out_end - o)) {
+      result = TextEncoder::CR_output_full;
+      break;
+    }
+    memcpy(o, encoded.data(), encoded.size());
+    o += encoded.size();
+    p += length;
+  }
+
+  in = p;
+  out = o;
+  return result;
+}
+
 /**
  * Adjusts the text stored within the encoder to all uppercase letters
  * (preserving accent marks correctly).
@@ -238,29 +851,40 @@ encode_wchar(char32_t ch, TextEncoder::Encoding encoding) {
  */
 string TextEncoder::
 encode_wtext(const wstring &wtext, TextEncoder::Encoding encoding) {
-  string result;
+  // Every character takes at least one byte, or two in UTF-16; the buffer is
+  // grown whenever a longer character doesn't fit.
+  size_t unit_size = (encoding == E_utf16be) ? 2 : 1;
+  string result(wtext.size() * unit_size, '\0');
+  if (wtext.empty()) {
+    return result;
+  }
 
-  for (size_t i = 0; i < wtext.size(); ++i) {
-    wchar_t ch = wtext[i];
+  const wchar_t *in = wtext.data();
+  const wchar_t *in_end = in + wtext.size();
+  size_t pos = 0;
 
-    // On some systems, wstring may be UTF-16, and contain surrogate pairs.
-#if WCHAR_MAX < 0x10FFFF
-    if (ch >= 0xd800 && ch < 0xdc00 && (i + 1) < wtext.size()) {
-      // This is a high surrogate.  Look for a subsequent low surrogate.
-      wchar_t ch2 = wtext[i + 1];
-      if (ch2 >= 0xdc00 && ch2 < 0xe000) {
-        // Yes, this is a low surrogate.
-        char32_t code_point = 0x10000 + ((ch - 0xd800) << 10) + (ch2 - 0xdc00);
-        result += encode_wchar(code_point, encoding);
-        i++;
-        continue;
-      }
-    }
-#endif
+  while (in < in_end) {
+    char *begin = &result[0];
+    char *out = begin + pos;
+    ChunkResult cr = encode_chunk(in, in_end, out, begin + result.size(), encoding);
+    pos = out - begin;
+
+    if (cr == CR_output_full) {
+      size_t needed = pos + 4 + (in_end - in) * unit_size;
+      result.resize(std::max(needed, result.size() + result.size() / 2));
 
-    result += encode_wchar(ch, encoding);
+    } else if (cr == CR_incomplete) {
+      // The string ends in a high surrogate with no low surrogate after it.
+      // Encode it by itself.
+      string encoded = encode_wchar((char32_t)*in, encoding);
+      result.resize(pos);
+      result += encoded;
+      pos = result.size();
+      ++in;
+    }
   }
 
+  result.resize(pos);
   return result;
 }
 
@@ -270,66 +894,199 @@ encode_wtext(const wstring &wtext, TextEncoder::Encoding encoding) {
  */
 wstring TextEncoder::
 decode_text(const string &text, TextEncoder::Encoding encoding) {
+  // The result can't have more wide characters than there are bytes, or
+  // 16-bit units in UTF-16.
+  size_t max_chars = (encoding == E_utf16be) ? text.size() / 2 : text.size();
+  wstring result(max_chars, 0);
+  if (text.empty()) {
+    return result;
+  }
+
+  const char *in = text.data();
+  const char *in_end = in + text.size();
+  wchar_t *begin = &result[0];
+  wchar_t *out = begin;
+
+  while (in < in_end) {
+    ChunkResult cr = decode_chunk(in, in_end, out, begin + max_chars, encoding);
+    if (cr == CR_invalid) {
+      // The high bit is set but it is not one of the introductory utf-8
+      // bytes.
+      std::ostream *notify_ptr = StringDecoder::get_notify_ptr();
+      if (notify_ptr != nullptr) {
+        (*notify_ptr)
+          << "Non utf-8 byte in string: 0x" << std::hex
+          << (unsigned int)(unsigned char)*in << std::dec
+          << " at offset " << (in - text.data())
+          << ", string is '" << text << "'\n";
+      }
+      *out++ = 0xfffd;
+      ++in;
+
+    } else if (cr == CR_incomplete) {
+      if (encoding == E_utf8) {
+        report_truncated_utf8(text);
+        break;
+      }
+
+      // A UTF-16 string that ends in an unpaired high surrogate keeps it.
+      if (in_end - in >= 2) {
+        *out++ = (wchar_t)(((unsigned char)in[0] << 8) | (unsigned char)in[1]);
+        in += 2;
+      }
+      if (in < in_end) {
+        std::ostream *notify_ptr = StringDecoder::get_notify_ptr();
+        if (notify_ptr != nullptr) {
+          (*notify_ptr)
+            << "Unicode-encoded string has odd number of bytes.\n";
+        }
+        break;
+      }
+
+    } else {
+      // There is always enough room.
+      assert(cr == CR_done);
+      break;
+    }
+  }
+
+  result.resize(out - begin);
+  return result;
+}
+
+/**
+ * Returns the number of bytes at the start of the indicated buffer that form
+ * well-formed UTF-8, which is the offset of the first byte of the first
+ * invalid or incomplete sequence, or size if the whole buffer is valid.
+ */
+size_t TextEncoder::
+find_invalid_utf8(const char *data, size_t size) {
+  const unsigned char *bytes = (const unsigned char *)data;
+  size_t p = 0;
+
+  while (p < size) {
+    p += count_ascii(bytes + p, size - p);
+    if (p >= size) {
+      break;
+    }
+
+    // The range of the second byte is restricted for some lead bytes, to rule
+    // out overlong encodings, surrogates and values beyond U+10FFFF.
+    unsigned int lead = bytes[p];
+    size_t length;
+    unsigned int low = 0x80;
+    unsigned int high = 0xbf;
+    if (lead >= 0xc2 && lead <= 0xdf) {
+      length = 2;
+    } else if (lead >= 0xe0 && lead <= 0xef) {
+      length = 3;
+      if (lead == 0xe0) {
+        low = 0xa0;
+      } else if (lead == 0xed) {
+        high = 0x9f;
+      }
+    } else if (lead >= 0xf0 && lead <= 0xf4) {
+      length = 4;
+      if (lead == 0xf0) {
+        low = 0x90;
+      } else if (lead == 0xf4) {
+        high = 0x8f;
+      }
+    } else {
+      return p;
+    }
+
+    if (size - p < length || bytes[p + 1] < low || bytes[p + 1] > high) {
+      return p;
+    }
+    for (size_t i = 2; i < length; ++i) {
+      if ((bytes[p + i] & 0xc0) != 0x80) {
+        return p;
+      }
+    }
+    p += length;
+  }
+
+  return size;
+}
+
+/**
+ * Decodes as much of the indicated buffer as fits in the output buffer, and
+ * advances both pointers past the data that was converted.  This is the
+ * building block of decode_text() and IncrementalTextDecoder.
+ *
+ * Returns CR_done if the whole buffer was decoded.  Otherwise, the return
+ * value indicates why decoding stopped where it did: the output buffer is
+ * full, the buffer ends partway through a character, or (in UTF-8) the next
+ * byte can't begin a character.
+ */
+TextEncoder::ChunkResult TextEncoder::
+decode_chunk(const char *&in, const char *in_end,
+             wchar_t *&out, wchar_t *out_end, TextEncoder::Encoding encoding) {
+  const unsigned char *bytes = (const unsigned char *)in;
+  const unsigned char *bytes_end = (const unsigned char *)in_end;
+  ChunkResult result;
+
   switch (encoding) {
   case E_utf8:
-    {
-      StringUtf8Decoder decoder(text);
-      return decode_text_impl(decoder);
-    }
+    result = decode_utf8_chunk(bytes, bytes_end, out, out_end);
+    break;
 
   case E_utf16be:
-    {
-      StringUtf16Decoder decoder(text);
-      return decode_text_impl(decoder);
-    }
+    result = decode_utf16be_chunk(bytes, bytes_end, out, out_end);
+    break;
 
   case E_cp437:
     {
-      std::wstring result(text.size(), 0);
-      for (size_t i = 0; i < result.size(); ++i) {
-        result[i] = cp437_table[(uint8_t)text[i]];
+      size_t count = std::min((size_t)(bytes_end - bytes), (size_t)(out_end - out));
+      for (size_t i = 0; i < count; ++i) {
+        out[i] = cp437_table[bytes[i]];
       }
-      return result;
+      bytes += count;
+      out += count;
+      result = (bytes == bytes_end) ? CR_done : CR_output_full;
     }
+    break;
 
   case E_iso8859:
   default:
     {
-      StringDecoder decoder(text);
-      return decode_text_impl(decoder);
+      size_t count = std::min((size_t)(bytes_end - bytes), (size_t)(out_end - out));
+      widen_bytes(out, bytes, count);
+      bytes += count;
+      out += count;
+      result = (bytes == bytes_end) ? CR_done : CR_output_full;
     }
-  };
+    break;
+  }
+
+  in = (const char *)bytes;
+  return result;
 }
 
 /**
- * Decodes the eight-bit stream from the indicated decoder, returning the
- * decoded wide-char string.
+ * Encodes as much of the indicated wide-character buffer as fits in the output
+ * buffer, and advances both pointers past the data that was converted.  This
+ * is the building block of encode_wtext() and IncrementalTextEncoder.
+ *
+ * Returns CR_done if the whole buffer was encoded.  Otherwise, the return
+ * value indicates why encoding stopped where it did: the output buffer is too
+ * full for the next character, or the buffer ends in a high surrogate, which
+ * may be paired with a low surrogate at the start of the next buffer.
  */
-wstring TextEncoder::
-decode_text_impl(StringDecoder &decoder) {
-  wstring result;
-  // bool expand_amp = get_expand_amp();
+TextEncoder::ChunkResult TextEncoder::
+encode_chunk(const wchar_t *&in, const wchar_t *in_end,
+             char *&out, char *out_end, TextEncoder::Encoding encoding) {
+  switch (encoding) {
+  case E_utf8:
+    return encode_utf8_chunk(in, in_end, out, out_end);
 
-  char32_t character = decoder.get_next_character();
-  while (!decoder.is_eof()) {
-    /*
-    if (character == '&' && expand_amp) {
-      // An ampersand in expand_amp mode is treated as an escape character.
-      character = expand_amp_sequence(decoder);
-    }
-    */
-    if (character <= WCHAR_MAX) {
-      result += character;
-    } else {
-      // We need to encode this as a surrogate pair.
-      uint32_t v = (uint32_t)character - 0x10000u;
-      result += (wchar_t)((v >> 10u) | 0xd800u);
-      result += (wchar_t)((v & 0x3ffu) | 0xdc00u);
-    }
-    character = decoder.get_next_character();
-  }
+  case E_utf16be:
+    return encode_utf16be_chunk(in, in_end, out, out_end);
 
-  return result;
+  default:
+    return encode_8bit_chunk(in, in_end, out, out_end, encoding);
+  }
 }
 
 /**
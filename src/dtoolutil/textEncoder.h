@@ -122,8 +122,26 @@ PUBLISHED:
   static std::wstring decode_text(const std::string &text, Encoding encoding);
 #endif
 
+  INLINE static bool is_valid_utf8(const std::string &text);
+
   MAKE_PROPERTY(text, get_text, set_text);
 
+public:
+  static size_t find_invalid_utf8(const char *data, size_t size);
+
+  enum ChunkResult {
+    CR_done,
+    CR_output_full,
+    CR_incomplete,
+    CR_invalid,
+  };
+  static ChunkResult decode_chunk(const char *&in, const char *in_end,
+                                  wchar_t *&out, wchar_t *out_end,
+                                  Encoding encoding);
+  static ChunkResult encode_chunk(const wchar_t *&in, const wchar_t *in_end,
+                                  char *&out, char *out_end,
+                                  Encoding encoding);
+
 protected:
   virtual void text_changed();
 
@@ -132,7 +150,6 @@ private:
     F_got_text         =  0x0001,
     F_got_wtext        =  0x0002,
   };
-  static std::wstring decode_text_impl(StringDecoder &decoder);
 
   int _flags;
   Encoding _encoding;
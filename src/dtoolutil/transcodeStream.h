@@ -0,0 +1,74 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file transcodeStream.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef TRANSCODESTREAM_H
+#define TRANSCODESTREAM_H
+
+#include "dtoolbase.h"
+#include "transcodeStreamBuf.h"
+
+/**
+ * An input stream object that reads text from another stream in one encoding
+ * and delivers it in another, a block at a time, so that a file of any size
+ * may be converted in a fixed amount of memory.
+ *
+ * Seeking is not supported.
+ */
+class EXPCL_DTOOL_DTOOLUTIL ITranscodeStream : public std::istream {
+public:
+  INLINE ITranscodeStream();
+  INLINE explicit ITranscodeStream(std::istream *source, bool owns_source,
+                                   TextEncoder::Encoding from,
+                                   TextEncoder::Encoding to);
+  INLINE ~ITranscodeStream();
+
+  INLINE ITranscodeStream &open(std::istream *source, bool owns_source,
+                                TextEncoder::Encoding from,
+                                TextEncoder::Encoding to);
+  INLINE ITranscodeStream &close();
+
+private:
+  TranscodeStreamBuf _buf;
+  std::istream *_source;
+  bool _owns_source;
+};
+
+/**
+ * An output stream object that accepts text in one encoding and writes it to
+ * another stream in another encoding, a block at a time.  The last of the
+ * text is not written until the stream is closed.
+ *
+ * Seeking is not supported.
+ */
+class EXPCL_DTOOL_DTOOLUTIL OTranscodeStream : public std::ostream {
+public:
+  INLINE OTranscodeStream();
+  INLINE explicit OTranscodeStream(std::ostream *dest, bool owns_dest,
+                                   TextEncoder::Encoding from,
+                                   TextEncoder::Encoding to);
+  INLINE ~OTranscodeStream();
+
+  INLINE OTranscodeStream &open(std::ostream *dest, bool owns_dest,
+                                TextEncoder::Encoding from,
+                                TextEncoder::Encoding to);
+  INLINE OTranscodeStream &close();
+
+private:
+  TranscodeStreamBuf _buf;
+  std::ostream *_dest;
+  bool _owns_dest;
+};
+
+#include "transcodeStream.I"
+
+#endif
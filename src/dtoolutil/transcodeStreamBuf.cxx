@@ -0,0 +1,276 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file transcodeStreamBuf.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "transcodeStreamBuf.h"
+#include "memoryHook.h"
+
+using std::streamoff;
+using std::streamsize;
+
+static const size_t transcode_buffer_size = 4096;
+
+/**
+ *
+ */
+TranscodeStreamBuf::
+TranscodeStreamBuf() {
+  _source = nullptr;
+  _dest = nullptr;
+  _source_eof = false;
+
+  _buffer = (char *)PANDA_MALLOC_ARRAY(transcode_buffer_size);
+  _raw_buffer = (char *)PANDA_MALLOC_ARRAY(transcode_buffer_size);
+  _raw_start = 0;
+  _raw_end = 0;
+  _wide_buffer = (wchar_t *)PANDA_MALLOC_ARRAY(transcode_buffer_size * sizeof(wchar_t));
+  _wide_start = 0;
+  _wide_end = 0;
+}
+
+/**
+ *
+ */
+TranscodeStreamBuf::
+~TranscodeStreamBuf() {
+  close_read();
+  close_write();
+
+  PANDA_FREE_ARRAY(_buffer);
+  PANDA_FREE_ARRAY(_raw_buffer);
+  PANDA_FREE_ARRAY(_wide_buffer);
+}
+
+/**
+ * Prepares to read text in the "from" encoding from the indicated source,
+ * which will be delivered in the "to" encoding.  The source is not owned by
+ * the TranscodeStreamBuf, and must remain valid until close_read().
+ */
+void TranscodeStreamBuf::
+open_read(std::streambuf *source, TextEncoder::Encoding from,
+          TextEncoder::Encoding to) {
+  close_read();
+  close_write();
+
+  _source = source;
+  _source_eof = false;
+  _decoder.set_encoding(from);
+  _encoder.set_encoding(to);
+  _raw_start = 0;
+  _raw_end = 0;
+  _wide_start = 0;
+  _wide_end = 0;
+
+  char *ebuf = _buffer + transcode_buffer_size;
+  setg(_buffer, ebuf, ebuf);
+}
+
+/**
+ * Stops reading from the source, discarding any text that has been read from
+ * it but not yet extracted.
+ */
+void TranscodeStreamBuf::
+close_read() {
+  if (_source != nullptr) {
+    _source = nullptr;
+    setg(nullptr, nullptr, nullptr);
+  }
+}
+
+/**
+ * Prepares to accept text in the "from" encoding, which will be written to
+ * the indicated destination in the "to" encoding.  The destination is not
+ * owned by the TranscodeStreamBuf, and must remain valid until close_write().
+ */
+void TranscodeStreamBuf::
+open_write(std::streambuf *dest, TextEncoder::Encoding from,
+           TextEncoder::Encoding to) {
+  close_read();
+  close_write();
+
+  _dest = dest;
+  _decoder.set_encoding(from);
+  _encoder.set_encoding(to);
+
+  setp(_buffer, _buffer + transcode_buffer_size);
+}
+
+/**
+ * Writes out whatever text remains, and stops writing to the destination.  If
+ * the text ended partway through a character, this is reported now.
+ */
+void TranscodeStreamBuf::
+close_write() {
+  if (_dest != nullptr) {
+    size_t n = pptr() - pbase();
+    write_chars(pbase(), n, true);
+    _dest->pubsync();
+
+    _dest = nullptr;
+    setp(nullptr, nullptr);
+  }
+}
+
+/**
+ * Called by the system ostream implementation when its internal buffer is
+ * filled, plus one character.
+ */
+int TranscodeStreamBuf::
+overflow(int ch) {
+  if (_dest == nullptr) {
+    return EOF;
+  }
+
+  bool okflag = true;
+
+  size_t n = pptr() - pbase();
+  if (n != 0) {
+    // Any partial character at the end of the buffer is kept by the decoder,
+    // so the whole buffer is always consumed.
+    okflag = write_chars(pbase(), n, false);
+    pbump(-(streamoff)n);
+  }
+
+  if (okflag && ch != EOF) {
+    // Store the extra character back in the buffer.
+    *(pptr()) = ch;
+    pbump(1);
+  }
+
+  if (!okflag) {
+    return EOF;
+  }
+  return 0;
+}
+
+/**
+ * Called by the system iostream implementation to implement a flush
+ * operation.
+ */
+int TranscodeStreamBuf::
+sync() {
+  if (_dest == nullptr) {
+    return 0;
+  }
+
+  size_t n = pptr() - pbase();
+  bool okflag = write_chars(pbase(), n, false);
+  pbump(-(streamoff)n);
+
+  if (!okflag || _dest->pubsync() == -1) {
+    return EOF;
+  }
+  return 0;
+}
+
+/**
+ * Called by the system istream implementation when its internal buffer needs
+ * more characters.
+ */
+int TranscodeStreamBuf::
+underflow() {
+  if (_source == nullptr) {
+    return EOF;
+  }
+
+  // Sometimes underflow() is called even if the buffer is not empty.
+  if (gptr() >= egptr()) {
+    size_t read_count = read_chars(_buffer, transcode_buffer_size);
+    if (read_count == 0) {
+      return EOF;
+    }
+    setg(_buffer, _buffer, _buffer + read_count);
+  }
+
+  return (unsigned char)*gptr();
+}
+
+/**
+ * Fills the indicated buffer with transcoded text, reading more from the
+ * source as needed.  Returns the number of bytes written, which is 0 only at
+ * the end of the source.
+ */
+size_t TranscodeStreamBuf::
+read_chars(char *start, size_t length) {
+  char *out = start;
+  char *out_end = start + length;
+
+  while (out == start) {
+    if (_wide_start == _wide_end) {
+      // Decode some more characters, reading more from the source first if
+      // we have decoded everything we read.
+      if (_raw_start == _raw_end && !_source_eof) {
+        streamsize count = _source->sgetn(_raw_buffer, transcode_buffer_size);
+        _raw_start = 0;
+        _raw_end = (count > 0) ? (size_t)count : 0;
+        _source_eof = (_raw_end == 0);
+      }
+
+      const char *in = _raw_buffer + _raw_start;
+      wchar_t *wide_out = _wide_buffer;
+      _decoder.decode(in, _raw_buffer + _raw_end,
+                      wide_out, _wide_buffer + transcode_buffer_size,
+                      _source_eof);
+      _raw_start = in - _raw_buffer;
+      _wide_start = 0;
+      _wide_end = wide_out - _wide_buffer;
+    }
+
+    // Once the source is exhausted and everything read from it has been
+    // decoded, the encoder has seen the last of the text.
+    bool at_end = _source_eof && _raw_start == _raw_end && !_decoder.has_pending();
+
+    const wchar_t *wide_in = _wide_buffer + _wide_start;
+    _encoder.encode(wide_in, _wide_buffer + _wide_end, out, out_end, at_end);
+    _wide_start = wide_in - _wide_buffer;
+
+    if (at_end && _wide_start == _wide_end) {
+      break;
+    }
+  }
+
+  return out - start;
+}
+
+/**
+ * Transcodes the indicated text and writes it to the destination.  Set flush
+ * to true if this is the end of the text.  Returns true on success, false if
+ * the destination didn't accept all of it.
+ */
+bool TranscodeStreamBuf::
+write_chars(const char *start, size_t length, bool flush) {
+  const char *in = start;
+  const char *in_end = start + length;
+
+  bool all_decoded;
+  do {
+    wchar_t *wide_end = _wide_buffer;
+    all_decoded = _decoder.decode(in, in_end, wide_end,
+                                  _wide_buffer + transcode_buffer_size, flush);
+
+    const wchar_t *wide_in = _wide_buffer;
+    bool all_encoded;
+    do {
+      char *out = _raw_buffer;
+      all_encoded = _encoder.encode(wide_in, wide_end,
+                                    out, _raw_buffer + transcode_buffer_size,
+                                    flush && all_decoded);
+
+      streamsize count = out - _raw_buffer;
+      if (count != 0 && _dest->sputn(_raw_buffer, count) != count) {
+        return false;
+      }
+    } while (!all_encoded);
+  } while (!all_decoded);
+
+  return true;
+}
@@ -0,0 +1,77 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file transcodeStreamBuf.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef TRANSCODESTREAMBUF_H
+#define TRANSCODESTREAMBUF_H
+
+#include "dtoolbase.h"
+#include "textEncoder.h"
+#include "incrementalTextDecoder.h"
+#include "incrementalTextEncoder.h"
+
+/**
+ * The streambuf object that implements ITranscodeStream and OTranscodeStream.
+ * It sits on top of another streambuf, such as a PandaFileStreamBuf, and
+ * converts text from one encoding to another as it passes through, a block
+ * at a time.
+ *
+ * It may be opened either for reading or for writing, but not both at once.
+ * Seeking is not supported.
+ */
+class EXPCL_DTOOL_DTOOLUTIL TranscodeStreamBuf : public std::streambuf {
+public:
+  TranscodeStreamBuf();
+  virtual ~TranscodeStreamBuf();
+
+  void open_read(std::streambuf *source, TextEncoder::Encoding from,
+                 TextEncoder::Encoding to);
+  void close_read();
+
+  void open_write(std::streambuf *dest, TextEncoder::Encoding from,
+                  TextEncoder::Encoding to);
+  void close_write();
+
+protected:
+  virtual int overflow(int c);
+  virtual int sync();
+  virtual int underflow();
+
+private:
+  size_t read_chars(char *start, size_t length);
+  bool write_chars(const char *start, size_t length, bool flush);
+
+private:
+  std::streambuf *_source;
+  std::streambuf *_dest;
+  bool _source_eof;
+
+  IncrementalTextDecoder _decoder;
+  IncrementalTextEncoder _encoder;
+
+  // The get area or the put area, depending on the direction.
+  char *_buffer;
+
+  // Text in the source encoding that has been read but not yet decoded, when
+  // reading, or text in the target encoding waiting to be written, when
+  // writing.
+  char *_raw_buffer;
+  size_t _raw_start;
+  size_t _raw_end;
+
+  // Characters that have been decoded but not yet encoded.
+  wchar_t *_wide_buffer;
+  size_t _wide_start;
+  size_t _wide_end;
+};
+
+#endif
@@ -30,6 +30,7 @@
      parameterRemapToString.h \
      parameterRemapHandleToInt.h \
      parameterRemapUnchanged.h  \
+     parseCache.h \
      typeManager.h \
      interrogate_preamble_python_native.cxx // generated below
 
@@ -56,6 +57,7 @@
      parameterRemapToString.cxx \
      parameterRemapHandleToInt.cxx \
      parameterRemapUnchanged.cxx  \
+     parseCache.cxx \
      typeManager.cxx
 
 #end bin_target
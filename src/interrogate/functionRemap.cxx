@@ -997,6 +997,61 @@ setup_properties(const InterrogateFunction &ifunc, InterfaceMaker *interface_mak
     break;
   }
 
+  if (!_blocking && check_blocking_policy()) {
+    // The user asked for the whole class, file or library to release the
+    // interpreter lock, and this function looks safe to call without it.
+    _blocking = true;
+  }
+
+  return true;
+}
+
+/**
+ * Returns true if this function is covered by one of the blockingtype,
+ * blockingfile or blockingall commands, and not excluded by a nonblocking
+ * command.  Functions that work with Python objects directly are never
+ * covered, since they cannot run while the interpreter lock is released.
+ */
+bool FunctionRemap::
+check_blocking_policy() const {
+  if (!builder._blockingall &&
+      !builder.in_blockingfile(_cppfunc->_file._filename_as_referenced) &&
+      (_cpptype == nullptr ||
+       !builder.in_blockingtype(_cpptype->get_local_name(&parser)))) {
+    return false;
+  }
+
+  string fname = _cppfunc->get_simple_name();
+  if (builder.in_nonblocking(fname) ||
+      builder.in_nonblocking(_cppfunc->get_local_name(&parser))) {
+    return false;
+  }
+
+  // Python special methods and synthesized property accessors are either
+  // trivial or expect to be able to use the Python API.
+  if (_extension || fname.compare(0, 2, "__") == 0 ||
+      _type == T_getter || _type == T_setter || _type == T_destructor ||
+      (_flags & (F_explicit_self | F_explicit_args)) != 0) {
+    return false;
+  }
+
+  CPPType *return_type = _return_type->get_orig_type();
+  if (TypeManager::is_pointer_to_PyObject(return_type) ||
+      TypeManager::is_pointer_to_PyTypeObject(return_type)) {
+    return false;
+  }
+
+  for (const Parameter &param : _parameters) {
+    CPPType *type = param._remap->get_orig_type();
+    if (TypeManager::is_pointer_to_PyObject(type) ||
+        TypeManager::is_pointer_to_PyTypeObject(type) ||
+        TypeManager::is_pointer_to_PyStringObject(type) ||
+        TypeManager::is_pointer_to_PyUnicodeObject(type) ||
+        TypeManager::is_pointer_to_Py_buffer(type)) {
+      return false;
+    }
+  }
+
   return true;
 }
 
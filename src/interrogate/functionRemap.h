@@ -140,6 +140,7 @@ public:
 private:
   std::string get_parameter_expr(size_t n, const vector_string &pexprs) const;
   bool setup_properties(const InterrogateFunction &ifunc, InterfaceMaker *interface_maker);
+  bool check_blocking_policy() const;
 };
 
 std::string make_safe_name(const std::string & name);
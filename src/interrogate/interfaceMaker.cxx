@@ -293,6 +293,17 @@ write_prototypes(ostream &out,ostream *out_h) {
   _function_writers.write_prototypes(out);
 }
 
+/**
+ * Generates the prototypes that are needed by the functions written to the
+ * chunks by write_function_chunks(), at the top of each additional output
+ * file when the code is split over several files.  Since the default
+ * implementation of write_function_chunks() writes everything to the first
+ * file, there is nothing to write here.
+ */
+void InterfaceMaker::
+write_shard_prototypes(ostream &) {
+}
+
 /**
  * Generates the list of functions that are appropriate for this interface.
  */
@@ -301,6 +312,19 @@ write_functions(ostream &out) {
   _function_writers.write_code(out);
 }
 
+/**
+ * Like write_functions(), but may write some of the functions to separate
+ * strings, appended to chunks, which can be placed in any of the output files
+ * when the code is split over several files.  Everything else is written to
+ * out, which goes into the first file.
+ *
+ * The default implementation writes everything to out.
+ */
+void InterfaceMaker::
+write_function_chunks(ostream &out, Chunks &) {
+  write_functions(out);
+}
+
 /**
  * Generates whatever additional code is required to support a module file.
  */
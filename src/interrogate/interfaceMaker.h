@@ -53,7 +53,11 @@ public:
 
   virtual void write_includes(std::ostream &out);
   virtual void write_prototypes(std::ostream &out, std::ostream *out_h);
+  virtual void write_shard_prototypes(std::ostream &out);
   virtual void write_functions(std::ostream &out);
+
+  typedef std::vector<std::string> Chunks;
+  virtual void write_function_chunks(std::ostream &out, Chunks &chunks);
   virtual void write_module_support(std::ostream &out, std::ostream *out_h, InterrogateModuleDef *def) {};
 
   virtual void write_module(std::ostream &out, std::ostream *out_h, InterrogateModuleDef *def);
@@ -732,6 +732,14 @@ write_python_instance(ostream &out, int indent_level, const string &return_expr,
 
   string class_name = itype.get_scoped_name();
 
+  // If we are handing over a reference to a reference-counted object, we may
+  // already have a wrapper for it.  In that case, we give back that one, and
+  // drop the reference we were going to pass to the new wrapper.
+  bool cache = cache_wrappers && owns_memory &&
+               TypeManager::is_reference_count(itype._cpptype);
+  const char *open_call = cache ? "Dtool_RememberWrapper(" : "";
+  const char *close_call = cache ? ")" : "";
+
   // We don't handle final classes via DTool_CreatePyInstanceTyped since we
   // know it can't be of a subclass type, so we don't need to do the downcast.
   CPPStructType *struct_type = itype._cpptype->as_struct_type();
@@ -766,24 +774,56 @@ write_python_instance(ostream &out, int indent_level, const string &return_expr,
         << is_const << ", " << return_expr
         << "->get_type_index());\n";
     } else {
+      string type_index = return_expr + "->as_typed_object()->get_type_index()";
+      if (cache) {
+        write_find_wrapper(out, indent_level + 2, return_expr, class_name,
+                           is_const, type_index);
+      }
       indent(out, indent_level)
-        << "  return DTool_CreatePyInstanceTyped((void *)" << return_expr
+        << "  return " << open_call << "DTool_CreatePyInstanceTyped((void *)" << return_expr
         << ", *Dtool_Ptr_" << make_safe_name(class_name) << ", "
         << owns_memory << ", " << is_const << ", "
-        << return_expr << "->as_typed_object()->get_type_index());\n";
+        << type_index << ")" << close_call << ";\n";
     }
     indent(out, indent_level)
       << "}\n";
   } else {
     // DTool_CreatePyInstance will do the NULL check.
+    if (cache) {
+      write_find_wrapper(out, indent_level, return_expr, class_name,
+                         is_const, "0");
+    }
     indent(out, indent_level)
-      << "return "
+      << "return " << open_call
       << "DTool_CreatePyInstance((void *)" << return_expr << ", "
       << "*Dtool_Ptr_" << make_safe_name(class_name) << ", "
-      << owns_memory << ", " << is_const << ");\n";
+      << owns_memory << ", " << is_const << ")" << close_call << ";\n";
   }
 }
 
+/**
+ * Writes the code that returns the existing wrapper of the reference-counted
+ * object, if there is one, after dropping the reference that the new wrapper
+ * would have taken over.
+ */
+void InterfaceMakerPythonNative::
+write_find_wrapper(ostream &out, int indent_level, const string &return_expr,
+                   const string &class_name, bool is_const,
+                   const string &type_index) {
+  indent(out, indent_level)
+    << "PyObject *cached = Dtool_FindWrapper((void *)" << return_expr
+    << ", *Dtool_Ptr_" << make_safe_name(class_name) << ", " << is_const
+    << ", " << type_index << ");\n";
+  indent(out, indent_level)
+    << "if (cached != nullptr) {\n";
+  indent(out, indent_level)
+    << "  unref_delete(" << return_expr << ");\n";
+  indent(out, indent_level)
+    << "  return cached;\n";
+  indent(out, indent_level)
+    << "}\n";
+}
+
 /**
  *
  */
@@ -810,6 +850,12 @@ write_prototypes(ostream &out_code, ostream *out_h) {
     *out_h << "#include \"py_panda.h\"\n\n";
   }
 
+  if (build_python_fastcall) {
+    out_code << "#if PY_VERSION_HEX < 0x03070000\n"
+             << "#error This code was generated with -fastcall, which requires Python 3.7 or later.\n"
+             << "#endif\n\n";
+  }
+
   /*
   for (Function *func : _functions) {
     if (!func->_itype.is_global() && is_function_legal(func)) {
@@ -834,7 +880,12 @@ write_prototypes(ostream &out_code, ostream *out_h) {
       // Forward declare where we will put the scoped enum type.
       string class_name = object->_itype._cpptype->get_local_name(&parser);
       string safe_name = make_safe_name(class_name);
-      out_code << "static PyTypeObject *Dtool_Ptr_" << safe_name << " = nullptr;\n";
+      if (num_output_shards > 1) {
+        // The other output files need to see it too.
+        out_code << "PyTypeObject *Dtool_Ptr_" << safe_name << " = nullptr;\n";
+      } else {
+        out_code << "static PyTypeObject *Dtool_Ptr_" << safe_name << " = nullptr;\n";
+      }
     }
   }
 
@@ -862,27 +913,81 @@ write_prototypes(ostream &out_code, ostream *out_h) {
   out_code << "  {nullptr, nullptr},\n";
   out_code << "};\n\n";
 
+  write_imports(out_code, false);
+}
+
+/**
+ * Generates the declarations that are needed at the top of each additional
+ * output file when the code is split over several files, which are the same
+ * as those written by write_prototypes(), except that the tables that are
+ * shared by the whole module are only declared.
+ */
+void InterfaceMakerPythonNative::
+write_shard_prototypes(ostream &out) {
+  Objects::iterator oi;
+  for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
+    Object *object = (*oi).second;
+    if (object->_itype.is_class() || object->_itype.is_struct()) {
+      if (is_cpp_type_legal(object->_itype._cpptype) &&
+          isExportThisRun(object->_itype._cpptype)) {
+        write_prototypes_class(out, nullptr, object);
+      }
+    } else if (object->_itype.is_scoped_enum() && isExportThisRun(object->_itype._cpptype)) {
+      string class_name = object->_itype._cpptype->get_local_name(&parser);
+      string safe_name = make_safe_name(class_name);
+      out << "extern PyTypeObject *Dtool_Ptr_" << safe_name << ";\n";
+    }
+  }
+  out << "\n";
+
+  write_imports(out, true);
+}
+
+/**
+ * Writes out the declarations for the classes that are defined in other
+ * modules, which are looked up by name when the module is loaded.  If
+ * is_shard is true, this is for one of the additional output files when the
+ * code is split over several files.
+ */
+void InterfaceMakerPythonNative::
+write_imports(ostream &out_code, bool is_shard) {
   out_code << "/**\n";
   out_code << " * Extern declarations for imported classes\n";
   out_code << " */\n";
 
   // Write out a table of the externally imported types that will be filled in
-  // upon module initialization.
+  // upon module initialization.  When the code is split over several files,
+  // they all share the table that is in the first file.
   if (!_external_imports.empty()) {
+    string imports_name = "imports";
+    if (num_output_shards > 1) {
+      imports_name = string("Dtool_") + _def->library_name + "_imports";
+    }
+
     out_code << "#ifndef LINK_ALL_STATIC\n";
-    out_code << "static Dtool_TypeDef imports[] = {\n";
+    if (is_shard) {
+      out_code << "extern Dtool_TypeDef " << imports_name << "[];\n";
+    } else if (num_output_shards > 1) {
+      out_code << "Dtool_TypeDef " << imports_name << "[] = {\n";
+    } else {
+      out_code << "static Dtool_TypeDef " << imports_name << "[] = {\n";
+    }
 
     int idx = 0;
     for (CPPType *type : _external_imports) {
       string class_name = type->get_local_name(&parser);
       string safe_name = make_safe_name(class_name);
 
-      out_code << "  {\"" << class_name << "\", nullptr},\n";
-      out_code << "#define Dtool_Ptr_" << safe_name << " (imports[" << idx << "].type)\n";
+      if (!is_shard) {
+        out_code << "  {\"" << class_name << "\", nullptr},\n";
+      }
+      out_code << "#define Dtool_Ptr_" << safe_name << " (" << imports_name << "[" << idx << "].type)\n";
       ++idx;
     }
-    out_code << "  {nullptr, nullptr},\n";
-    out_code << "};\n";
+    if (!is_shard) {
+      out_code << "  {nullptr, nullptr},\n";
+      out_code << "};\n";
+    }
     out_code << "#endif\n\n";
   }
 
@@ -1043,6 +1148,131 @@ write_functions(ostream &out) {
   }
 }
 
+/**
+ * Like write_functions(), but writes the wrappers for each top-level class,
+ * along with those for the classes nested within it, to a separate string in
+ * chunks, so that they may be distributed over several output files.  The
+ * global functions, and anything that does not belong to a chunk, are written
+ * to out.
+ */
+void InterfaceMakerPythonNative::
+write_function_chunks(ostream &out, Chunks &chunks) {
+  out << "/**\n";
+  out << " * Python wrappers for global functions\n" ;
+  out << " */\n";
+  FunctionsByIndex::iterator fi;
+  for (fi = _functions.begin(); fi != _functions.end(); ++fi) {
+    Function *func = (*fi).second;
+    if (!func->_itype.is_global() && is_function_legal(func)) {
+      write_function_for_top(out, nullptr, func);
+    }
+  }
+
+  std::set<Object *> written;
+  Objects::iterator oi;
+  for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
+    Object *object = (*oi).second;
+    if (!object->_itype.get_outer_class()) {
+      if (object->_itype.is_class() || object->_itype.is_struct()) {
+        if (is_cpp_type_legal(object->_itype._cpptype)) {
+          if (isExportThisRun(object->_itype._cpptype)) {
+            std::vector<Object *> classes(1, object);
+            written.insert(object);
+            get_nested_classes(object, classes, written);
+
+            ostringstream chunk;
+            for (Object *obj : classes) {
+              write_class_definition_macro(chunk, obj);
+            }
+            chunk << "\n";
+            for (Object *obj : classes) {
+              write_class_details(chunk, obj);
+            }
+            write_module_class(chunk, object);
+            chunks.push_back(chunk.str());
+          }
+        }
+      }
+    }
+  }
+
+  // If there are any nested classes whose outer class is not exported, their
+  // wrappers still need to go somewhere.
+  for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
+    Object *object = (*oi).second;
+    if (object->_itype.is_class() || object->_itype.is_struct()) {
+      if (is_cpp_type_legal(object->_itype._cpptype)) {
+        if (isExportThisRun(object->_itype._cpptype)) {
+          if (written.insert(object).second) {
+            write_class_definition_macro(out, object);
+            write_class_details(out, object);
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Adds the exported classes nested within the given class, recursively, to
+ * the nested list, skipping those that are already in the written set.
+ */
+void InterfaceMakerPythonNative::
+get_nested_classes(Object *obj, std::vector<Object *> &nested,
+                   std::set<Object *> &written) {
+  int num_nested = obj->_itype.number_of_nested_types();
+  for (int ni = 0; ni < num_nested; ni++) {
+    TypeIndex nested_index = obj->_itype.get_nested_type(ni);
+    Objects::iterator oi = _objects.find(nested_index);
+    if (oi == _objects.end()) {
+      continue;
+    }
+
+    Object *nested_obj = (*oi).second;
+    if (nested_obj->_itype.is_class() || nested_obj->_itype.is_struct()) {
+      if (is_cpp_type_legal(nested_obj->_itype._cpptype)) {
+        if (isExportThisRun(nested_obj->_itype._cpptype)) {
+          if (written.insert(nested_obj).second) {
+            nested.push_back(nested_obj);
+            get_nested_classes(nested_obj, nested, written);
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Writes out the Define_Module_Class macro for the given class, which
+ * declares the type object and defines the functions that allocate and free
+ * its instances.
+ */
+void InterfaceMakerPythonNative::
+write_class_definition_macro(ostream &out, Object *obj) {
+  std::string class_name = make_safe_name(obj->_itype.get_scoped_name());
+  std::string preferred_name = obj->_itype.get_name();
+
+  CPPType *type = obj->_itype._cpptype;
+
+  if (obj->_itype.has_destructor() ||
+      obj->_itype.destructor_is_inherited() ||
+      obj->_itype.destructor_is_implicit()) {
+
+    if (TypeManager::is_reference_count(type)) {
+      out << "Define_Module_ClassRef";
+    } else {
+      out << "Define_Module_Class";
+    }
+  } else {
+    if (TypeManager::is_reference_count(type)) {
+      out << "Define_Module_ClassRef_Private";
+    } else {
+      out << "Define_Module_Class_Private";
+    }
+  }
+  out << "(" << _def->module_name << ", " << class_name << ", " << class_name << "_localtype, " << classNameFromCppName(preferred_name, false) << ");\n";
+}
+
 /**
  * Writes out all of the wrapper methods necessary to export the given object.
  * This is called by write_functions.
@@ -1086,6 +1316,22 @@ write_class_details(ostream &out, Object *obj) {
       "}\n\n";
   }
 
+  if (has_vectorcall_constructor(obj)) {
+    // Write the same constructor again, taking the arguments as a vector, and
+    // a vectorcall function that calls it.  This is only used when the class
+    // itself is called; tp_vectorcall is not inherited by subclasses.
+    out << "#if PY_VERSION_HEX >= 0x03090000\n";
+    fname = "static int Dtool_InitFast_" + ClassName + "(PyObject *self, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)";
+    for (Function *func : obj->_constructors) {
+      string expected_params;
+      write_function_for_name(out, obj, func->_remaps, fname, expected_params, true, AT_keyword_args, RF_int | RF_fastcall);
+    }
+    out << "static PyObject *Dtool_Vectorcall_" << ClassName << "(PyObject *type, PyObject *const *args, size_t nargsf, PyObject *kwnames) {\n"
+        << "  return Dtool_VectorcallConstruct(type, args, nargsf, kwnames, &Dtool_InitFast_" << ClassName << ");\n"
+        << "}\n"
+        << "#endif\n\n";
+  }
+
   CPPType *cpptype = TypeManager::resolve_type(obj->_itype._cpptype);
 
   // If we have "coercion constructors", write a single wrapper to consolidate
@@ -1141,10 +1387,16 @@ write_class_details(ostream &out, Object *obj) {
     out << "    return local_this;\n";
     out << "  }\n";
 
+    // Casts that don't go through a virtual base have a constant pointer
+    // adjustment, which can be cached for the next time.
     for (di = details.begin(); di != details.end(); di++) {
       if (di->second._is_legal_py_class) {
         out << "  if (requested_type == Dtool_Ptr_" << make_safe_name(di->second._to_class_name) << ") {\n";
-        out << "    return " << di->second._up_cast_string << " local_this;\n";
+        if (di->second._can_downcast) {
+          out << "    return Dtool_CacheUpcast(self, requested_type, " << di->second._up_cast_string << " local_this);\n";
+        } else {
+          out << "    return " << di->second._up_cast_string << " local_this;\n";
+        }
         out << "  }\n";
       }
     }
@@ -1170,7 +1422,7 @@ write_class_details(ostream &out, Object *obj) {
       }
     }
 
-    out << "  return nullptr;\n";
+    out << "  return Dtool_CacheUpcastFailure(self, requested_type);\n";
     out << "}\n\n";
 
     out << "static void *Dtool_DowncastInterface_" << ClassName << "(void *from_this, Dtool_PyTypedObject *from_type) {\n";
@@ -1198,10 +1450,8 @@ write_class_details(ostream &out, Object *obj) {
  */
 void InterfaceMakerPythonNative::
 write_class_declarations(ostream &out, ostream *out_h, Object *obj) {
-  const InterrogateType &itype = obj->_itype;
   std::string class_name = make_safe_name(obj->_itype.get_scoped_name());
   std::string c_class_name =  obj->_itype.get_true_name();
-  std::string preferred_name =  itype.get_name();
   std::string class_struct_name = std::string(CLASS_PREFIX) + class_name;
 
   CPPType *type = obj->_itype._cpptype;
@@ -1209,26 +1459,23 @@ write_class_declarations(ostream &out, ostream *out_h, Object *obj) {
   // This typedef is necessary for class templates since we can't pass a comma
   // to a macro function.
   out << "typedef " << c_class_name << " " << class_name << "_localtype;\n";
-  if (obj->_itype.has_destructor() ||
-      obj->_itype.destructor_is_inherited() ||
-      obj->_itype.destructor_is_implicit()) {
-
-    if (TypeManager::is_reference_count(type)) {
-      out << "Define_Module_ClassRef";
-    } else {
-      out << "Define_Module_Class";
-    }
+  if (num_output_shards > 1) {
+    // The static functions defined by the macro are only needed in the file
+    // that contains the rest of the wrappers for this class, so it is written
+    // there, by write_function_chunks().
+    out << "extern struct Dtool_PyTypedObject Dtool_" << class_name << ";\n";
   } else {
-    if (TypeManager::is_reference_count(type)) {
-      out << "Define_Module_ClassRef_Private";
-    } else {
-      out << "Define_Module_Class_Private";
-    }
+    write_class_definition_macro(out, obj);
   }
-  out << "(" << _def->module_name << ", " << class_name << ", " << class_name << "_localtype, " << classNameFromCppName(preferred_name, false) << ");\n";
 
   out << "static struct Dtool_PyTypedObject *const Dtool_Ptr_" << class_name << " = &Dtool_" << class_name << ";\n";
-  out << "static void Dtool_PyModuleClassInit_" << class_name << "(PyObject *module);\n";
+  if (num_output_shards > 1) {
+    // This is called from the module initialization, which may end up in a
+    // different output file.
+    out << "void Dtool_PyModuleClassInit_" << class_name << "(PyObject *module);\n";
+  } else {
+    out << "static void Dtool_PyModuleClassInit_" << class_name << "(PyObject *module);\n";
+  }
 
   int has_coerce = has_coerce_constructor(type->as_struct_type());
   if (has_coerce > 0) {
@@ -1260,7 +1507,9 @@ write_sub_module(ostream &out, Object *obj) {
 
   if (!obj->_itype.is_typedef()) {
     out << "  // " << *(obj->_itype._cpptype) << "\n";
-    out << "  Dtool_PyModuleClassInit_" << class_name << "(module);\n";
+    if (!lazy_types) {
+      out << "  Dtool_PyModuleClassInit_" << class_name << "(module);\n";
+    }
     class_ptr = "&Dtool_" + class_name;
 
   } else {
@@ -1288,13 +1537,24 @@ write_sub_module(ostream &out, Object *obj) {
 
       // If this is a typedef to a class defined in the same module, make sure
       // that the class is initialized before we try to define the typedef.
-      out << "  Dtool_PyModuleClassInit_" << class_name << "(module);\n";
+      if (!lazy_types) {
+        out << "  Dtool_PyModuleClassInit_" << class_name << "(module);\n";
+      }
     }
   }
 
   std::string export_class_name = classNameFromCppName(obj->_itype.get_name(), false);
   std::string export_class_name2 = classNameFromCppName(obj->_itype.get_name(), true);
 
+  if (lazy_types) {
+    // The class is initialized by the module's __getattr__ instead.
+    out << "  Dtool_AddLazyType(module, \"" << export_class_name << "\", " << class_ptr << ");\n";
+    if (export_class_name != export_class_name2) {
+      out << "  Dtool_AddLazyType(module, \"" << export_class_name2 << "\", " << class_ptr << ");\n";
+    }
+    return;
+  }
+
   class_ptr = "(PyObject *)" + class_ptr;
 
   // Note: PyModule_AddObject steals a reference, so we have to call Py_INCREF
@@ -1471,26 +1731,8 @@ write_module_support(ostream &out, ostream *out_h, InterrogateModuleDef *def) {
       string name1 = methodNameFromCppName(func, "", false);
       string name2 = methodNameFromCppName(func, "", true);
 
-      string flags;
       string fptr = "&" + func->_name;
-      switch (func->_args_type) {
-      case AT_keyword_args:
-        flags = "METH_VARARGS | METH_KEYWORDS";
-        fptr = "(PyCFunction) " + fptr;
-        break;
-
-      case AT_varargs:
-        flags = "METH_VARARGS";
-        break;
-
-      case AT_single_arg:
-        flags = "METH_O";
-        break;
-
-      default:
-        flags = "METH_NOARGS";
-        break;
-      }
+      string flags = get_method_flags(func, fptr);
 
       // Note: we shouldn't add METH_STATIC here, since both METH_STATIC and
       // METH_CLASS are illegal for module-level functions.
@@ -1507,19 +1749,28 @@ write_module_support(ostream &out, ostream *out_h, InterrogateModuleDef *def) {
   if (force_base_functions) {
     out << "  // Support Function For Dtool_types ... for now in each module ??\n";
     out << "  {\"Dtool_BorrowThisReference\", &Dtool_BorrowThisReference, METH_VARARGS, \"Used to borrow 'this' pointer (to, from)\\nAssumes no ownership.\"},\n";
+    out << "  {\"Dtool_GetFreeListStats\", &Dtool_GetFreeListStats, METH_NOARGS, \"Returns the usage of the free lists of instances, by class name.\"},\n";
     //out << "  {\"Dtool_AddToDictionary\", &Dtool_AddToDictionary, METH_VARARGS, \"Used to add items into a tp_dict\"},\n";
   }
 
+  if (gil_telemetry) {
+    out << "  {\"_gil_telemetry\", &Dtool_GetCallStats, METH_VARARGS, \"Returns the call timings recorded by -gil-telemetry.\"},\n";
+  }
+
   out << "  {nullptr, nullptr, 0, nullptr}\n" << "};\n\n";
 
   if (_external_imports.empty()) {
     out << "extern const struct LibraryDef " << def->library_name << "_moddef = {python_simple_funcs, exports, nullptr};\n";
   } else {
+    string imports_name = "imports";
+    if (num_output_shards > 1) {
+      imports_name = string("Dtool_") + def->library_name + "_imports";
+    }
     out <<
       "#ifdef LINK_ALL_STATIC\n"
       "extern const struct LibraryDef " << def->library_name << "_moddef = {python_simple_funcs, exports, nullptr};\n"
       "#else\n"
-      "extern const struct LibraryDef " << def->library_name << "_moddef = {python_simple_funcs, exports, imports};\n"
+      "extern const struct LibraryDef " << def->library_name << "_moddef = {python_simple_funcs, exports, " << imports_name << "};\n"
       "#endif\n";
   }
   if (out_h != nullptr) {
@@ -1630,26 +1881,8 @@ write_module_class(ostream &out, Object *obj) {
     string name1 = methodNameFromCppName(func, export_class_name, false);
     string name2 = methodNameFromCppName(func, export_class_name, true);
 
-    string flags;
     string fptr = "&" + func->_name;
-    switch (func->_args_type) {
-    case AT_keyword_args:
-      flags = "METH_VARARGS | METH_KEYWORDS";
-      fptr = "(PyCFunction) " + fptr;
-      break;
-
-    case AT_varargs:
-      flags = "METH_VARARGS";
-      break;
-
-    case AT_single_arg:
-      flags = "METH_O";
-      break;
-
-    default:
-      flags = "METH_NOARGS";
-      break;
-    }
+    string flags = get_method_flags(func, fptr);
 
     if (!func->_has_this) {
       flags += " | METH_STATIC";
@@ -2015,14 +2248,10 @@ write_module_class(ostream &out, Object *obj) {
           out << "// " << ClassName << " slot " << rfi->second._answer_location << " -> " << fname << "\n";
           out << "//////////////////\n";
           out << "static PyObject *" << def._wrapper_name << "(PyObject *self, PyObject *arg) {\n";
-          out << "  PyObject *res = PyObject_GenericGetAttr(self, arg);\n";
-          out << "  if (res != nullptr) {\n";
+          out << "  PyObject *res = Dtool_GenericGetAttrOrNull(self, arg);\n";
+          out << "  if (res != nullptr || _PyErr_OCCURRED()) {\n";
           out << "    return res;\n";
-          out << "  }\n";
-          out << "  if (_PyErr_OCCURRED() != PyExc_AttributeError) {\n";
-          out << "    return nullptr;\n";
-          out << "  }\n";
-          out << "  PyErr_Clear();\n\n";
+          out << "  }\n\n";
 
           out << "  " << cClassName  << " *local_this = nullptr;\n";
           out << "  if (!Dtool_Call_ExtractThisPointer(self, Dtool_" << ClassName << ", (void **)&local_this)) {\n";
@@ -2526,6 +2755,50 @@ write_module_class(ostream &out, Object *obj) {
       }
     }
 
+    // A vector of numbers is stored contiguously, so unless the class defines
+    // its own buffer protocol, we can export the storage directly.
+    CPPType *element_type = nullptr;
+    if (slots.count("bf_getbuffer") == 0 &&
+        TypeManager::is_vector(obj->_itype._cpptype)) {
+      element_type = TypeManager::get_template_parameter_type(obj->_itype._cpptype);
+    }
+    const char *format = nullptr;
+    if (element_type != nullptr) {
+      format = get_buffer_format(element_type);
+    }
+    if (format != nullptr) {
+      has_local_getbuffer = true;
+
+      SlottedFunctionDef &getbuffer_def = slots["bf_getbuffer"];
+      getbuffer_def._answer_location = "bf_getbuffer";
+      getbuffer_def._wrapper_type = WT_getbuffer;
+      getbuffer_def._wrapper_name = "Dtool_GetBuffer_" + ClassName;
+      getbuffer_def._keep_method = false;
+
+      SlottedFunctionDef &releasebuffer_def = slots["bf_releasebuffer"];
+      releasebuffer_def._answer_location = "bf_releasebuffer";
+      releasebuffer_def._wrapper_type = WT_releasebuffer;
+      releasebuffer_def._wrapper_name = "Dtool_ReleaseBuffer_" + ClassName;
+      releasebuffer_def._keep_method = false;
+
+      out << "//////////////////\n";
+      out << "// Exports the elements of " << ClassName << " through the buffer protocol.\n";
+      out << "//////////////////\n";
+      out << "static int " << getbuffer_def._wrapper_name << "(PyObject *self, Py_buffer *buffer, int flags) {\n";
+      out << "  " << cClassName << " *local_this = nullptr;\n";
+      out << "  if (!Dtool_Call_ExtractThisPointer(self, Dtool_" << ClassName << ", (void **)&local_this)) {\n";
+      out << "    return -1;\n";
+      out << "  }\n";
+      out << "  return Dtool_GetVectorBuffer(self, buffer, flags, (void *)local_this->data(), "
+          << "(Py_ssize_t)local_this->size(), sizeof(" << element_type->get_local_name(&parser)
+          << "), \"" << format << "\");\n";
+      out << "}\n\n";
+
+      out << "static void " << releasebuffer_def._wrapper_name << "(PyObject *self, Py_buffer *buffer) {\n";
+      out << "  Dtool_ReleaseVectorBuffer(self, buffer);\n";
+      out << "}\n\n";
+    }
+
     int need_repr = 0;
     if (slots.count("tp_repr") == 0) {
       need_repr = NeedsAReprFunction(obj->_itype);
@@ -3128,7 +3401,13 @@ write_module_class(ostream &out, Object *obj) {
   out << "    nullptr, // tp_finalize\n";
   out << "#endif\n";
   // vectorcallfunc tp_vectorcall
-  out << "#if PY_VERSION_HEX >= 0x03080000\n";
+  if (has_vectorcall_constructor(obj)) {
+    out << "#if PY_VERSION_HEX >= 0x03090000\n";
+    out << "    &Dtool_Vectorcall_" << ClassName << ",\n";
+    out << "#elif PY_VERSION_HEX >= 0x03080000\n";
+  } else {
+    out << "#if PY_VERSION_HEX >= 0x03080000\n";
+  }
   out << "    nullptr, // tp_vectorcall\n";
   out << "#endif\n";
   out << "  },\n";
@@ -3160,7 +3439,11 @@ write_module_class(ostream &out, Object *obj) {
 
   out << "};\n\n";
 
-  out << "static void Dtool_PyModuleClassInit_" << ClassName << "(PyObject *module) {\n";
+  if (num_output_shards > 1) {
+    out << "void Dtool_PyModuleClassInit_" << ClassName << "(PyObject *module) {\n";
+  } else {
+    out << "static void Dtool_PyModuleClassInit_" << ClassName << "(PyObject *module) {\n";
+  }
   out << "  (void) module; // Unused\n";
   out << "  static bool initdone = false;\n";
   out << "  if (!initdone) {\n";
@@ -3472,6 +3755,80 @@ write_prototype_for_name(ostream &out, InterfaceMaker::Function *func, const std
 // }
 }
 
+/**
+ * Returns true if the wrapper for the indicated function should receive its
+ * arguments as a vector, using the METH_FASTCALL calling convention, rather
+ * than as a tuple and a dict.
+ */
+bool InterfaceMakerPythonNative::
+is_fastcall_function(const Function *func) {
+  if (!build_python_fastcall) {
+    return false;
+  }
+  if (func->_args_type != AT_varargs && func->_args_type != AT_keyword_args) {
+    return false;
+  }
+
+  // Functions that take the args tuple themselves get what they ask for.
+  for (FunctionRemap *remap : func->_remaps) {
+    if (remap->_flags & FunctionRemap::F_explicit_args) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Returns true if the indicated class should be given a vectorcall
+ * constructor, which constructs an instance without packing the arguments
+ * into a tuple and a dict.
+ */
+bool InterfaceMakerPythonNative::
+has_vectorcall_constructor(Object *obj) {
+  if (!build_python_fastcall || obj->_constructors.empty()) {
+    return false;
+  }
+
+  for (Function *func : obj->_constructors) {
+    for (FunctionRemap *remap : func->_remaps) {
+      if (remap->_flags & FunctionRemap::F_explicit_args) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Returns the flags to store in the PyMethodDef entry for the indicated
+ * function.  If the wrapper doesn't have the PyCFunction signature, a cast is
+ * added to fptr.
+ */
+string InterfaceMakerPythonNative::
+get_method_flags(const Function *func, string &fptr) {
+  switch (func->_args_type) {
+  case AT_keyword_args:
+    fptr = "(PyCFunction) " + fptr;
+    if (is_fastcall_function(func)) {
+      return "METH_FASTCALL | METH_KEYWORDS";
+    }
+    return "METH_VARARGS | METH_KEYWORDS";
+
+  case AT_varargs:
+    if (is_fastcall_function(func)) {
+      fptr = "(PyCFunction) " + fptr;
+      return "METH_FASTCALL";
+    }
+    return "METH_VARARGS";
+
+  case AT_single_arg:
+    return "METH_O";
+
+  default:
+    return "METH_NOARGS";
+  }
+}
+
 /**
  * Writes the definition for a function that will call the indicated C++
  * function or method.
@@ -3525,13 +3882,27 @@ write_function_for_top(ostream &out, InterfaceMaker::Object *obj, InterfaceMaker
     prototype += "self";
   }
 
+  int return_flags = RF_pyobject | RF_err_null;
+  bool fastcall = is_fastcall_function(func);
+  if (fastcall) {
+    return_flags |= RF_fastcall;
+  }
+
   switch (func->_args_type) {
   case AT_keyword_args:
-    prototype += ", PyObject *args, PyObject *kwds";
+    if (fastcall) {
+      prototype += ", PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames";
+    } else {
+      prototype += ", PyObject *args, PyObject *kwds";
+    }
     break;
 
   case AT_varargs:
-    prototype += ", PyObject *args";
+    if (fastcall) {
+      prototype += ", PyObject *const *args, Py_ssize_t nargs";
+    } else {
+      prototype += ", PyObject *args";
+    }
     break;
 
   case AT_single_arg:
@@ -3545,7 +3916,7 @@ write_function_for_top(ostream &out, InterfaceMaker::Object *obj, InterfaceMaker
   prototype += ")";
 
   string expected_params;
-  write_function_for_name(out, obj, func->_remaps, prototype, expected_params, true, func->_args_type, RF_pyobject | RF_err_null);
+  write_function_for_name(out, obj, func->_remaps, prototype, expected_params, true, func->_args_type, return_flags);
 
   // Now synthesize a variable for the docstring.
   ostringstream comment;
@@ -3664,6 +4035,13 @@ write_function_for_name(ostream &out, Object *obj,
 
     error_return(out, 4, return_flags);
     out << "  }\n";
+
+    if (is_vector_resize(obj, remap)) {
+      out << "  if (!Dtool_CheckNoExports(self, \"" << classNameFromCppName(cClassName, false)
+          << "." << methodNameFromCppName(remap, cClassName, false) << "\")) {\n";
+      error_return(out, 4, return_flags);
+      out << "  }\n";
+    }
   }
 
   if (map_sets.empty()) {
@@ -3672,9 +4050,15 @@ write_function_for_name(ostream &out, Object *obj,
     return;
   }
 
+  // These expressions give the number of positional and keyword arguments.
+  bool fastcall = (return_flags & RF_fastcall) != 0;
+  string num_args_expr = fastcall ? "(int)nargs" : "(int)PyTuple_Size(args)";
+  string num_kwds_expr = fastcall ? "(int)PyTuple_GET_SIZE(kwnames)" : "(int)PyDict_Size(kwds)";
+  string kwds_name = fastcall ? "kwnames" : "kwds";
+
   if (args_type == AT_keyword_args && !has_keywords) {
     // We don't actually take keyword arguments.  Make sure we didn't get any.
-    out << "  if (kwds != nullptr && PyDict_Size(kwds) > 0) {\n";
+    out << "  if (" << kwds_name << " != nullptr && " << num_kwds_expr << " > 0) {\n";
     out << "#ifdef NDEBUG\n";
     error_raise_return(out, 4, return_flags, "TypeError", "function takes no keyword arguments");
     out << "#else\n";
@@ -3699,14 +4083,14 @@ write_function_for_name(ostream &out, Object *obj,
     // We have more than one remap.
     switch (args_type) {
     case AT_keyword_args:
-      indent(out, 2) << "int parameter_count = (int)PyTuple_Size(args);\n";
-      indent(out, 2) << "if (kwds != nullptr) {\n";
-      indent(out, 2) << "  parameter_count += (int)PyDict_Size(kwds);\n";
+      indent(out, 2) << "int parameter_count = " << num_args_expr << ";\n";
+      indent(out, 2) << "if (" << kwds_name << " != nullptr) {\n";
+      indent(out, 2) << "  parameter_count += " << num_kwds_expr << ";\n";
       indent(out, 2) << "}\n";
       break;
 
     case AT_varargs:
-      indent(out, 2) << "int parameter_count = (int)PyTuple_Size(args);\n";
+      indent(out, 2) << "int parameter_count = " << num_args_expr << ";\n";
       break;
 
     case AT_single_arg:
@@ -3759,9 +4143,13 @@ write_function_for_name(ostream &out, Object *obj,
       if (strip_keyword_args) {
         // None of the remaps take any keyword arguments, so let's check that
         // we take none.  This saves some checks later on.
-        indent(out, 4) << "if (kwds == nullptr || PyDict_GET_SIZE(kwds) == 0) {\n";
+        if (fastcall) {
+          indent(out, 4) << "if (kwnames == nullptr || PyTuple_GET_SIZE(kwnames) == 0) {\n";
+        } else {
+          indent(out, 4) << "if (kwds == nullptr || PyDict_GET_SIZE(kwds) == 0) {\n";
+        }
         if (min_args == 1 && min_args == 1) {
-          indent(out, 4) << "  PyObject *arg = PyTuple_GET_ITEM(args, 0);\n";
+          indent(out, 4) << "  PyObject *arg = " << (fastcall ? "args[0]" : "PyTuple_GET_ITEM(args, 0)") << ";\n";
           write_function_forset(out, mii->second, min_args, max_args, expected_params, 6,
                 coercion_allowed, true, AT_single_arg, return_flags, true, !all_nonconst);
         } else {
@@ -3772,7 +4160,7 @@ write_function_for_name(ostream &out, Object *obj,
         // We already checked that the args tuple has only one argument, so
         // we might as well extract that from the tuple now.
         indent(out, 4) << "{\n";
-        indent(out, 4) << "  PyObject *arg = PyTuple_GET_ITEM(args, 0);\n";
+        indent(out, 4) << "  PyObject *arg = " << (fastcall ? "args[0]" : "PyTuple_GET_ITEM(args, 0)") << ";\n";
 
         write_function_forset(out, mii->second, min_args, max_args, expected_params, 6,
                       coercion_allowed, true, AT_single_arg, return_flags, true, !all_nonconst);
@@ -3825,7 +4213,7 @@ write_function_for_name(ostream &out, Object *obj,
 
     out << "  if (!_PyErr_OCCURRED()) {\n"
         << "    ";
-    if ((return_flags & ~RF_pyobject) == RF_err_null) {
+    if ((return_flags & ~(RF_pyobject | RF_fastcall)) == RF_err_null) {
       out << "return ";
     }
     out << "Dtool_Raise_BadArgumentsError(\n";
@@ -3844,15 +4232,24 @@ write_function_for_name(ostream &out, Object *obj,
     if (mii->first == 0 && args_type != AT_no_args) {
       switch (args_type) {
       case AT_keyword_args:
-        out << "  if (!Dtool_CheckNoArgs(args, kwds)) {\n";
-        out << "    int parameter_count = (int)PyTuple_Size(args);\n";
-        out << "    if (kwds != nullptr) {\n";
-        out << "      parameter_count += (int)PyDict_Size(kwds);\n";
+        if (fastcall) {
+          out << "  if (!Dtool_CheckNoArgs(nargs, kwnames)) {\n";
+        } else {
+          out << "  if (!Dtool_CheckNoArgs(args, kwds)) {\n";
+        }
+        out << "    int parameter_count = " << num_args_expr << ";\n";
+        out << "    if (" << kwds_name << " != nullptr) {\n";
+        out << "      parameter_count += " << num_kwds_expr << ";\n";
         out << "    }\n";
         break;
       case AT_varargs:
-        out << "  if (!Dtool_CheckNoArgs(args)) {\n";
-        out << "    const int parameter_count = (int)PyTuple_GET_SIZE(args);\n";
+        if (fastcall) {
+          out << "  if (nargs != 0) {\n";
+          out << "    const int parameter_count = (int)nargs;\n";
+        } else {
+          out << "  if (!Dtool_CheckNoArgs(args)) {\n";
+          out << "    const int parameter_count = (int)PyTuple_GET_SIZE(args);\n";
+        }
         break;
       case AT_single_arg:
         // Shouldn't happen, but let's handle this case nonetheless.
@@ -3877,9 +4274,9 @@ write_function_for_name(ostream &out, Object *obj,
     } else if (args_type == AT_keyword_args && max_required_args == 1 && mii->first == 1) {
       // Check this to be sure, as we handle the case of only 1 keyword arg in
       // write_function_forset (not using ParseTupleAndKeywords).
-      out << "  int parameter_count = (int)PyTuple_Size(args);\n"
-             "  if (kwds != nullptr) {\n"
-             "    parameter_count += (int)PyDict_Size(kwds);\n"
+      out << "  int parameter_count = " << num_args_expr << ";\n"
+             "  if (" << kwds_name << " != nullptr) {\n"
+             "    parameter_count += " << num_kwds_expr << ";\n"
              "  }\n"
              "  if (parameter_count != 1) {\n"
              "#ifdef NDEBUG\n";
@@ -3903,7 +4300,7 @@ write_function_for_name(ostream &out, Object *obj,
     if (args_type != AT_no_args) {
       out << "  if (!_PyErr_OCCURRED()) {\n"
           << "    ";
-      if ((return_flags & ~RF_pyobject) == RF_err_null) {
+      if ((return_flags & ~(RF_pyobject | RF_fastcall)) == RF_err_null) {
         out << "return ";
       }
       out << "Dtool_Raise_BadArgumentsError(\n";
@@ -4433,7 +4830,9 @@ write_function_forset(ostream &out,
     // Extract it from the dict so we don't have to call
     // ParseTupleAndKeywords.
     indent(out, indent_level) << "PyObject *arg;\n";
-    indent(out, indent_level) << "if (Dtool_ExtractArg(&arg, args, kwds, \"" << first_param_name << "\")) {\n";
+    indent(out, indent_level) << "if (Dtool_ExtractArg(&arg, "
+      << ((return_flags & RF_fastcall) ? "args, nargs, kwnames" : "args, kwds")
+      << ", \"" << first_param_name << "\")) {\n";
     indent_level += 2;
     args_type = AT_single_arg;
   }
@@ -4446,7 +4845,57 @@ write_function_forset(ostream &out,
     std::sort(remaps.begin(), remaps.end(), RemapCompareLess);
     std::vector<FunctionRemap *>::const_iterator sii;
 
+    // When the arguments have to be parsed from a tuple, which is costly, we
+    // keep a cache of which overload accepted the last combination of
+    // argument types, and start from there if the types are the same on the
+    // next call, skipping the overloads before it, which would not accept
+    // them anyway.  If that overload doesn't accept them after all, we go
+    // around again.  A single argument is cheap enough to check directly.
+    // If an overload may reject an argument for its value in a way that the
+    // cache key doesn't capture, skipping it could change the outcome.
+    bool cache_possible = first_pexpr.empty();
+    for (FunctionRemap *remap : remaps) {
+      if (is_remap_value_checked(remap)) {
+        cache_possible = false;
+        break;
+      }
+    }
+
+    string cache_args;
+    if (cache_possible) {
+      if (args_type == AT_keyword_args) {
+        cache_args = (return_flags & RF_fastcall) ? "args, nargs, kwnames" : "args, kwds";
+      } else if (args_type == AT_varargs) {
+        cache_args = (return_flags & RF_fastcall) ? "args, nargs, nullptr" : "args, nullptr";
+      }
+    }
+
+    if (!cache_args.empty()) {
+      // The key includes the constness of self if that decides which
+      // overloads are eligible.
+      string self_const = "false";
+      if (verify_const) {
+        for (FunctionRemap *remap : remaps) {
+          if (remap->_has_this && !remap->_const_method) {
+            self_const = "DtoolInstance_IS_CONST(self)";
+            break;
+          }
+        }
+      }
+      cache_args += ", " + self_const;
+
+      indent(out, indent_level) << "{\n";
+      indent(out, indent_level)
+        << "  static Dtool_OverloadCache overload_cache;\n";
+      indent(out, indent_level)
+        << "  int overload_start = Dtool_FindOverload(overload_cache, "
+        << cache_args << ");\n";
+      indent(out, indent_level) << "  for (;;) {\n";
+      indent_level += 4;
+    }
+
     int num_coercion_possible = 0;
+    int overload_index = 0;
     sii = remaps.begin();
     while (sii != remaps.end()) {
       remap = *(sii++);
@@ -4461,10 +4910,21 @@ write_function_forset(ostream &out,
         }
       }
 
+      ostringstream condition;
+      if (!cache_args.empty()) {
+        condition << "overload_start <= " << overload_index;
+      }
       if (verify_const && (remap->_has_this && !remap->_const_method)) {
         // If it's a non-const method, we only allow a non-const this.
+        if (!cache_args.empty()) {
+          condition << " && ";
+        }
+        condition << "!DtoolInstance_IS_CONST(self)";
+      }
+
+      if (!condition.str().empty()) {
         indent(out, indent_level)
-          << "if (!DtoolInstance_IS_CONST(self)) {\n";
+          << "if (" << condition.str() << ") {\n";
       } else {
         indent(out, indent_level)
           << "{\n";
@@ -4477,12 +4937,33 @@ write_function_forset(ostream &out,
       // NB.  We don't pass on report_errors here because we want it to
       // silently drop down to the next overload.
 
+      string remember_overload;
+      if (!cache_args.empty()) {
+        ostringstream call;
+        call << "Dtool_RememberOverload(overload_cache, overload_start, "
+             << overload_index << ", " << cache_args << ");";
+        remember_overload = call.str();
+      }
+
       write_function_instance(out, remap, min_num_args, max_num_args,
                               expected_params, indent_level + 2,
                               false, false, args_type, return_flags,
-                              check_exceptions, first_pexpr);
+                              check_exceptions, first_pexpr,
+                              remember_overload);
 
       indent(out, indent_level) << "}\n\n";
+      ++overload_index;
+    }
+
+    if (!cache_args.empty()) {
+      indent(out, indent_level) << "if (overload_start <= 0) {\n";
+      indent(out, indent_level) << "  break;\n";
+      indent(out, indent_level) << "}\n";
+      indent(out, indent_level) << "overload_start = 0;\n";
+      indent(out, indent_level) << "overload_cache._index = 0;\n";
+      indent_level -= 4;
+      indent(out, indent_level) << "  }\n";
+      indent(out, indent_level) << "}\n\n";
     }
 
     // Go through one more time, but allow coercion this time.
@@ -4592,6 +5073,10 @@ write_function_forset(ostream &out,
  * If first_pexpr is not empty, it represents the preconverted value of the
  * first parameter.  This is a special-case hack for one of the slot
  * functions.
+ *
+ * If remember_overload is not empty, it is a statement that records in the
+ * overload cache of write_function_forset that this overload accepted the
+ * arguments, to be written once they have been checked.
  */
 void InterfaceMakerPythonNative::
 write_function_instance(ostream &out, FunctionRemap *remap,
@@ -4600,7 +5085,8 @@ write_function_instance(ostream &out, FunctionRemap *remap,
                         bool coercion_possible, bool report_errors,
                         ArgsType args_type, int return_flags,
                         bool check_exceptions,
-                        const string &first_pexpr) {
+                        const string &first_pexpr,
+                        const string &remember_overload) {
   string format_specifiers;
   string keyword_list;
   string parameter_list;
@@ -5006,7 +5492,16 @@ write_function_instance(ostream &out, FunctionRemap *remap,
         format_specifiers += "O";
         parameter_list += ", &" + param_name;
       }
-      pexpr_string = "(PyObject_IsTrue(" + param_name + ") != 0)";
+      if (remap->_blocking) {
+        // The call is made without holding the interpreter lock, so we have
+        // to convert the argument beforehand.
+        extra_convert
+          << "bool " << param_name << "_val = (PyObject_IsTrue("
+          << param_name << ") != 0);\n";
+        pexpr_string = param_name + "_val";
+      } else {
+        pexpr_string = "(PyObject_IsTrue(" + param_name + ") != 0)";
+      }
       expected_params += "bool";
 
     } else if (TypeManager::is_nullptr(type)) {
@@ -5223,7 +5718,12 @@ write_function_instance(ostream &out, FunctionRemap *remap,
     } else if (TypeManager::is_long(type)) {
       // Signed longs are equivalent to Python's int type.
       if (args_type == AT_single_arg) {
-        pexpr_string = "PyLongOrInt_AS_LONG(arg)";
+        if (remap->_blocking) {
+          extra_convert << "long arg_val = PyLongOrInt_AS_LONG(arg);\n";
+          pexpr_string = "arg_val";
+        } else {
+          pexpr_string = "PyLongOrInt_AS_LONG(arg)";
+        }
         type_check = "PyLongOrInt_Check(arg)";
       } else {
         indent(out, indent_level) << "long " << param_name << default_expr << ";\n";
@@ -5265,7 +5765,12 @@ write_function_instance(ostream &out, FunctionRemap *remap,
 
     } else if (TypeManager::is_double(type)) {
       if (args_type == AT_single_arg) {
-        pexpr_string = "PyFloat_AsDouble(arg)";
+        if (remap->_blocking) {
+          extra_convert << "double arg_val = PyFloat_AsDouble(arg);\n";
+          pexpr_string = "arg_val";
+        } else {
+          pexpr_string = "PyFloat_AsDouble(arg)";
+        }
         type_check = "PyNumber_Check(arg)";
       } else {
         indent(out, indent_level) << "double " << param_name << default_expr << ";\n";
@@ -5277,7 +5782,12 @@ write_function_instance(ostream &out, FunctionRemap *remap,
 
     } else if (TypeManager::is_float(type)) {
       if (args_type == AT_single_arg) {
-        pexpr_string = "(" + type->get_local_name(&parser) + ")PyFloat_AsDouble(arg)";
+        if (remap->_blocking) {
+          extra_convert << "double arg_val = PyFloat_AsDouble(arg);\n";
+          pexpr_string = "(" + type->get_local_name(&parser) + ")arg_val";
+        } else {
+          pexpr_string = "(" + type->get_local_name(&parser) + ")PyFloat_AsDouble(arg)";
+        }
         type_check = "PyNumber_Check(arg)";
       } else {
         indent(out, indent_level) << "float " << param_name << default_expr << ";\n";
@@ -5653,7 +6163,7 @@ write_function_instance(ostream &out, FunctionRemap *remap,
           }
 
           // Display error like: Class.func() argument 0 must be A, not B
-          if ((return_flags & ~RF_pyobject) == RF_err_null) {
+          if ((return_flags & ~(RF_pyobject | RF_fastcall)) == RF_err_null) {
             // Dtool_Raise_ArgTypeError returns NULL already
             extra_convert << "  return ";
           } else {
@@ -5665,7 +6175,7 @@ write_function_instance(ostream &out, FunctionRemap *remap,
             << methodNameFromCppName(remap, this_class_name, false)
             << "\", \"" << expected_class_name << "\");\n";
 
-          if ((return_flags & ~RF_pyobject) != RF_err_null) {
+          if ((return_flags & ~(RF_pyobject | RF_fastcall)) != RF_err_null) {
             error_return(extra_convert, 2, return_flags);
           }
           extra_convert << "}\n";
@@ -5813,6 +6323,11 @@ write_function_instance(ostream &out, FunctionRemap *remap,
   } else if (!format_specifiers.empty()) {
     string method_name = methodNameFromCppName(remap, "", false);
 
+    // With -fastcall, the arguments are passed as a vector, and we use our
+    // own equivalents of the PyArg functions.
+    bool fastcall = (return_flags & RF_fastcall) != 0;
+    string args_expr = fastcall ? "args, nargs, kwnames" : "args, kwds";
+
     switch (args_type) {
     case AT_keyword_args:
       // Wrapper takes a varargs tuple and a keyword args dict.
@@ -5822,11 +6337,22 @@ write_function_instance(ostream &out, FunctionRemap *remap,
           // case we have implemented ourselves.
           if (min_num_args == 1) {
             indent(out, indent_level)
-              << "if (Dtool_ExtractArg(&" << param_name << ", args, kwds, " << keyword_list << ")) {\n";
+              << "if (Dtool_ExtractArg(&" << param_name << ", " << args_expr << ", " << keyword_list << ")) {\n";
           } else {
             indent(out, indent_level)
-              << "if (Dtool_ExtractOptionalArg(&" << param_name << ", args, kwds, " << keyword_list << ")) {\n";
+              << "if (Dtool_ExtractOptionalArg(&" << param_name << ", " << args_expr << ", " << keyword_list << ")) {\n";
           }
+        } else if (fastcall) {
+          // The keywords are matched against a table of interned strings.
+          clear_error = true;
+          indent(out, indent_level)
+            << "static const char *keyword_list[] = {" << keyword_list << ", nullptr};\n";
+          indent(out, indent_level)
+            << "static PyObject *keyword_names[sizeof(keyword_list) / sizeof(keyword_list[0]) - 1];\n";
+          indent(out, indent_level)
+            << "if (Dtool_ParseFastcallArgs(args, nargs, kwnames, keyword_list, keyword_names, \""
+            << format_specifiers << ":" << method_name
+            << "\"" << parameter_list << ")) {\n";
         } else {
           // We have to use the more expensive PyArg_ParseTupleAndKeywords.
           clear_error = true;
@@ -5844,14 +6370,20 @@ write_function_instance(ostream &out, FunctionRemap *remap,
         if (max_num_args == 1) {
           if (min_num_args == 1) {
             indent(out, indent_level)
-              << "if (Dtool_ExtractArg(&" << param_name << ", args, kwds)) {\n";
+              << "if (Dtool_ExtractArg(&" << param_name << ", " << args_expr << ")) {\n";
           } else {
             indent(out, indent_level)
-              << "if (Dtool_ExtractOptionalArg(&" << param_name << ", args, kwds)) {\n";
+              << "if (Dtool_ExtractOptionalArg(&" << param_name << ", " << args_expr << ")) {\n";
           }
         } else if (max_num_args == 0) {
           indent(out, indent_level)
-            << "if (Dtool_CheckNoArgs(args, kwds)) {\n";
+            << "if (Dtool_CheckNoArgs(" << (fastcall ? "nargs, kwnames" : "args, kwds") << ")) {\n";
+        } else if (fastcall) {
+          clear_error = true;
+          indent(out, indent_level)
+            << "if (Dtool_ParseFastcallArgs(args, nargs, kwnames, nullptr, nullptr, \""
+            << string(min_num_args, 'O') << "|" << string(max_num_args - min_num_args, 'O')
+            << ":" << method_name << "\"" << parameter_list << ")) {\n";
         } else {
           clear_error = true;
           indent(out, indent_level)
@@ -5861,6 +6393,13 @@ write_function_instance(ostream &out, FunctionRemap *remap,
             << parameter_list << ")) {\n";
         }
 
+      } else if (fastcall) {
+        clear_error = true;
+        indent(out, indent_level)
+          << "if (Dtool_ParseFastcallArgs(args, nargs, kwnames, nullptr, nullptr, \""
+          << format_specifiers << ":" << method_name
+          << "\"" << parameter_list << ")) {\n";
+
       } else {
         clear_error = true;
         indent(out, indent_level)
@@ -5874,15 +6413,29 @@ write_function_instance(ostream &out, FunctionRemap *remap,
       break;
 
     case AT_varargs:
-      // Wrapper takes a varargs tuple.
+      // Wrapper takes a varargs tuple.  If it is a fastcall wrapper, we have
+      // already made sure that there are no keyword arguments.
       if (only_pyobjects) {
         // All parameters are PyObject*, so we can use the slightly more
         // efficient PyArg_UnpackTuple function instead.
         if (min_num_args == 1 && max_num_args == 1) {
+          if (fastcall) {
+            indent(out, indent_level)
+              << "if (nargs == 1) {\n";
+            indent(out, indent_level + 2)
+              << param_name << " = args[0];\n";
+          } else {
+            indent(out, indent_level)
+              << "if (PyTuple_GET_SIZE(args) == 1) {\n";
+            indent(out, indent_level + 2)
+              << param_name << " = PyTuple_GET_ITEM(args, 0);\n";
+          }
+        } else if (fastcall) {
+          clear_error = true;
           indent(out, indent_level)
-            << "if (PyTuple_GET_SIZE(args) == 1) {\n";
-          indent(out, indent_level + 2)
-            << param_name << " = PyTuple_GET_ITEM(args, 0);\n";
+            << "if (Dtool_ParseFastcallArgs(args, nargs, nullptr, nullptr, nullptr, \""
+            << string(min_num_args, 'O') << "|" << string(max_num_args - min_num_args, 'O')
+            << ":" << method_name << "\"" << parameter_list << ")) {\n";
         } else {
           clear_error = true;
           indent(out, indent_level)
@@ -5892,6 +6445,13 @@ write_function_instance(ostream &out, FunctionRemap *remap,
             << parameter_list << ")) {\n";
         }
 
+      } else if (fastcall) {
+        clear_error = true;
+        indent(out, indent_level)
+          << "if (Dtool_ParseFastcallArgs(args, nargs, nullptr, nullptr, nullptr, \""
+          << format_specifiers << ":" << method_name
+          << "\"" << parameter_list << ")) {\n";
+
       } else {
         clear_error = true;
         indent(out, indent_level)
@@ -5938,6 +6498,11 @@ write_function_instance(ostream &out, FunctionRemap *remap,
     indent_level += 2;
   }
 
+  if (!remember_overload.empty()) {
+    // The arguments are accepted; remember this for the next call.
+    indent(out, indent_level) << remember_overload << "\n";
+  }
+
   if (is_constructor && !remap->_has_this &&
       (remap->_flags & FunctionRemap::F_explicit_self) != 0) {
     // If we'll be passing "self" to the constructor, we need to pre-
@@ -5976,6 +6541,22 @@ write_function_instance(ostream &out, FunctionRemap *remap,
 
   string return_expr;
 
+  int stats_index = 0;
+  if (gil_telemetry) {
+    // Keep track of how long the call takes, so we can tell which functions
+    // would benefit from releasing the interpreter lock.
+    stats_index = ++_num_call_stats;
+    indent(out, indent_level)
+      << "static Dtool_CallStats call_stats" << stats_index << " = {";
+    ostringstream prototype;
+    remap->write_orig_prototype(prototype, 0);
+    output_quoted(out, 0, prototype.str(), false);
+    out << ", " << (remap->_blocking ? "true" : "false") << ", nullptr, 0, 0, 0};\n";
+    indent(out, indent_level)
+      << "uint64_t call_start" << stats_index
+      << " = Dtool_BeginCall();\n";
+  }
+
   if (remap->_blocking) {
     // With SIMPLE_THREADS, it's important that we never release the
     // interpreter lock.
@@ -6038,16 +6619,6 @@ write_function_instance(ostream &out, FunctionRemap *remap,
     }
   }
 
-  // Clean up any memory we might have allocate for parsing the parameters.
-  while (extra_cleanup.is_text_available()) {
-    string line = extra_cleanup.get_line();
-    if (line.size() == 0 || line[0] == '#') {
-      out << line << "\n";
-    } else {
-      indent(out, indent_level) << line << "\n";
-    }
-  }
-
   if (track_interpreter) {
     indent(out, indent_level) << "in_interpreter = 1;\n";
   }
@@ -6057,12 +6628,28 @@ write_function_instance(ostream &out, FunctionRemap *remap,
       << "Py_BLOCK_THREADS\n";
     out << "#endif  // HAVE_THREADS && !SIMPLE_THREADS\n";
   }
+  if (gil_telemetry) {
+    indent(out, indent_level)
+      << "Dtool_EndCall(call_stats" << stats_index
+      << ", call_start" << stats_index << ");\n";
+  }
+
+  // Clean up any memory we might have allocate for parsing the parameters.
+  // This may call into the Python API, so we must hold the lock again.
+  while (extra_cleanup.is_text_available()) {
+    string line = extra_cleanup.get_line();
+    if (line.size() == 0 || line[0] == '#') {
+      out << line << "\n";
+    } else {
+      indent(out, indent_level) << line << "\n";
+    }
+  }
 
   if (manage_return) {
     // If a constructor returns NULL, that means allocation failed.
     if (remap->_return_type->return_value_needs_management()) {
       indent(out, indent_level) << "if (return_value == nullptr) {\n";
-      if ((return_flags & ~RF_pyobject) == RF_err_null) {
+      if ((return_flags & ~(RF_pyobject | RF_fastcall)) == RF_err_null) {
         // PyErr_NoMemory returns NULL, so allow tail call elimination.
         indent(out, indent_level) << "  return PyErr_NoMemory();\n";
       } else {
@@ -6235,8 +6822,19 @@ write_function_instance(ostream &out, FunctionRemap *remap,
       // Special case for constructor.
       TypeIndex type_index = builder.get_type(TypeManager::unwrap(TypeManager::resolve_type(orig_type)), false);
       const InterrogateType &itype = idb->get_type(type_index);
-      indent(out, indent_level)
-        << "return DTool_PyInit_Finalize(self, (void *)" << return_expr << ", &" << CLASS_PREFIX << make_safe_name(itype.get_scoped_name()) << ", true, false);\n";
+      if (cache_wrappers && TypeManager::is_reference_count(itype._cpptype)) {
+        // Register the new wrapper, so that the object gets this one back
+        // (along with its __dict__) when it is returned to Python later.
+        indent(out, indent_level)
+          << "if (DTool_PyInit_Finalize(self, (void *)" << return_expr << ", &" << CLASS_PREFIX << make_safe_name(itype.get_scoped_name()) << ", true, false) < 0) {\n";
+        indent(out, indent_level) << "  return -1;\n";
+        indent(out, indent_level) << "}\n";
+        indent(out, indent_level) << "Dtool_RememberWrapper(self);\n";
+        indent(out, indent_level) << "return 0;\n";
+      } else {
+        indent(out, indent_level)
+          << "return DTool_PyInit_Finalize(self, (void *)" << return_expr << ", &" << CLASS_PREFIX << make_safe_name(itype.get_scoped_name()) << ", true, false);\n";
+      }
 
     } else if (TypeManager::is_bool(orig_type)) {
       // It's an error return boolean, I guess.  Return 0 on success.
@@ -6576,8 +7174,9 @@ write_make_seq(ostream &out, Object *obj, const std::string &ClassName,
   }
 
   Function *elem_getter = make_seq->_element_getter;
+  bool fastcall = is_fastcall_function(elem_getter);
 
-  if ((elem_getter->_args_type & AT_varargs) == AT_varargs) {
+  if (!fastcall && (elem_getter->_args_type & AT_varargs) == AT_varargs) {
     // Fast way to create a temporary tuple to hold only a single item, under
     // the assumption that the called method doesn't do anything with this
     // tuple other than unpack it (which is a fairly safe assumption to make).
@@ -6593,13 +7192,21 @@ write_make_seq(ostream &out, Object *obj, const std::string &ClassName,
 
   switch (elem_getter->_args_type) {
   case AT_keyword_args:
-    out << "    PyTuple_SET_ITEM(&args, 0, index);\n"
-           "    PyObject *value = " << elem_getter->_name << "(self, (PyObject *)&args, nullptr);\n";
+    if (fastcall) {
+      out << "    PyObject *value = " << elem_getter->_name << "(self, &index, 1, nullptr);\n";
+    } else {
+      out << "    PyTuple_SET_ITEM(&args, 0, index);\n"
+             "    PyObject *value = " << elem_getter->_name << "(self, (PyObject *)&args, nullptr);\n";
+    }
     break;
 
   case AT_varargs:
-    out << "    PyTuple_SET_ITEM(&args, 0, index);\n"
-           "    PyObject *value = " << elem_getter->_name << "(self, (PyObject *)&args);\n";
+    if (fastcall) {
+      out << "    PyObject *value = " << elem_getter->_name << "(self, &index, 1);\n";
+    } else {
+      out << "    PyTuple_SET_ITEM(&args, 0, index);\n"
+             "    PyObject *value = " << elem_getter->_name << "(self, (PyObject *)&args);\n";
+    }
     break;
 
   case AT_single_arg:
@@ -6617,7 +7224,7 @@ write_make_seq(ostream &out, Object *obj, const std::string &ClassName,
     "  }\n"
     "\n";
 
-  if ((elem_getter->_args_type & AT_varargs) == AT_varargs) {
+  if (!fastcall && (elem_getter->_args_type & AT_varargs) == AT_varargs) {
     out << "#if defined(Py_TRACE_REFS) || PY_VERSION_HEX < 0x03090000\n";
     out << "  _Py_ForgetReference((PyObject *)&args);\n";
     out << "#endif\n";
@@ -7031,23 +7638,8 @@ write_getset(ostream &out, Object *obj, Property *property) {
   if (property->_has_this) {
     for (const Function *func : obj->_methods) {
       if (!func->_has_this && func->_ifunc.get_name() == ielem.get_name()) {
-        string flags;
         string fptr = "&" + func->_name;
-        switch (func->_args_type) {
-        case AT_keyword_args:
-          flags = "METH_VARARGS | METH_KEYWORDS";
-          fptr = "(PyCFunction) " + fptr;
-          break;
-        case AT_varargs:
-          flags = "METH_VARARGS";
-          break;
-        case AT_single_arg:
-          flags = "METH_O";
-          break;
-        default:
-          flags = "METH_NOARGS";
-          break;
-        }
+        string flags = get_method_flags(func, fptr);
         out << "  if (self == nullptr) {\n"
             << "    static PyMethodDef def = {\"" << ielem.get_name() << "\", "
             << fptr << ", " << flags << " | METH_STATIC, (const char *)"
@@ -7751,6 +8343,34 @@ is_remap_coercion_possible(FunctionRemap *remap) {
   return false;
 }
 
+/**
+ * Returns true if any of the remap's parameters may reject an argument
+ * because of something about its value that the key of the overload cache
+ * doesn't record: a scoped enum rejects a value of -1, and an array the wrong
+ * format or length of a buffer.  The cache cannot be used for a set of
+ * overloads that includes such a remap.
+ */
+bool InterfaceMakerPythonNative::
+is_remap_value_checked(FunctionRemap *remap) {
+  size_t pn = 0;
+  if (remap->_has_this) {
+    ++pn;
+  }
+  while (pn < remap->_parameters.size()) {
+    ParameterRemap *param = remap->_parameters[pn]._remap;
+    CPPType *type = param->get_new_type();
+
+    if (!param->new_type_is_atomic_string() &&
+        (TypeManager::is_scoped_enum(type) ||
+         TypeManager::is_pointer_to_simple(type))) {
+      return true;
+    }
+    ++pn;
+  }
+
+  return false;
+}
+
 /**
 
  */
@@ -7813,6 +8433,81 @@ DoesInheritFromIsClass(const CPPStructType *inclass, const std::string &name) {
   return false;
 }
 
+/**
+ * Returns the struct module format character of the given element type, if
+ * it is a number that can be exported through the buffer protocol, or NULL
+ * otherwise.
+ */
+const char *InterfaceMakerPythonNative::
+get_buffer_format(CPPType *type) {
+  CPPSimpleType *simple_type = TypeManager::resolve_type(type)->as_simple_type();
+  if (simple_type == nullptr) {
+    return nullptr;
+  }
+
+  bool is_unsigned = (simple_type->_flags & CPPSimpleType::F_unsigned) != 0;
+  switch (simple_type->_type) {
+  case CPPSimpleType::T_char:
+    if (is_unsigned) {
+      return "B";
+    } else if (simple_type->_flags & CPPSimpleType::F_signed) {
+      return "b";
+    } else {
+      return "c";
+    }
+
+  case CPPSimpleType::T_int:
+    if (simple_type->_flags & CPPSimpleType::F_longlong) {
+      return is_unsigned ? "Q" : "q";
+    } else if (simple_type->_flags & CPPSimpleType::F_long) {
+      return is_unsigned ? "L" : "l";
+    } else if (simple_type->_flags & CPPSimpleType::F_short) {
+      return is_unsigned ? "H" : "h";
+    } else {
+      return is_unsigned ? "I" : "i";
+    }
+
+  case CPPSimpleType::T_float:
+    return "f";
+
+  case CPPSimpleType::T_double:
+    // There is no format character for long double.
+    if (simple_type->_flags & CPPSimpleType::F_long) {
+      return nullptr;
+    }
+    return "d";
+
+  default:
+    // This includes bool, since vector<bool> is not stored contiguously.
+    return nullptr;
+  }
+}
+
+/**
+ * Returns true if the function is a method of a vector that is exported
+ * through the buffer protocol, and is one that may reallocate the vector's
+ * storage.  Calling it must be refused while a view of the storage exists.
+ */
+bool InterfaceMakerPythonNative::
+is_vector_resize(Object *obj, FunctionRemap *remap) {
+  if (obj == nullptr || !remap->_has_this ||
+      !TypeManager::is_vector(obj->_itype._cpptype)) {
+    return false;
+  }
+
+  CPPType *element_type = TypeManager::get_template_parameter_type(obj->_itype._cpptype);
+  if (element_type == nullptr || get_buffer_format(element_type) == nullptr) {
+    return false;
+  }
+
+  // Removing elements never moves the remaining ones, but all of these may.
+  string name = remap->_cppfunc->get_local_name();
+  return name == "operator =" || name == "assign" || name == "swap" ||
+         name == "push_back" || name == "emplace_back" ||
+         name == "insert" || name == "emplace" ||
+         name == "resize" || name == "reserve" || name == "shrink_to_fit";
+}
+
 /**
 
  */
@@ -32,10 +32,12 @@ public:
 
 
   virtual void write_prototypes(std::ostream &out, std::ostream *out_h);
+  virtual void write_shard_prototypes(std::ostream &out);
   void write_prototypes_class(std::ostream &out, std::ostream *out_h, Object *obj) ;
   void write_prototypes_class_external(std::ostream &out, Object *obj);
 
   virtual void write_functions(std::ostream &out);
+  virtual void write_function_chunks(std::ostream &out, Chunks &chunks);
 
   virtual void write_module(std::ostream &out, std::ostream *out_h, InterrogateModuleDef *def);
   virtual void write_module_support(std::ostream &out, std::ostream *out_h, InterrogateModuleDef *def);
@@ -118,6 +120,10 @@ private:
 
     // Invert boolean return value.
     RF_invert_bool = 0x8000,
+
+    // The arguments are passed as a vector (args, nargs, kwnames) rather than
+    // as a tuple and a dict.  See -fastcall.
+    RF_fastcall = 0x10000,
   };
 
   class SlottedFunctionDef {
@@ -137,6 +143,10 @@ private:
                                   const SlottedFunctions &slots,
                                   const std::string &slot, const std::string &def = "nullptr");
 
+  bool is_fastcall_function(const Function *func);
+  bool has_vectorcall_constructor(Object *obj);
+  std::string get_method_flags(const Function *func, std::string &fptr);
+
   void write_prototype_for_name(std::ostream &out, Function *func, const std::string &name);
   void write_prototype_for(std::ostream &out, Function *func);
   void write_function_for_top(std::ostream &out, Object *obj, Function *func);
@@ -167,7 +177,8 @@ private:
                                bool coercion_allowed, bool report_errors,
                                ArgsType args_type, int return_flags,
                                bool check_exceptions = true,
-                               const std::string &first_pexpr = std::string());
+                               const std::string &first_pexpr = std::string(),
+                               const std::string &remember_overload = std::string());
 
   void error_return(std::ostream &out, int indent_level, int return_flags);
   void error_raise_return(std::ostream &out, int indent_level, int return_flags,
@@ -182,12 +193,17 @@ private:
 
   void write_class_prototypes(std::ostream &out) ;
   void write_class_declarations(std::ostream &out, std::ostream *out_h, Object *obj);
+  void write_class_definition_macro(std::ostream &out, Object *obj);
+  void write_imports(std::ostream &out, bool is_shard);
   void write_class_details(std::ostream &out, Object *obj);
+  void get_nested_classes(Object *obj, std::vector<Object *> &nested,
+                          std::set<Object *> &written);
 
 public:
   bool is_remap_legal(FunctionRemap *remap);
   int has_coerce_constructor(CPPStructType *type);
   bool is_remap_coercion_possible(FunctionRemap *remap);
+  bool is_remap_value_checked(FunctionRemap *remap);
   bool is_function_legal(Function *func);
   bool is_cpp_type_legal(CPPType *ctype);
   bool isExportThisRun(CPPType *ctype);
@@ -208,7 +224,10 @@ public:
   bool DoesInheritFromIsClass(const CPPStructType * inclass, const std::string &name);
   bool IsPandaTypedObject(CPPStructType * inclass) { return DoesInheritFromIsClass(inclass,"TypedObject"); };
   void write_python_instance(std::ostream &out, int indent_level, const std::string &return_expr, bool owns_memory, const InterrogateType &itype, bool is_const);
+  void write_find_wrapper(std::ostream &out, int indent_level, const std::string &return_expr, const std::string &class_name, bool is_const, const std::string &type_index);
   bool has_get_class_type_function(CPPType *type);
+  static const char *get_buffer_format(CPPType *type);
+  static bool is_vector_resize(Object *obj, FunctionRemap *remap);
   bool has_init_type_function(CPPType *type);
   int NeedsAStrFunction(const InterrogateType &itype_class);
   int NeedsAReprFunction(const InterrogateType &itype_class);
@@ -219,6 +238,9 @@ public:
 
   // stash the forward declarations for this compile pass..
   std::set<CPPType *> _external_imports;
+
+  // used to give each -gil-telemetry counter a unique name.
+  int _num_call_stats = 0;
 };
 
 #endif
@@ -13,6 +13,7 @@
 
 #include "interrogate.h"
 #include "interrogateBuilder.h"
+#include "parseCache.h"
 
 #include "interrogateDatabase.h"
 #include "cppGlobals.h"
@@ -30,7 +31,9 @@ Filename output_code_filename;
 Filename output_include_filename;
 Filename output_data_filename;
 Filename source_file_directory;
+Filename parse_cache_filename;
 string output_data_basename;
+int num_output_shards = 1;
 bool output_module_specific = false;
 bool output_function_pointers = false;
 bool output_function_names = false;
@@ -42,6 +45,10 @@ bool build_c_wrappers = false;
 bool build_python_wrappers = false;
 bool build_python_obj_wrappers = false;
 bool build_python_native = false;
+bool build_python_fastcall = false;
+bool gil_telemetry = false;
+bool lazy_types = false;
+bool cache_wrappers = false;
 bool track_interpreter = false;
 bool save_unique_names = false;
 bool no_database = false;
@@ -58,8 +65,10 @@ static const char *short_options = "I:S:D:F:vh";
 // Long command-line options.
 enum CommandOptions {
   CO_oc = 256,
+  CO_oc_shards,
   CO_od,
   CO_srcdir,
+  CO_parse_cache,
   CO_module,
   CO_library,
   CO_do_module,
@@ -73,6 +82,10 @@ enum CommandOptions {
   CO_python,
   CO_python_obj,
   CO_python_native,
+  CO_fastcall,
+  CO_gil_telemetry,
+  CO_lazy_types,
+  CO_cache_wrappers,
   CO_track_interpreter,
   CO_unique_names,
   CO_nodb,
@@ -86,8 +99,10 @@ enum CommandOptions {
 
 static struct option long_options[] = {
   { "oc", required_argument, nullptr, CO_oc },
+  { "oc-shards", required_argument, nullptr, CO_oc_shards },
   { "od", required_argument, nullptr, CO_od },
   { "srcdir", required_argument, nullptr, CO_srcdir },
+  { "parse-cache", required_argument, nullptr, CO_parse_cache },
   { "module", required_argument, nullptr, CO_module },
   { "library", required_argument, nullptr, CO_library },
   { "do-module", no_argument, nullptr, CO_do_module },
@@ -101,6 +116,10 @@ static struct option long_options[] = {
   { "python", no_argument, nullptr, CO_python },
   { "python-obj", no_argument, nullptr, CO_python_obj },
   { "python-native", no_argument, nullptr, CO_python_native },
+  { "fastcall", no_argument, nullptr, CO_fastcall },
+  { "gil-telemetry", no_argument, nullptr, CO_gil_telemetry },
+  { "lazy-types", no_argument, nullptr, CO_lazy_types },
+  { "cache-wrappers", no_argument, nullptr, CO_cache_wrappers },
   { "track-interpreter", no_argument, nullptr, CO_track_interpreter },
   { "unique-names", no_argument, nullptr, CO_unique_names },
   { "nodb", no_argument, nullptr, CO_nodb },
@@ -145,6 +164,13 @@ void show_help() {
     << "        This includes all of the function wrappers, as well as those tables\n"
     << "        which must be compiled into the library.\n\n"
 
+    << "  -oc-shards count\n"
+    << "        Split the generated code over this many files, so that they can be\n"
+    << "        compiled in parallel.  The first is the file given by -oc, and the\n"
+    << "        others are named after it, so that -oc-shards 3 with -oc output.C\n"
+    << "        also writes output_1.C and output_2.C.  Only the Python native\n"
+    << "        wrappers for classes are split; the rest stays in the first file.\n\n"
+
     << "  -od output.in\n"
     << "        Specify the name of the file to which the non-compiled data tables\n"
     << "        will be written.  This file describes the relationships between\n"
@@ -157,6 +183,13 @@ void show_help() {
     << "        Specify the name of the directory to which the source filenames are\n"
     << "        relative.\n\n"
 
+    << "  -parse-cache cache_file\n"
+    << "        Record in the given file a hash of the command line and of the\n"
+    << "        contents of every file read or written by this run.  If a later\n"
+    << "        run with the same command line finds that none of them has changed,\n"
+    << "        it leaves the output files alone instead of parsing all of the\n"
+    << "        headers again.\n\n"
+
     << "  -module module_name\n"
     << "        Defines the name of the module this data is associated with.  This\n"
     << "        is strictly a code-organizational tool.  Conceptually, a module is\n"
@@ -252,6 +285,34 @@ void show_help() {
     << "        python objects, with all methods converted to Python methods.  This\n"
     << "        is currently experimental.\n\n"
 
+    << "  -fastcall\n"
+    << "        In conjunction with -python-native, generate wrappers that use the\n"
+    << "        METH_FASTCALL calling convention, receiving their arguments as a\n"
+    << "        vector rather than as a tuple and a dict, and give classes a\n"
+    << "        vectorcall constructor.  This avoids allocating these objects for\n"
+    << "        every call.  The generated code requires Python 3.7 or later.\n\n"
+
+    << "  -gil-telemetry\n"
+    << "        In conjunction with -python-native, generate code that measures how\n"
+    << "        long each wrapped C++ call runs, and whether it held the Python\n"
+    << "        interpreter lock while doing so.  The numbers may be retrieved\n"
+    << "        with the _gil_telemetry() function added to the module, and are\n"
+    << "        useful to decide which calls to mark as blocking.\n\n"
+
+    << "  -lazy-types\n"
+    << "        In conjunction with -python-native, don't initialize the classes\n"
+    << "        when the module is imported, but only when they are first accessed\n"
+    << "        as attributes of the module, or when an instance of one is first\n"
+    << "        created.  This speeds up importing modules with many classes.\n"
+    << "        Requires Python 3.7 or later; earlier versions ignore it.\n\n"
+
+    << "  -cache-wrappers\n"
+    << "        In conjunction with -python-native, make the generated code return\n"
+    << "        the existing Python wrapper of a reference-counted object if there\n"
+    << "        is one, rather than creating a new wrapper each time the object is\n"
+    << "        passed to Python.  This preserves the identity of the object, as\n"
+    << "        well as any attributes set on an instance of a Python subclass.\n\n"
+
     << "  Any combination of -c, -python, or -python-obj may be specified.  If all\n"
     << "  are omitted, the default is -c.\n\n"
 
@@ -358,6 +419,10 @@ main(int argc, char **argv) {
       output_code_filename.make_absolute();
       break;
 
+    case CO_oc_shards:
+      num_output_shards = std::max(atoi(optarg), 1);
+      break;
+
     case CO_od:
       output_data_filename = Filename::from_os_specific(optarg);
       output_data_filename.make_absolute();
@@ -368,6 +433,11 @@ main(int argc, char **argv) {
       source_file_directory.make_absolute();
       break;
 
+    case CO_parse_cache:
+      parse_cache_filename = Filename::from_os_specific(optarg);
+      parse_cache_filename.make_absolute();
+      break;
+
     case CO_module:
       module_name = optarg;
       break;
@@ -420,6 +490,22 @@ main(int argc, char **argv) {
         build_python_native = true;
         break;
 
+    case CO_fastcall:
+      build_python_fastcall = true;
+      break;
+
+    case CO_gil_telemetry:
+      gil_telemetry = true;
+      break;
+
+    case CO_lazy_types:
+      lazy_types = true;
+      break;
+
+    case CO_cache_wrappers:
+      cache_wrappers = true;
+      break;
+
     case CO_track_interpreter:
       track_interpreter = true;
       break;
@@ -502,6 +588,22 @@ main(int argc, char **argv) {
     build_c_wrappers = true;
   }
 
+  // If nothing has changed since the last run, there's no need to do it all
+  // over again.
+  ParseCache parse_cache(parse_cache_filename);
+  if (!parse_cache_filename.empty()) {
+    parse_cache.set_command_line(command_line);
+    if (parse_cache.is_up_to_date()) {
+      if (parser.get_verbose() > 1) {
+        nout << "Output files are up-to-date according to "
+             << parse_cache_filename << "\n";
+      }
+      parse_cache.touch_outputs();
+      return 0;
+    }
+    parser._record_include_probes = true;
+  }
+
   // Add all of the .h files we are explicitly including to the parser.
   for (i = 1; i < argc; ++i) {
     Filename filename = Filename::from_os_specific(argv[i]);
@@ -533,6 +635,7 @@ main(int argc, char **argv) {
     Filename nfilename = filename;
     nfilename.set_extension("N");
     nfilename.set_text();
+    parse_cache.add_input(nfilename);
     pifstream nfile;
     if (nfilename.open_read(nfile)) {
       builder.read_command_file(nfile);
@@ -576,6 +679,19 @@ main(int argc, char **argv) {
 
   int status = 0;
 
+  // If the code is to be split over several files, the others are named
+  // after the first one.
+  std::vector<Filename> shard_filenames;
+  if (!output_code_filename.empty()) {
+    for (i = 1; i < num_output_shards; ++i) {
+      Filename shard_filename(output_code_filename.get_fullpath_wo_extension() +
+                              "_" + std::to_string(i) + "." +
+                              output_code_filename.get_extension());
+      shard_filename.set_text();
+      shard_filenames.push_back(shard_filename);
+    }
+  }
+
   // Now output all of the wrapper functions.
   if (!output_code_filename.empty())
   {
@@ -589,6 +705,24 @@ main(int argc, char **argv) {
       << " *\n"
       << " */\n\n";
 
+    std::vector<pofstream> output_shards(shard_filenames.size());
+    std::vector<std::ostream *> out_shards;
+    for (size_t si = 0; si < shard_filenames.size(); ++si) {
+      shard_filenames[si].open_write(output_shards[si]);
+      output_shards[si]
+        << "/*\n"
+        << " * This file was generated by:\n"
+        << " * " << command_line << "\n"
+        << " *\n"
+        << " */\n\n";
+
+      if (output_shards[si].fail()) {
+        nout << "Unable to write to " << shard_filenames[si] << "\n";
+        status = -1;
+      }
+      out_shards.push_back(&output_shards[si]);
+    }
+
     if(the_output_include != nullptr)
     {
         output_code << "#include \""<<output_include_filename<<"\"\n";
@@ -598,8 +732,8 @@ main(int argc, char **argv) {
     if (output_code.fail()) {
       nout << "Unable to write to " << output_code_filename << "\n";
       status = -1;
-    } else {
-      builder.write_code(output_code,the_output_include, def);
+    } else if (status == 0) {
+      builder.write_code(output_code,the_output_include, def, out_shards);
     }
   }
 
@@ -620,5 +754,25 @@ main(int argc, char **argv) {
     }
   }
 
+  if (status == 0 && !parse_cache_filename.empty()) {
+    CPPParser::ParsedFiles::const_iterator fi;
+    for (fi = parser._parsed_files.begin(); fi != parser._parsed_files.end(); ++fi) {
+      parse_cache.add_input((*fi)._filename);
+    }
+    for (const std::string &probe : parser._include_probes) {
+      parse_cache.add_input(probe);
+    }
+    if (!output_code_filename.empty()) {
+      parse_cache.add_output(output_code_filename);
+    }
+    for (const Filename &shard_filename : shard_filenames) {
+      parse_cache.add_output(shard_filename);
+    }
+    if (!output_data_filename.empty()) {
+      parse_cache.add_output(output_data_filename);
+    }
+    parse_cache.write();
+  }
+
   return status;
 }
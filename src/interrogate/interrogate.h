@@ -26,6 +26,7 @@ extern CPPParser parser;
 extern Filename output_code_filename;
 extern Filename output_data_filename;
 extern std::string output_data_basename;
+extern int num_output_shards;
 extern bool output_module_specific;
 extern bool output_function_pointers;
 extern bool output_function_names;
@@ -37,6 +38,10 @@ extern bool build_c_wrappers;
 extern bool build_python_wrappers;
 extern bool build_python_obj_wrappers;
 extern bool build_python_native;
+extern bool build_python_fastcall;
+extern bool gil_telemetry;
+extern bool lazy_types;
+extern bool cache_wrappers;
 extern bool track_interpreter;
 extern bool save_unique_names;
 extern bool no_database;
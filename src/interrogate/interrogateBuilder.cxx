@@ -212,6 +212,26 @@ do_command(const string &command, const string &params) {
   } else if (command == "noinclude") {
     insert_param_list(_noinclude, params);
 
+  } else if (command == "blockingtype") {
+    // blockingtype releases the interpreter lock around every method of the
+    // given type, as if each one had been marked BLOCKING.
+    CPPType *type = parser.parse_type(params);
+    if (type == nullptr) {
+      nout << "Unknown type: blockingtype " << params << "\n";
+    } else {
+      type = type->resolve_type(&parser, &parser);
+      _blockingtype.insert(type->get_local_name(&parser));
+    }
+
+  } else if (command == "blockingfile") {
+    insert_param_list(_blockingfile, params);
+
+  } else if (command == "blockingall") {
+    _blockingall = true;
+
+  } else if (command == "nonblocking") {
+    insert_param_list(_nonblocking, params);
+
   } else if (command == "forceinclude") {
     size_t nchars = params.size();
     if (nchars >= 2 && params[0] == '"' && params[nchars-1] == '"') {
@@ -326,10 +346,14 @@ build() {
 }
 
 /**
- * Generates all the code necessary to the indicated output stream.
+ * Generates all the code necessary to the indicated output stream.  If
+ * out_shards is not empty, the wrappers for the classes are distributed
+ * evenly over out_code and the streams in out_shards, so that they can be
+ * compiled in parallel; everything else goes to out_code.
  */
 void InterrogateBuilder::
-write_code(ostream &out_code,ostream * out_include, InterrogateModuleDef *def) {
+write_code(ostream &out_code, ostream *out_include, InterrogateModuleDef *def,
+           const std::vector<ostream *> &out_shards) {
   typedef std::vector<InterfaceMaker *> InterfaceMakers;
   InterfaceMakers makers;
 
@@ -368,31 +392,40 @@ write_code(ostream &out_code,ostream * out_include, InterrogateModuleDef *def) {
   // generating these first, we ensure that we know all of the pointers we'll
   // be using ahead of time (and can therefore generate correct prototypes).
   ostringstream function_bodies;
+  InterfaceMaker::Chunks chunks;
   for (mi = makers.begin(); mi != makers.end(); ++mi) {
-    (*mi)->write_functions(function_bodies);
+    if (out_shards.empty()) {
+      (*mi)->write_functions(function_bodies);
+    } else {
+      (*mi)->write_function_chunks(function_bodies, chunks);
+    }
   }
 
   // Now, begin the actual output.  Start with the #include lines.
+  ostringstream include_lines;
   if (!no_database) {
-    out_code << "#include \"dtoolbase.h\"\n"
-             << "#include \"interrogate_request.h\"\n"
-             << "#include \"dconfig.h\"\n";
+    include_lines << "#include \"dtoolbase.h\"\n"
+                  << "#include \"interrogate_request.h\"\n"
+                  << "#include \"dconfig.h\"\n";
   }
+  out_code << include_lines.str();
 
-  ostringstream declaration_bodies;
+  // These declarations are needed by every output file, if there is more than
+  // one.
+  ostringstream common_declarations;
 
   if (watch_asserts) {
-    declaration_bodies << "#include \"pnotify.h\"\n";
+    common_declarations << "#include \"pnotify.h\"\n";
   }
 
-  declaration_bodies << "#include <sstream>\n";
+  common_declarations << "#include <sstream>\n";
 
   if (build_python_native) {
-    declaration_bodies << "#include \"py_panda.h\"\n";
-    declaration_bodies << "#include \"extension.h\"\n";
-    declaration_bodies << "#include \"dcast.h\"\n";
+    common_declarations << "#include \"py_panda.h\"\n";
+    common_declarations << "#include \"extension.h\"\n";
+    common_declarations << "#include \"dcast.h\"\n";
   }
-  declaration_bodies << "\n";
+  common_declarations << "\n";
 
   IncludeFiles::const_iterator ifi;
   for (ifi = _include_files.begin();
@@ -402,22 +435,28 @@ write_code(ostream &out_code,ostream * out_include, InterrogateModuleDef *def) {
     char delimiter = (*ifi).second;
     if (should_include(filename)) {
       if (delimiter == '"') {
-        declaration_bodies << "#include \"" << filename << "\"\n";
+        common_declarations << "#include \"" << filename << "\"\n";
       } else {
-        declaration_bodies << "#include <" << filename << ">\n";
+        common_declarations << "#include <" << filename << ">\n";
       }
     }
   }
-  declaration_bodies << "\n";
+  common_declarations << "\n";
 
   for (mi = makers.begin(); mi != makers.end(); ++mi) {
-    (*mi)->write_includes(declaration_bodies);
+    (*mi)->write_includes(common_declarations);
   }
 
   if (generate_spam) {
-    declaration_bodies << "#include \"config_interrogatedb.h\"\n"
+    common_declarations << "#include \"config_interrogatedb.h\"\n"
         << "#include \"notifyCategoryProxy.h\"\n\n"
-        << "NotifyCategoryDeclNoExport(in_" << library_name << ");\n"
+        << "NotifyCategoryDeclNoExport(in_" << library_name << ");\n";
+  }
+  out_code << common_declarations.str();
+
+  ostringstream declaration_bodies;
+  if (generate_spam) {
+    declaration_bodies
         << "NotifyCategoryDef(in_" << library_name << ", interrogatedb_cat);\n\n";
   }
 
@@ -432,8 +471,39 @@ write_code(ostream &out_code,ostream * out_include, InterrogateModuleDef *def) {
 // if(out_include != NULL) (*out_include) << declaration_bodies.str(); else
   out_code << declaration_bodies.str();
 
-  // Followed by the function bodies.
-  out_code << function_bodies.str() << "\n";
+  if (out_shards.empty()) {
+    // Followed by the function bodies.
+    out_code << function_bodies.str() << "\n";
+
+  } else {
+    // Divide the chunks over the output files, keeping them in order, so that
+    // each file gets about the same amount of code.  The first file already
+    // has the global functions.
+    size_t num_files = out_shards.size() + 1;
+    size_t total_size = function_bodies.str().size();
+    for (const string &chunk : chunks) {
+      total_size += chunk.size();
+    }
+
+    std::vector<string> shard_bodies(num_files);
+    size_t size_so_far = function_bodies.str().size();
+    for (const string &chunk : chunks) {
+      size_t fi = std::min(size_so_far * num_files / (total_size + 1), num_files - 1);
+      shard_bodies[fi] += chunk;
+      size_so_far += chunk.size();
+    }
+
+    out_code << function_bodies.str() << shard_bodies[0] << "\n";
+
+    for (size_t si = 0; si < out_shards.size(); ++si) {
+      ostream &out_shard = *out_shards[si];
+      out_shard << include_lines.str() << common_declarations.str() << "\n";
+      for (mi = makers.begin(); mi != makers.end(); ++mi) {
+        (*mi)->write_shard_prototypes(out_shard);
+      }
+      out_shard << "\n" << shard_bodies[si + 1] << "\n";
+    }
+  }
 
   for (mi = makers.begin(); mi != makers.end(); ++mi) {
     (*mi)->write_module_support(out_code, out_include, def);
@@ -873,6 +943,34 @@ in_noinclude(const string &name) const {
   return (_noinclude.count(name) != 0);
 }
 
+/**
+ * Returns true if the indicated name is one that the user identified with a
+ * blockingtype command.
+ */
+bool InterrogateBuilder::
+in_blockingtype(const string &name) const {
+  return (_blockingtype.count(name) != 0);
+}
+
+/**
+ * Returns true if the indicated filename is one that the user identified with
+ * a blockingfile command.
+ */
+bool InterrogateBuilder::
+in_blockingfile(const string &name) const {
+  return (_blockingfile.count(name) != 0);
+}
+
+/**
+ * Returns true if the indicated function name is one that the user identified
+ * with a nonblocking command.  This may be either the simple name or the name
+ * qualified with its class scope.
+ */
+bool InterrogateBuilder::
+in_nonblocking(const string &name) const {
+  return (_nonblocking.count(name) != 0);
+}
+
 /**
  * Returns true if the indicated filename is a valid file to explicitly
  * #include in the generated .cxx file, false otherwise.
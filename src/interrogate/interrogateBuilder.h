@@ -56,7 +56,8 @@ public:
   void read_command_file(std::istream &in);
   void do_command(const std::string &command, const std::string &params);
   void build();
-  void write_code(std::ostream &out_code, std::ostream *out_include, InterrogateModuleDef *def);
+  void write_code(std::ostream &out_code, std::ostream *out_include, InterrogateModuleDef *def,
+                  const std::vector<std::ostream *> &out_shards = std::vector<std::ostream *>());
   InterrogateModuleDef *make_module_def(int file_identifier);
 
   static std::string clean_identifier(const std::string &name);
@@ -82,6 +83,9 @@ public:
   bool in_ignorefile(const std::string &name) const;
   bool in_ignoremember(const std::string &name) const;
   bool in_noinclude(const std::string &name) const;
+  bool in_blockingtype(const std::string &name) const;
+  bool in_blockingfile(const std::string &name) const;
+  bool in_nonblocking(const std::string &name) const;
   bool should_include(const std::string &filename) const;
 
   bool is_inherited_published(CPPInstance *function, CPPStructType *struct_type);
@@ -156,6 +160,10 @@ public:
   Commands _ignorefile;
   Commands _ignoremember;
   Commands _noinclude;
+  Commands _blockingtype;
+  Commands _blockingfile;
+  Commands _nonblocking;
+  bool _blockingall = false;
 
   std::string _library_hash_name;
 
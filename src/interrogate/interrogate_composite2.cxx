@@ -16,4 +16,5 @@
 #include "parameterRemapToString.cxx"
 #include "parameterRemapHandleToInt.cxx"
 #include "parameterRemapUnchanged.cxx"
+#include "parseCache.cxx"
 
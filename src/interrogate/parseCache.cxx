@@ -0,0 +1,220 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file parseCache.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "parseCache.h"
+#include "executionEnvironment.h"
+#include "pnotify.h"
+
+#include <sstream>
+
+using std::string;
+
+static const uint64_t hash_offset_basis = 14695981039346656037ULL;
+
+/**
+ *
+ */
+ParseCache::
+ParseCache(const Filename &filename) :
+  _filename(filename),
+  _command_hash(0)
+{
+  _filename.set_text();
+}
+
+/**
+ * Sets the command line that interrogate was invoked with.  A cache written
+ * by a run with a different command line, or by a different build of
+ * interrogate, is never considered up-to-date.
+ */
+void ParseCache::
+set_command_line(const string &command_line) {
+  _command_hash = hash_bytes(hash_offset_basis, command_line.data(), command_line.size());
+
+  Filename binary = ExecutionEnvironment::get_binary_name();
+  uint64_t binary_hash = 0;
+  if (!binary.empty() && hash_file(binary, binary_hash)) {
+    _command_hash ^= binary_hash;
+  }
+}
+
+/**
+ * Records a file that was read in the course of this run, ie. a header or a
+ * .N file.
+ */
+void ParseCache::
+add_input(const Filename &filename) {
+  Filename fullpath(filename);
+  fullpath.make_absolute();
+  _inputs.insert(fullpath.get_fullpath());
+}
+
+/**
+ * Records a file that was written in the course of this run.
+ */
+void ParseCache::
+add_output(const Filename &filename) {
+  Filename fullpath(filename);
+  fullpath.make_absolute();
+  _outputs.insert(fullpath.get_fullpath());
+}
+
+/**
+ * Returns true if the cache file was written by a previous run with the same
+ * command line, and none of the files it read or wrote have changed since.
+ * In that case, running again would produce the same output.
+ *
+ * The output files listed in the cache file are remembered, so that they can
+ * be passed to touch_outputs().
+ */
+bool ParseCache::
+is_up_to_date() {
+  _outputs.clear();
+
+  pifstream in;
+  if (!_filename.open_read(in)) {
+    return false;
+  }
+
+  string line;
+  if (!std::getline(in, line) || line != get_header()) {
+    return false;
+  }
+
+  int num_outputs = 0;
+  while (std::getline(in, line)) {
+    // Each line has the form "in|out hash filename".
+    size_t sp1 = line.find(' ');
+    size_t sp2 = line.find(' ', sp1 + 1);
+    if (sp1 == string::npos || sp2 == string::npos) {
+      return false;
+    }
+
+    string kind = line.substr(0, sp1);
+    string filename = line.substr(sp2 + 1);
+    if (kind == "out") {
+      ++num_outputs;
+      _outputs.insert(filename);
+    } else if (kind != "in") {
+      return false;
+    }
+
+    string hash = get_hash_string(Filename(filename));
+    if (line.compare(sp1 + 1, sp2 - sp1 - 1, hash) != 0) {
+      return false;
+    }
+  }
+
+  // A cache that doesn't list any outputs was written by a run that failed
+  // somewhere along the way.
+  return num_outputs > 0;
+}
+
+/**
+ * Updates the modification time of each of the output files, after
+ * is_up_to_date() has returned true.  Since their contents haven't changed,
+ * they would otherwise look older than the inputs that were touched since the
+ * last run, and a build system would keep running interrogate to remake them.
+ */
+void ParseCache::
+touch_outputs() const {
+  Files::const_iterator fi;
+  for (fi = _outputs.begin(); fi != _outputs.end(); ++fi) {
+    Filename(*fi).touch();
+  }
+}
+
+/**
+ * Writes the cache file, with the hashes of the files that were added by
+ * add_input() and add_output().  Returns true on success.
+ */
+bool ParseCache::
+write() const {
+  pofstream out;
+  if (!_filename.open_write(out)) {
+    nout << "Unable to write to " << _filename << "\n";
+    return false;
+  }
+
+  out << get_header() << "\n";
+
+  Files::const_iterator fi;
+  for (fi = _inputs.begin(); fi != _inputs.end(); ++fi) {
+    out << "in " << get_hash_string(Filename(*fi)) << " " << *fi << "\n";
+  }
+  for (fi = _outputs.begin(); fi != _outputs.end(); ++fi) {
+    out << "out " << get_hash_string(Filename(*fi)) << " " << *fi << "\n";
+  }
+
+  return !out.fail();
+}
+
+/**
+ * Computes a hash of the contents of the indicated file.  Returns false if
+ * the file could not be read.
+ */
+bool ParseCache::
+hash_file(const Filename &filename, uint64_t &hash) {
+  Filename binary_filename(filename);
+  binary_filename.set_binary();
+
+  pifstream in;
+  if (!binary_filename.open_read(in)) {
+    return false;
+  }
+
+  hash = hash_offset_basis;
+  char buffer[65536];
+  while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+    hash = hash_bytes(hash, buffer, (size_t)in.gcount());
+  }
+  return !in.bad();
+}
+
+/**
+ * Returns the hash of the contents of the indicated file as it is written to
+ * the cache file, or "-" if the file does not exist.  A missing file is worth
+ * recording too, since creating it could change the output.
+ */
+string ParseCache::
+get_hash_string(const Filename &filename) {
+  uint64_t hash;
+  if (!hash_file(filename, hash)) {
+    return "-";
+  }
+  std::ostringstream strm;
+  strm << std::hex << hash;
+  return strm.str();
+}
+
+/**
+ * Folds the given bytes into the hash, using the 64-bit FNV-1a algorithm.
+ */
+uint64_t ParseCache::
+hash_bytes(uint64_t hash, const char *data, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ (unsigned char)data[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+/**
+ * Returns the first line of the cache file, which identifies the format and
+ * the command line.
+ */
+string ParseCache::
+get_header() const {
+  std::ostringstream strm;
+  strm << "interrogate-cache 1 " << std::hex << _command_hash;
+  return strm.str();
+}
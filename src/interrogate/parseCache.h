@@ -0,0 +1,62 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file parseCache.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#include "dtoolbase.h"
+#include "filename.h"
+#include "numeric_types.h"
+
+#include <set>
+
+/**
+ * Records everything a run of interrogate depended on, so that a later run
+ * can find out that it would produce the same output, and skip parsing the
+ * headers altogether.
+ *
+ * The cache file stores a hash of the command line, which includes the
+ * defines and the include path, and of the interrogate executable, along
+ * with a hash of the contents of each file that was read or written.  Each
+ * place the preprocessor looked for an #include file is recorded as well,
+ * even if there was no file there, so that a header that appears earlier on
+ * the include path than the one that was used is noticed.
+ */
+class ParseCache {
+public:
+  ParseCache(const Filename &filename);
+
+  void set_command_line(const std::string &command_line);
+  void add_input(const Filename &filename);
+  void add_output(const Filename &filename);
+
+  bool is_up_to_date();
+  void touch_outputs() const;
+  bool write() const;
+
+private:
+  static bool hash_file(const Filename &filename, uint64_t &hash);
+  static std::string get_hash_string(const Filename &filename);
+  static uint64_t hash_bytes(uint64_t hash, const char *data, size_t size);
+
+  std::string get_header() const;
+
+  Filename _filename;
+  uint64_t _command_hash;
+
+  typedef std::set<std::string> Files;
+  Files _inputs;
+  Files _outputs;
+};
+
+#endif
@@ -32,38 +32,25 @@
 
 using std::string;
 
+TypeManager::TypeCache TypeManager::_type_cache;
+
 /**
- * A horrible hack around a CPPParser bug.  We don't trust the CPPType pointer
- * we were given; instead, we ask CPPParser to parse a new type of the same
- * name.  This has a better chance of fully resolving templates.
+ * Returns the fully resolved version of the indicated type, as seen from the
+ * indicated scope, or from the global scope if none is given.  The result for
+ * the global scope is remembered for each type, since this is asked for the
+ * same types over and over while generating code.
  */
 CPPType *TypeManager::
 resolve_type(CPPType *type, CPPScope *scope) {
-  if (scope == nullptr) {
-    scope = &parser;
-  }
-
-  //CPPType *orig_type = type;
-  type = type->resolve_type(scope, &parser);
-  string name = type->get_local_name(&parser);
-  if (name.empty()) {
-    // Don't try to resolve unnamed types.
-    return type;
+  if (scope != nullptr && scope != &parser) {
+    return type->resolve_type(scope, &parser);
   }
 
-  // I think I fixed the bug; no need for the below hack any more.
-  return type;
-
-/*
-  CPPType *new_type = parser.parse_type(name);
-  if (new_type == (CPPType *)NULL) {
-    nout << "Type \"" << name << "\" (from " << *orig_type << ") is unknown to parser.\n";
-  } else {
-    type = new_type->resolve_type(&parser, &parser);
+  TypeProperties &props = _type_cache[type];
+  if (props._resolved_type == nullptr) {
+    props._resolved_type = type->resolve_type(&parser, &parser);
   }
-
-  return type;
-*/
+  return props._resolved_type;
 }
 
 /**
@@ -758,6 +745,14 @@ is_const_unsigned_char_pointer(CPPType *type) {
  */
 bool TypeManager::
 is_basic_string_char(CPPType *type) {
+  return get_property(type, P_basic_string_char, &r_is_basic_string_char);
+}
+
+/**
+ * The recursive implementation of is_basic_string_char().
+ */
+bool TypeManager::
+r_is_basic_string_char(CPPType *type) {
   CPPType *string_type = get_basic_string_char_type();
   if (string_type != nullptr &&
       string_type->get_local_name(&parser) == type->get_local_name(&parser)) {
@@ -906,6 +901,14 @@ is_wchar_pointer(CPPType *type) {
  */
 bool TypeManager::
 is_basic_string_wchar(CPPType *type) {
+  return get_property(type, P_basic_string_wchar, &r_is_basic_string_wchar);
+}
+
+/**
+ * The recursive implementation of is_basic_string_wchar().
+ */
+bool TypeManager::
+r_is_basic_string_wchar(CPPType *type) {
   CPPType *string_type = get_basic_string_wchar_type();
   if (string_type != nullptr &&
       string_type->get_local_name(&parser) == type->get_local_name(&parser)) {
@@ -1006,6 +1009,14 @@ is_wstring(CPPType *type) {
  */
 bool TypeManager::
 is_vector_unsigned_char(CPPType *type) {
+  return get_property(type, P_vector_unsigned_char, &r_is_vector_unsigned_char);
+}
+
+/**
+ * The recursive implementation of is_vector_unsigned_char().
+ */
+bool TypeManager::
+r_is_vector_unsigned_char(CPPType *type) {
   if (type->get_local_name(&parser) == "vector< unsigned char >" ||
       type->get_local_name(&parser) == "std::vector< unsigned char >" ||
       type->get_local_name(&parser) == "pvector< unsigned char >") {
@@ -1170,6 +1181,14 @@ is_unsigned_integer(CPPType *type) {
  */
 bool TypeManager::
 is_size(CPPType *type) {
+  return get_property(type, P_size, &r_is_size);
+}
+
+/**
+ * The recursive implementation of is_size().
+ */
+bool TypeManager::
+r_is_size(CPPType *type) {
   switch (type->get_subtype()) {
   case CPPDeclaration::ST_const:
     return is_size(type->as_const_type()->_wrapped_around);
@@ -1196,6 +1215,14 @@ is_size(CPPType *type) {
  */
 bool TypeManager::
 is_ssize(CPPType *type) {
+  return get_property(type, P_ssize, &r_is_ssize);
+}
+
+/**
+ * The recursive implementation of is_ssize().
+ */
+bool TypeManager::
+r_is_ssize(CPPType *type) {
   switch (type->get_subtype()) {
   case CPPDeclaration::ST_const:
     return is_ssize(type->as_const_type()->_wrapped_around);
@@ -1446,6 +1473,14 @@ is_void(CPPType *type) {
  */
 bool TypeManager::
 is_reference_count(CPPType *type) {
+  return get_property(type, P_reference_count, &r_is_reference_count);
+}
+
+/**
+ * The recursive implementation of is_reference_count().
+ */
+bool TypeManager::
+r_is_reference_count(CPPType *type) {
   CPPType *refcount_type = get_reference_count_type();
   if (refcount_type != nullptr &&
       refcount_type->get_local_name(&parser) == type->get_local_name(&parser)) {
@@ -1515,6 +1550,14 @@ is_reference_count_pointer(CPPType *type) {
  */
 bool TypeManager::
 is_pointer_to_base(CPPType *type) {
+  return get_property(type, P_pointer_to_base, &r_is_pointer_to_base);
+}
+
+/**
+ * The recursive implementation of is_pointer_to_base().
+ */
+bool TypeManager::
+r_is_pointer_to_base(CPPType *type) {
   // We only check the simple name of the type against PointerToBase, since we
   // need to allow for the various template instantiations of this thing.
 
@@ -1596,6 +1639,14 @@ is_const_ref_to_pointer_to_base(CPPType *type) {
  */
 bool TypeManager::
 is_pair(CPPType *type) {
+  return get_property(type, P_pair, &r_is_pair);
+}
+
+/**
+ * The recursive implementation of is_pair().
+ */
+bool TypeManager::
+r_is_pair(CPPType *type) {
   // We only check the simple name of the type against pair, since we need to
   // allow for the various template instantiations of this thing.
   if (type->get_simple_name() == "pair") {
@@ -1619,6 +1670,43 @@ is_pair(CPPType *type) {
   return false;
 }
 
+/**
+ * Returns true if the type is vector<>, pvector<> or epvector<>, or a
+ * reference to one of these.
+ */
+bool TypeManager::
+is_vector(CPPType *type) {
+  return get_property(type, P_vector, &r_is_vector);
+}
+
+/**
+ * The recursive implementation of is_vector().
+ */
+bool TypeManager::
+r_is_vector(CPPType *type) {
+  string simple_name = type->get_simple_name();
+  if (simple_name == "vector" || simple_name == "pvector" ||
+      simple_name == "epvector") {
+    return true;
+  }
+
+  switch (type->get_subtype()) {
+  case CPPDeclaration::ST_const:
+    return is_vector(type->as_const_type()->_wrapped_around);
+
+  case CPPDeclaration::ST_reference:
+    return is_vector(type->as_reference_type()->_pointing_at);
+
+  case CPPDeclaration::ST_typedef:
+    return is_vector(type->as_typedef_type()->_type);
+
+  default:
+    break;
+  }
+
+  return false;
+}
+
 /**
  * Returns true if the indicated type is PyObject *.
  */
@@ -1644,6 +1732,14 @@ is_pointer_to_PyObject(CPPType *type) {
  */
 bool TypeManager::
 is_PyObject(CPPType *type) {
+  return get_property(type, P_PyObject, &r_is_PyObject);
+}
+
+/**
+ * The recursive implementation of is_PyObject().
+ */
+bool TypeManager::
+r_is_PyObject(CPPType *type) {
   switch (type->get_subtype()) {
   case CPPDeclaration::ST_const:
     return is_PyObject(type->as_const_type()->_wrapped_around);
@@ -1691,6 +1787,14 @@ is_pointer_to_PyTypeObject(CPPType *type) {
  */
 bool TypeManager::
 is_PyTypeObject(CPPType *type) {
+  return get_property(type, P_PyTypeObject, &r_is_PyTypeObject);
+}
+
+/**
+ * The recursive implementation of is_PyTypeObject().
+ */
+bool TypeManager::
+r_is_PyTypeObject(CPPType *type) {
   switch (type->get_subtype()) {
   case CPPDeclaration::ST_const:
     return is_PyTypeObject(type->as_const_type()->_wrapped_around);
@@ -1731,6 +1835,14 @@ is_pointer_to_PyStringObject(CPPType *type) {
  */
 bool TypeManager::
 is_PyStringObject(CPPType *type) {
+  return get_property(type, P_PyStringObject, &r_is_PyStringObject);
+}
+
+/**
+ * The recursive implementation of is_PyStringObject().
+ */
+bool TypeManager::
+r_is_PyStringObject(CPPType *type) {
   switch (type->get_subtype()) {
   case CPPDeclaration::ST_const:
     return is_PyStringObject(type->as_const_type()->_wrapped_around);
@@ -1767,6 +1879,14 @@ is_pointer_to_PyUnicodeObject(CPPType *type) {
  */
 bool TypeManager::
 is_PyUnicodeObject(CPPType *type) {
+  return get_property(type, P_PyUnicodeObject, &r_is_PyUnicodeObject);
+}
+
+/**
+ * The recursive implementation of is_PyUnicodeObject().
+ */
+bool TypeManager::
+r_is_PyUnicodeObject(CPPType *type) {
   switch (type->get_subtype()) {
   case CPPDeclaration::ST_const:
     return is_PyUnicodeObject(type->as_const_type()->_wrapped_around);
@@ -1806,6 +1926,14 @@ is_pointer_to_Py_buffer(CPPType *type) {
  */
 bool TypeManager::
 is_Py_buffer(CPPType *type) {
+  return get_property(type, P_Py_buffer, &r_is_Py_buffer);
+}
+
+/**
+ * The recursive implementation of is_Py_buffer().
+ */
+bool TypeManager::
+r_is_Py_buffer(CPPType *type) {
   switch (type->get_subtype()) {
   case CPPDeclaration::ST_const:
     return is_Py_buffer(type->as_const_type()->_wrapped_around);
@@ -1829,6 +1957,14 @@ is_Py_buffer(CPPType *type) {
  */
 bool TypeManager::
 is_handle(CPPType *type) {
+  return get_property(type, P_handle, &r_is_handle);
+}
+
+/**
+ * The recursive implementation of is_handle().
+ */
+bool TypeManager::
+r_is_handle(CPPType *type) {
   switch (type->get_subtype()) {
   case CPPDeclaration::ST_const:
     return is_handle(type->as_const_type()->_wrapped_around);
@@ -1849,7 +1985,16 @@ is_handle(CPPType *type) {
 /**
  * Returns true if the indicated type is PyObject.
  */
-bool TypeManager::is_ostream(CPPType *type) {
+bool TypeManager::
+is_ostream(CPPType *type) {
+  return get_property(type, P_ostream, &r_is_ostream);
+}
+
+/**
+ * The recursive implementation of is_ostream().
+ */
+bool TypeManager::
+r_is_ostream(CPPType *type) {
   switch (type->get_subtype()) {
   case CPPDeclaration::ST_const:
     return is_ostream(type->as_const_type()->_wrapped_around);
@@ -2402,6 +2547,14 @@ has_protected_destructor(CPPType *type) {
  */
 bool TypeManager::
 is_exported(CPPType *in_type) {
+  return get_property(in_type, P_exported, &r_is_exported);
+}
+
+/**
+ * The recursive implementation of is_exported().
+ */
+bool TypeManager::
+r_is_exported(CPPType *in_type) {
   string name = in_type->get_local_name(&parser);
   if (name.empty()) {
     return false;
@@ -2570,3 +2723,23 @@ is_local(CPPType *source_type) {
  return false;
  */
 }
+
+/**
+ * Returns the answer to one of the predicates above that is expensive to
+ * compute, such as one that compares type names.  The answer is computed by
+ * the indicated function the first time it is asked for a particular type,
+ * and remembered in the type's TypeProperties thereafter.
+ */
+bool TypeManager::
+get_property(CPPType *type, unsigned int property, bool (*compute)(CPPType *)) {
+  TypeProperties &props = _type_cache[type];
+  if ((props._known & property) == 0) {
+    // This may recurse into get_property() for other types, which may add
+    // entries to the cache, but that does not move the existing entries.
+    if ((*compute)(type)) {
+      props._value |= property;
+    }
+    props._known |= property;
+  }
+  return (props._value & property) != 0;
+}
@@ -16,6 +16,8 @@
 
 #include "dtoolbase.h"
 
+#include <unordered_map>
+
 class CPPFunctionGroup;
 class CPPInstance;
 class CPPType;
@@ -87,6 +89,7 @@ public:
   static bool is_vector_unsigned_char(CPPType *type);
   static bool is_const_vector_unsigned_char(CPPType *type);
   static bool is_pair(CPPType *type);
+  static bool is_vector(CPPType *type);
   static bool is_bool(CPPType *type);
   static bool is_integer(CPPType *type);
   static bool is_unsigned_integer(CPPType *type);
@@ -151,6 +154,61 @@ public:
 
   static bool is_exported(CPPType *type);
   static bool is_local(CPPType *type);
+
+private:
+  // Each of the predicates that is expensive to compute has a bit here, which
+  // is set in a type's TypeProperties once the answer is known.
+  enum Property {
+    P_basic_string_char      = 0x00001,
+    P_basic_string_wchar     = 0x00002,
+    P_vector_unsigned_char   = 0x00004,
+    P_size                   = 0x00008,
+    P_ssize                  = 0x00010,
+    P_reference_count        = 0x00020,
+    P_pointer_to_base        = 0x00040,
+    P_pair                   = 0x00080,
+    P_vector                 = 0x00100,
+    P_PyObject               = 0x00200,
+    P_PyTypeObject           = 0x00400,
+    P_PyStringObject         = 0x00800,
+    P_PyUnicodeObject        = 0x01000,
+    P_Py_buffer              = 0x02000,
+    P_handle                 = 0x04000,
+    P_ostream                = 0x08000,
+    P_exported               = 0x10000
+  };
+
+  static bool get_property(CPPType *type, unsigned int property,
+                           bool (*compute)(CPPType *));
+
+  static bool r_is_basic_string_char(CPPType *type);
+  static bool r_is_basic_string_wchar(CPPType *type);
+  static bool r_is_vector_unsigned_char(CPPType *type);
+  static bool r_is_size(CPPType *type);
+  static bool r_is_ssize(CPPType *type);
+  static bool r_is_reference_count(CPPType *type);
+  static bool r_is_pointer_to_base(CPPType *type);
+  static bool r_is_pair(CPPType *type);
+  static bool r_is_vector(CPPType *type);
+  static bool r_is_PyObject(CPPType *type);
+  static bool r_is_PyTypeObject(CPPType *type);
+  static bool r_is_PyStringObject(CPPType *type);
+  static bool r_is_PyUnicodeObject(CPPType *type);
+  static bool r_is_Py_buffer(CPPType *type);
+  static bool r_is_handle(CPPType *type);
+  static bool r_is_ostream(CPPType *type);
+  static bool r_is_exported(CPPType *type);
+
+  class TypeProperties {
+  public:
+    TypeProperties() : _known(0), _value(0), _resolved_type(nullptr) {}
+
+    unsigned int _known;
+    unsigned int _value;
+    CPPType *_resolved_type;
+  };
+  typedef std::unordered_map<CPPType *, TypeProperties> TypeCache;
+  static TypeCache _type_cache;
 };
 
 #endif
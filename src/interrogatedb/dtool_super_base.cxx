@@ -156,7 +156,7 @@ Dtool_PyTypedObject *Dtool_GetSuperBase() {
 
   PyDict_SetItemString(super_base_type._PyType.tp_dict, "DtoolGetSuperBase", PyCFunction_New(&methods[0], (PyObject *)&super_base_type));
 
-  (*type_map)["DTOOL_SUPER_BASE"] = &super_base_type;
+  Dtool_RegisterType(type_map, "DTOOL_SUPER_BASE", &super_base_type);
   return &super_base_type;
 }
 
@@ -8,6 +8,10 @@
 #include "config_interrogatedb.h"
 #include "executionEnvironment.h"
 
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
 #ifdef HAVE_PYTHON
 
 #define _STRINGIFY_VERSION(a, b) (#a "." #b)
@@ -107,16 +111,29 @@ DTOOL_Call_GetPointerThisClass(PyObject *self, Dtool_PyTypedObject *classdef,
     void *result = DtoolInstance_UPCAST(self, *classdef);
 
     if (result != nullptr) {
-      if (const_ok || !DtoolInstance_IS_CONST(self)) {
+      if (const_ok) {
         return result;
       }
 
-      if (report_errors) {
-        return PyErr_Format(PyExc_TypeError,
-                            "%s() argument %d may not be const",
-                            function_name.c_str(), param);
+      if (DtoolInstance_IS_CONST(self)) {
+        if (report_errors) {
+          return PyErr_Format(PyExc_TypeError,
+                              "%s() argument %d may not be const",
+                              function_name.c_str(), param);
+        }
+        return nullptr;
       }
-      return nullptr;
+
+      // The function might reallocate the storage of an exported buffer.
+      if (DtoolInstance_NUM_EXPORTS(self) != 0) {
+        if (report_errors) {
+          return PyErr_Format(PyExc_BufferError,
+                              "%s() argument %d may not have an exported buffer",
+                              function_name.c_str(), param);
+        }
+        return nullptr;
+      }
+      return result;
     }
   }
 
@@ -442,6 +459,86 @@ PyTypeObject *Dtool_EnumType_Create(const char *name, PyObject *names, const cha
   return (PyTypeObject *)result;
 }
 
+/**
+ * Called by the generated upcast functions to remember the pointer adjustment
+ * of a cast with a constant adjustment.  Returns the result for convenience.
+ */
+void *Dtool_CacheUpcast(PyObject *self, Dtool_PyTypedObject *requested_type, void *result) {
+  void *local_this = DtoolInstance_VOID_PTR(self);
+  if (local_this != nullptr && result != nullptr) {
+    Dtool_CastCache::Entry &entry =
+      DtoolInstance_TYPE(self)->_upcast_cache._entries[Dtool_CastCacheSlot(requested_type)];
+    entry._other = requested_type;
+    entry._delta = (char *)result - (char *)local_this;
+  }
+  return result;
+}
+
+/**
+ * Called by the generated upcast functions to remember that the object's
+ * class can't be cast to the requested class.  Always returns NULL.
+ */
+void *Dtool_CacheUpcastFailure(PyObject *self, Dtool_PyTypedObject *requested_type) {
+  Dtool_CastCache::Entry &entry =
+    DtoolInstance_TYPE(self)->_upcast_cache._entries[Dtool_CastCacheSlot(requested_type)];
+  entry._other = requested_type;
+  entry._delta = DTOOL_CAST_FAILS;
+  return nullptr;
+}
+
+// Maps a type index to the wrapped class registered for exactly that type.
+// Types that only have a wrapper for one of their base classes are not
+// stored, since a better fit may still be registered later.
+static std::vector<Dtool_PyTypedObject *> python_type_cache;
+
+/**
+ * Returns the wrapped class that best represents the given type, or NULL.
+ */
+static Dtool_PyTypedObject *
+Dtool_LookupPythonType(int type_index) {
+  if ((size_t)type_index < python_type_cache.size()) {
+    Dtool_PyTypedObject *cached = python_type_cache[type_index];
+    if (cached != nullptr) {
+      return cached;
+    }
+  }
+
+  Dtool_PyTypedObject *target_class = (Dtool_PyTypedObject *)TypeHandle::from_index(type_index).get_python_type();
+  if (target_class != nullptr && target_class->_type.get_index() == type_index) {
+    if ((size_t)type_index >= python_type_cache.size()) {
+      python_type_cache.resize(type_index + 1, nullptr);
+    }
+    python_type_cache[type_index] = target_class;
+  }
+  return target_class;
+}
+
+/**
+ * Casts the pointer from the given class down to target_class.  Returns NULL
+ * if there is no such cast.  The generated downcast functions only perform
+ * casts with a constant pointer adjustment, so the result is always cached.
+ */
+static void *
+Dtool_Downcast(Dtool_PyTypedObject *target_class, void *local_this_in, Dtool_PyTypedObject *from_type) {
+  Dtool_CastCache::Entry &entry =
+    target_class->_downcast_cache._entries[Dtool_CastCacheSlot(from_type)];
+  if (entry._other == from_type) {
+    if (entry._delta == DTOOL_CAST_FAILS) {
+      return nullptr;
+    }
+    return (char *)local_this_in + entry._delta;
+  }
+
+  void *new_local_this = target_class->_Dtool_DowncastInterface(local_this_in, from_type);
+  entry._other = from_type;
+  if (new_local_this != nullptr) {
+    entry._delta = (char *)new_local_this - (char *)local_this_in;
+  } else {
+    entry._delta = DTOOL_CAST_FAILS;
+  }
+  return new_local_this;
+}
+
 /**
 
  */
@@ -455,11 +552,13 @@ PyObject *DTool_CreatePyInstanceTyped(void *local_this_in, Dtool_PyTypedObject &
   // IF the class is possibly a run time typed object
   if (type_index > 0) {
     // get best fit class...
-    Dtool_PyTypedObject *target_class = (Dtool_PyTypedObject *)TypeHandle::from_index(type_index).get_python_type();
+    Dtool_PyTypedObject *target_class = Dtool_LookupPythonType(type_index);
     if (target_class != nullptr) {
       // cast to the type...
-      void *new_local_this = target_class->_Dtool_DowncastInterface(local_this_in, &known_class_type);
+      void *new_local_this = Dtool_Downcast(target_class, local_this_in, &known_class_type);
       if (new_local_this != nullptr) {
+        Dtool_EnsureTypeReady(*target_class);
+
         // ask class to allocate an instance..
         Dtool_PyInstDef *self = (Dtool_PyInstDef *) target_class->_PyType.tp_new(&target_class->_PyType, nullptr, nullptr);
         if (self != nullptr) {
@@ -476,6 +575,7 @@ PyObject *DTool_CreatePyInstanceTyped(void *local_this_in, Dtool_PyTypedObject &
 
   // if we get this far .. just wrap the thing in the known type ?? better
   // than aborting...I guess....
+  Dtool_EnsureTypeReady(known_class_type);
   Dtool_PyInstDef *self = (Dtool_PyInstDef *) known_class_type._PyType.tp_new(&known_class_type._PyType, nullptr, nullptr);
   if (self != nullptr) {
     self->_ptr_to_object = local_this_in;
@@ -498,6 +598,7 @@ PyObject *DTool_CreatePyInstance(void *local_this, Dtool_PyTypedObject &in_class
   }
 
   Dtool_PyTypedObject *classdef = &in_classdef;
+  Dtool_EnsureTypeReady(*classdef);
   Dtool_PyInstDef *self = (Dtool_PyInstDef *) classdef->_PyType.tp_new(&classdef->_PyType, nullptr, nullptr);
   if (self != nullptr) {
     self->_ptr_to_object = local_this;
@@ -508,22 +609,329 @@ PyObject *DTool_CreatePyInstance(void *local_this, Dtool_PyTypedObject &in_class
   return (PyObject *)self;
 }
 
+// The free lists that have been used, ending at a sentinel.  Once these have
+// been emptied, when the last module is unloaded, no more instances are kept.
+static Dtool_FreeList free_lists_end = {nullptr, 0, nullptr, nullptr, 0, 0};
+static Dtool_FreeList *free_lists_head = &free_lists_end;
+static bool free_lists_enabled = true;
+
+/**
+ * Allocates a new instance of the given type, which is either the class
+ * described by classdef or a Python subclass of it.  The memory of a recently
+ * freed instance of the same class is reused if there is one.  Like tp_alloc,
+ * returns the instance with its fields zeroed out.
+ */
+PyObject *Dtool_AllocInstance(PyTypeObject *type, Dtool_PyTypedObject &classdef) {
+  Dtool_FreeList &list = classdef._free_list;
+  if (type != &classdef._PyType) {
+    // A Python subclass, which has a different layout.
+    return type->tp_alloc(type, 0);
+  }
+
+  Dtool_PyInstDef *self = list._head;
+  if (self == nullptr) {
+    ++list._num_allocated;
+    return type->tp_alloc(type, 0);
+  }
+
+  list._head = (Dtool_PyInstDef *)self->_ptr_to_object;
+  --list._size;
+  ++list._num_reused;
+
+  memset((char *)self + sizeof(PyObject), 0, type->tp_basicsize - sizeof(PyObject));
+  PyObject_INIT(self, type);
+  return (PyObject *)self;
+}
+
+/**
+ * Frees the memory of an instance whose C++ object has already been dealt
+ * with.  If the instance is of exactly the class described by classdef, and
+ * its free list is not full, it is kept for reuse instead.
+ */
+void Dtool_FreeInstanceMemory(PyObject *self, Dtool_PyTypedObject &classdef) {
+  PyTypeObject *type = Py_TYPE(self);
+  Dtool_FreeList &list = classdef._free_list;
+  if (type != &classdef._PyType || list._size >= DTOOL_FREE_LIST_SIZE ||
+      !free_lists_enabled || PyType_IS_GC(type)) {
+    type->tp_free(self);
+    return;
+  }
+
+  if (list._next == nullptr) {
+    list._next = free_lists_head;
+    list._type = &classdef;
+    free_lists_head = &list;
+  }
+  ((Dtool_PyInstDef *)self)->_ptr_to_object = (void *)list._head;
+  list._head = (Dtool_PyInstDef *)self;
+  ++list._size;
+}
+
+/**
+ * Frees all of the instances that are kept on the free lists, and stops
+ * keeping them from now on.  This is called when the last module that uses
+ * them is unloaded.
+ */
+void Dtool_ClearFreeLists() {
+  free_lists_enabled = false;
+  Dtool_ClearWrapperFreeList();
+
+  while (free_lists_head != &free_lists_end) {
+    Dtool_FreeList *list = free_lists_head;
+    while (list->_head != nullptr) {
+      Dtool_PyInstDef *self = list->_head;
+      list->_head = (Dtool_PyInstDef *)self->_ptr_to_object;
+      Py_TYPE(self)->tp_free((PyObject *)self);
+    }
+    list->_size = 0;
+    free_lists_head = list->_next;
+    list->_next = nullptr;
+  }
+}
+
+/**
+ * Implements the Dtool_GetFreeListStats() function that is added to every
+ * module.  Returns a dictionary mapping the name of each class whose free
+ * list has been used to a tuple of (instances kept, allocations that reused
+ * an instance, allocations that did not).
+ */
+PyObject *Dtool_GetFreeListStats(PyObject *, PyObject *) {
+  PyObject *dict = PyDict_New();
+  for (Dtool_FreeList *list = free_lists_head;
+       list != &free_lists_end;
+       list = list->_next) {
+    PyObject *value = Py_BuildValue("(iKK)", list->_size,
+      (unsigned PY_LONG_LONG)list->_num_reused,
+      (unsigned PY_LONG_LONG)list->_num_allocated);
+    if (value == nullptr ||
+        PyDict_SetItemString(dict, list->_type->_PyType.tp_name, value) != 0) {
+      Py_XDECREF(value);
+      Py_DECREF(dict);
+      return nullptr;
+    }
+    Py_DECREF(value);
+  }
+  return dict;
+}
+
+// Maps the pointer to a reference-counted object, after the downcast to the
+// class it is wrapped as, to the one wrapper that is returned for it.  The
+// references are borrowed; a wrapper removes itself when it is deallocated.
+typedef std::unordered_map<void *, Dtool_PyInstDef *> WrapperCache;
+static WrapperCache wrapper_cache;
+
+/**
+ * Returns a new reference to the cached wrapper of the given object, or NULL
+ * if there is none with the requested constness.  The pointer is downcast
+ * according to the type index in the same way as DTool_CreatePyInstanceTyped
+ * does, so pass 0 for a class that isn't a TypedObject.  If a wrapper is
+ * returned, it already holds a reference to the C++ object.
+ */
+PyObject *Dtool_FindWrapper(void *local_this, Dtool_PyTypedObject &known_class, bool is_const, int type_index) {
+  if (local_this == nullptr || wrapper_cache.empty()) {
+    return nullptr;
+  }
+
+  Dtool_PyTypedObject *target_class = &known_class;
+  if (type_index > 0) {
+    Dtool_PyTypedObject *best_class = Dtool_LookupPythonType(type_index);
+    if (best_class != nullptr) {
+      void *new_local_this = Dtool_Downcast(best_class, local_this, &known_class);
+      if (new_local_this != nullptr) {
+        local_this = new_local_this;
+        target_class = best_class;
+      }
+    }
+  }
+
+  WrapperCache::const_iterator it = wrapper_cache.find(local_this);
+  if (it == wrapper_cache.end()) {
+    return nullptr;
+  }
+  Dtool_PyInstDef *inst = it->second;
+  PyObject *self = (PyObject *)inst;
+  if (inst->_is_const != is_const || inst->_ptr_to_object != local_this ||
+      !PyObject_TypeCheck(self, &target_class->_PyType)) {
+    return nullptr;
+  }
+
+  // A wrapper whose count has dropped to zero is in the middle of being
+  // deallocated, and one that was finalized by the garbage collector is about
+  // to be cleared; either way, it can't be handed out again.
+  if (Py_REFCNT(self) <= 0) {
+    return nullptr;
+  }
+#if PY_VERSION_HEX >= 0x03090000
+  if (PyObject_IS_GC(self) && PyObject_GC_IsFinalized(self)) {
+    return nullptr;
+  }
+#endif
+
+  Py_INCREF(self);
+  return self;
+}
+
+/**
+ * Makes the given newly created wrapper the one that Dtool_FindWrapper
+ * returns for the object it wraps, unless the object already has one.  The
+ * wrapper must own a reference to the object.  Returns the wrapper, which may
+ * also be NULL or None, for convenience.
+ */
+PyObject *Dtool_RememberWrapper(PyObject *self) {
+  if (self != nullptr && DtoolInstance_Check(self)) {
+    Dtool_PyInstDef *inst = (Dtool_PyInstDef *)self;
+    if (inst->_ptr_to_object != nullptr && inst->_memory_rules) {
+      wrapper_cache.insert(WrapperCache::value_type(inst->_ptr_to_object, inst));
+    }
+  }
+  return self;
+}
+
+/**
+ * Removes the wrapper from the cache, if it is in there.  Called when it is
+ * deallocated, or when it is made to wrap a different object.
+ */
+void Dtool_ForgetWrapper(PyObject *self) {
+  if (wrapper_cache.empty()) {
+    return;
+  }
+  Dtool_PyInstDef *inst = (Dtool_PyInstDef *)self;
+  WrapperCache::iterator it = wrapper_cache.find(inst->_ptr_to_object);
+  if (it != wrapper_cache.end() && it->second == inst) {
+    wrapper_cache.erase(it);
+  }
+}
+
+/**
+ * Fills in a one-dimensional buffer view of size elements of the given
+ * format, stored contiguously at data.  Returns 0 on success, or -1 with a
+ * BufferError set.
+ *
+ * The view is counted on the wrapper until it is released, and in the meantime
+ * the wrapper refuses to be resized from Python.  Nothing stops C++ code that
+ * holds its own pointer or reference to the same vector from resizing it,
+ * which leaves the view pointing at freed memory.
+ */
+int Dtool_GetVectorBuffer(PyObject *self, Py_buffer *view, int flags, void *data,
+                          Py_ssize_t size, Py_ssize_t itemsize, const char *format) {
+  bool readonly = DtoolInstance_IS_CONST(self);
+  if (readonly && (flags & PyBUF_WRITABLE) == PyBUF_WRITABLE) {
+    PyErr_SetString(PyExc_BufferError, "Object is const.");
+    return -1;
+  }
+
+  // The shape and the strides have to stay valid as long as the view does.
+  Py_ssize_t *shape = nullptr;
+  if ((flags & PyBUF_ND) == PyBUF_ND) {
+    shape = (Py_ssize_t *)PyMem_Malloc(2 * sizeof(Py_ssize_t));
+    if (shape == nullptr) {
+      PyErr_NoMemory();
+      return -1;
+    }
+    shape[0] = size;
+    shape[1] = itemsize;
+  }
+
+  // A vector that never held anything may not have any storage at all.
+  static char empty_storage;
+  view->buf = (data != nullptr) ? data : (void *)&empty_storage;
+  view->obj = self;
+  Py_INCREF(self);
+  view->len = size * itemsize;
+  view->readonly = readonly;
+  view->itemsize = itemsize;
+  view->format = ((flags & PyBUF_FORMAT) == PyBUF_FORMAT) ? (char *)format : nullptr;
+  view->ndim = 1;
+  view->shape = shape;
+  view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? shape + 1 : nullptr;
+  view->suboffsets = nullptr;
+  view->internal = (void *)shape;
+
+  ++DtoolInstance_NUM_EXPORTS(self);
+  return 0;
+}
+
+/**
+ * Releases a view filled in by Dtool_GetVectorBuffer.
+ */
+void Dtool_ReleaseVectorBuffer(PyObject *self, Py_buffer *view) {
+  PyMem_Free(view->internal);
+  view->internal = nullptr;
+
+  nassertv(DtoolInstance_NUM_EXPORTS(self) > 0);
+  --DtoolInstance_NUM_EXPORTS(self);
+}
+
+/**
+ * Called by the wrappers of the methods of a vector that may reallocate its
+ * storage.  Returns true if that is allowed, or false with a BufferError set
+ * if a view of the storage is currently exported.
+ */
+bool Dtool_CheckNoExports(PyObject *self, const char *method_name) {
+  if (DtoolInstance_NUM_EXPORTS(self) != 0) {
+    PyErr_Format(PyExc_BufferError,
+                 "Cannot call %s() while a buffer is exported.",
+                 method_name);
+    return false;
+  }
+  return true;
+}
+
+#if PY_MAJOR_VERSION >= 3
+// The number of modules that have Dtool_FreeModule as their m_free and have
+// not yet been freed.  The free lists and the type cache are shared by all of
+// them, so they are only cleared when the last one goes.
+static int num_loaded_modules = 0;
+
+/**
+ * Installed as the m_free of the module definition.
+ */
+static void Dtool_FreeModule(void *) {
+  if (--num_loaded_modules == 0) {
+    Dtool_ClearFreeLists();
+    python_type_cache.clear();
+  }
+}
+#endif
+
 /**
  * Returns a borrowed reference to the global type dictionary.
+ *
+ * This is shared through sys with all other modules built against this
+ * version of the runtime.  The name is different from the one used by
+ * earlier versions, which stored a different kind of map under it.
  */
 Dtool_TypeMap *Dtool_GetGlobalTypeMap() {
-  PyObject *capsule = PySys_GetObject((char *)"_interrogate_types");
+  static const char *const capsule_name = "_interrogate_types_v2";
+  PyObject *capsule = PySys_GetObject((char *)capsule_name);
   if (capsule != nullptr) {
-    return (Dtool_TypeMap *)PyCapsule_GetPointer(capsule, nullptr);
+    return (Dtool_TypeMap *)PyCapsule_GetPointer(capsule, capsule_name);
   } else {
     Dtool_TypeMap *type_map = new Dtool_TypeMap;
-    capsule = PyCapsule_New((void *)type_map, nullptr, nullptr);
-    PySys_SetObject((char *)"_interrogate_types", capsule);
+    capsule = PyCapsule_New((void *)type_map, capsule_name, nullptr);
+    PySys_SetObject((char *)capsule_name, capsule);
     Py_DECREF(capsule);
     return type_map;
   }
 }
 
+/**
+ * Adds the given type to the global type dictionary under the given name,
+ * replacing any type that was there before.  The dictionary keeps its own
+ * copy of the name.
+ */
+void Dtool_RegisterType(Dtool_TypeMap *type_map, const char *name, Dtool_PyTypedObject *type) {
+  auto it = type_map->find(name);
+  if (it != type_map->end()) {
+    it->second = type;
+  } else {
+    size_t length = strlen(name) + 1;
+    char *name_copy = new char[length];
+    memcpy(name_copy, name, length);
+    type_map->insert(Dtool_TypeMap::value_type(name_copy, type));
+  }
+}
+
 #define PY_MAJOR_VERSION_STR #PY_MAJOR_VERSION "." #PY_MINOR_VERSION
 
 #if PY_MAJOR_VERSION >= 3
@@ -552,15 +960,27 @@ PyObject *Dtool_PyModuleInitHelper(const LibraryDef *defs[], const char *modulen
 
   Dtool_TypeMap *type_map = Dtool_GetGlobalTypeMap();
 
-  // the module level function inits....
+  // the module level function inits....  The first definition of each name
+  // wins; the functions keep the order in which they were defined.
+  size_t num_methods = 0;
+  for (size_t i = 0; defs[i] != nullptr; i++) {
+    for (PyMethodDef *meth = defs[i]->_methods; meth->ml_name != nullptr; meth++) {
+      ++num_methods;
+    }
+  }
+
   MethodDefmap functions;
+  functions.reserve(num_methods);
+  PyMethodDef *newdef = new PyMethodDef[num_methods + 1];
+  int offset = 0;
+
   for (size_t i = 0; defs[i] != nullptr; i++) {
     const LibraryDef &def = *defs[i];
 
     // Accumulate method definitions.
     for (PyMethodDef *meth = def._methods; meth->ml_name != nullptr; meth++) {
-      if (functions.find(meth->ml_name) == functions.end()) {
-        functions[meth->ml_name] = meth;
+      if (functions.insert(MethodDefmap::value_type(meth->ml_name, meth)).second) {
+        newdef[offset++] = *meth;
       }
     }
 
@@ -568,23 +988,26 @@ PyObject *Dtool_PyModuleInitHelper(const LibraryDef *defs[], const char *modulen
     const Dtool_TypeDef *types = def._types;
     if (types != nullptr) {
       while (types->name != nullptr) {
-        (*type_map)[std::string(types->name)] = types->type;
+        Dtool_RegisterType(type_map, types->name, types->type);
         ++types;
       }
     }
   }
 
-  // Resolve external types, in a second pass.
+  // Resolve external types, in a second pass, now that the types of all the
+  // component libraries are known.  This fills in the imports table of each
+  // library, so that no lookups by name are needed after this point.
   for (size_t i = 0; defs[i] != nullptr; i++) {
     const LibraryDef &def = *defs[i];
 
     Dtool_TypeDef *types = def._external_types;
     if (types != nullptr) {
       while (types->name != nullptr) {
-        auto it = type_map->find(std::string(types->name));
+        auto it = type_map->find(types->name);
         if (it != type_map->end()) {
           types->type = it->second;
         } else {
+          delete[] newdef;
           return PyErr_Format(PyExc_NameError, "name '%s' is not defined", types->name);
         }
         ++types;
@@ -592,12 +1015,6 @@ PyObject *Dtool_PyModuleInitHelper(const LibraryDef *defs[], const char *modulen
     }
   }
 
-  PyMethodDef *newdef = new PyMethodDef[functions.size() + 1];
-  MethodDefmap::iterator mi;
-  int offset = 0;
-  for (mi = functions.begin(); mi != functions.end(); mi++, offset++) {
-    newdef[offset] = *mi->second;
-  }
   newdef[offset].ml_doc = nullptr;
   newdef[offset].ml_name = nullptr;
   newdef[offset].ml_meth = nullptr;
@@ -605,7 +1022,13 @@ PyObject *Dtool_PyModuleInitHelper(const LibraryDef *defs[], const char *modulen
 
 #if PY_MAJOR_VERSION >= 3
   module_def->m_methods = newdef;
+  if (module_def->m_free == nullptr) {
+    module_def->m_free = &Dtool_FreeModule;
+  }
   PyObject *module = PyModule_Create(module_def);
+  if (module != nullptr && module_def->m_free == &Dtool_FreeModule) {
+    ++num_loaded_modules;
+  }
 #else
   PyObject *module = Py_InitModule((char *)modulename, newdef);
 #endif
@@ -682,6 +1105,113 @@ PyObject *Dtool_PyModuleInitHelper(const LibraryDef *defs[], const char *modulen
   return module;
 }
 
+#if PY_VERSION_HEX >= 0x03070000
+/**
+ * The module-level __getattr__ of a module with lazily initialized classes.
+ * Initializes the requested class, and stores it in the module so that this
+ * isn't called for it again.  The self argument is a tuple of the module's
+ * dictionary and the dictionary of classes that haven't been accessed yet.
+ */
+static PyObject *Dtool_LazyGetAttr(PyObject *self, PyObject *name) {
+  PyObject *module_dict = PyTuple_GET_ITEM(self, 0);
+  PyObject *lazy_types = PyTuple_GET_ITEM(self, 1);
+
+  PyObject *capsule = PyDict_GetItem(lazy_types, name);
+  if (capsule == nullptr) {
+    if (PyUnicode_Check(name) && PyUnicode_CompareWithASCIIString(name, "__all__") == 0) {
+      // Make "from module import *" see the classes as well.
+      PyObject *names = PyList_New(0);
+      PyObject *key;
+      Py_ssize_t pos = 0;
+      while (PyDict_Next(module_dict, &pos, &key, nullptr)) {
+        if (PyUnicode_Check(key) && PyUnicode_GET_LENGTH(key) > 0 &&
+            PyUnicode_READ_CHAR(key, 0) != '_') {
+          PyList_Append(names, key);
+        }
+      }
+      pos = 0;
+      while (PyDict_Next(lazy_types, &pos, &key, nullptr)) {
+        PyList_Append(names, key);
+      }
+      return names;
+    }
+
+    PyObject *module_name = PyDict_GetItemString(module_dict, "__name__");
+    return PyErr_Format(PyExc_AttributeError, "module '%S' has no attribute '%S'",
+                        module_name, name);
+  }
+
+  Dtool_PyTypedObject *type = (Dtool_PyTypedObject *)PyCapsule_GetPointer(capsule, nullptr);
+  Dtool_EnsureTypeReady(*type);
+  if (PyErr_Occurred()) {
+    return nullptr;
+  }
+
+  // Set it on the module, and only then remove it from the lazy types, since
+  // the name may be the last reference to the capsule.
+  if (PyDict_SetItem(module_dict, name, (PyObject *)type) < 0 ||
+      PyDict_DelItem(lazy_types, name) < 0) {
+    return nullptr;
+  }
+  Py_INCREF((PyObject *)type);
+  return (PyObject *)type;
+}
+
+/**
+ * The module-level __dir__ of a module with lazily initialized classes.
+ */
+static PyObject *Dtool_LazyDir(PyObject *self, PyObject *) {
+  PyObject *names = PyDict_Keys(PyTuple_GET_ITEM(self, 0));
+  PyObject *lazy_names = PyDict_Keys(PyTuple_GET_ITEM(self, 1));
+  if (names != nullptr && lazy_names != nullptr) {
+    Py_ssize_t size = PyList_GET_SIZE(names);
+    PyList_SetSlice(names, size, size, lazy_names);
+    PyList_Sort(names);
+  }
+  Py_XDECREF(lazy_names);
+  return names;
+}
+
+static PyMethodDef Dtool_LazyGetAttr_def = {"__getattr__", &Dtool_LazyGetAttr, METH_O, nullptr};
+static PyMethodDef Dtool_LazyDir_def = {"__dir__", &Dtool_LazyDir, METH_NOARGS, nullptr};
+#endif
+
+/**
+ * Adds the given class to the module under the given name.  Where modules
+ * support a __getattr__ function, the class is only initialized when it is
+ * first accessed; otherwise, it is initialized right away.
+ */
+void Dtool_AddLazyType(PyObject *module, const char *name, Dtool_PyTypedObject *type) {
+#if PY_VERSION_HEX >= 0x03070000
+  PyObject *module_dict = PyModule_GetDict(module);
+  PyObject *getattr = PyDict_GetItemString(module_dict, "__getattr__");
+  PyObject *lazy_types;
+  if (getattr != nullptr && PyCFunction_Check(getattr) &&
+      PyCFunction_GET_FUNCTION(getattr) == (PyCFunction)&Dtool_LazyGetAttr) {
+    lazy_types = PyTuple_GET_ITEM(PyCFunction_GET_SELF(getattr), 1);
+  } else {
+    lazy_types = PyDict_New();
+    PyObject *state = PyTuple_Pack(2, module_dict, lazy_types);
+    Py_DECREF(lazy_types);
+    getattr = PyCFunction_New(&Dtool_LazyGetAttr_def, state);
+    PyObject *dir = PyCFunction_New(&Dtool_LazyDir_def, state);
+    Py_DECREF(state);
+    PyDict_SetItemString(module_dict, "__getattr__", getattr);
+    PyDict_SetItemString(module_dict, "__dir__", dir);
+    Py_DECREF(getattr);
+    Py_DECREF(dir);
+  }
+
+  PyObject *capsule = PyCapsule_New((void *)type, nullptr, nullptr);
+  PyDict_SetItemString(lazy_types, name, capsule);
+  Py_DECREF(capsule);
+#else
+  Dtool_EnsureTypeReady(*type);
+  Py_INCREF((PyObject *)type);
+  PyModule_AddObject(module, name, (PyObject *)type);
+#endif
+}
+
 // HACK.... Be careful Dtool_BorrowThisReference This function can be used to
 // grab the "THIS" pointer from an object and use it Required to support
 // historical inheritance in the form of "is this instance of"..
@@ -696,6 +1226,7 @@ PyObject *Dtool_BorrowThisReference(PyObject *self, PyObject *args) {
 
       // if (PyObject_TypeCheck(to_in, Py_TYPE(from_in))) {
       if (from->_My_Type == to->_My_Type) {
+        Dtool_ForgetWrapper(to_in);
         to->_memory_rules = false;
         to->_is_const = from->_is_const;
         to->_ptr_to_object = from->_ptr_to_object;
@@ -740,7 +1271,12 @@ Dtool_AddToDictionary(PyObject *self1, PyObject *args) {
  * make_copy() method.
  */
 PyObject *copy_from_make_copy(PyObject *self, PyObject *noargs) {
-  PyObject *callable = PyObject_GetAttrString(self, "make_copy");
+#if PY_MAJOR_VERSION >= 3
+  static PyObject *make_copy_str = PyUnicode_InternFromString("make_copy");
+#else
+  static PyObject *make_copy_str = PyString_InternFromString("make_copy");
+#endif
+  PyObject *callable = PyObject_GetAttr(self, make_copy_str);
   if (callable == nullptr) {
     return nullptr;
   }
@@ -764,7 +1300,12 @@ PyObject *copy_from_copy_constructor(PyObject *self, PyObject *noargs) {
  * __copy__().
  */
 PyObject *map_deepcopy_to_copy(PyObject *self, PyObject *args) {
-  PyObject *callable = PyObject_GetAttrString(self, "__copy__");
+#if PY_MAJOR_VERSION >= 3
+  static PyObject *copy_str = PyUnicode_InternFromString("__copy__");
+#else
+  static PyObject *copy_str = PyString_InternFromString("__copy__");
+#endif
+  PyObject *callable = PyObject_GetAttr(self, copy_str);
   if (callable == nullptr) {
     return nullptr;
   }
@@ -869,4 +1410,544 @@ bool Dtool_ExtractOptionalArg(PyObject **result, PyObject *args, PyObject *kwds)
   return (PyTuple_GET_SIZE(args) == 0);
 }
 
+#if PY_VERSION_HEX >= 0x03070000
+/**
+ * Variant of Dtool_ExtractArg for METH_FASTCALL wrappers.
+ */
+bool Dtool_ExtractArg(PyObject **result, PyObject *const *args, Py_ssize_t nargs,
+                      PyObject *kwnames, const char *keyword) {
+  Py_ssize_t num_keywords = (kwnames != nullptr) ? PyTuple_GET_SIZE(kwnames) : 0;
+
+  if (nargs + num_keywords != 1) {
+    return false;
+  }
+  if (num_keywords == 1 &&
+      PyUnicode_CompareWithASCIIString(PyTuple_GET_ITEM(kwnames, 0), keyword) != 0) {
+    return false;
+  }
+  *result = args[0];
+  return true;
+}
+
+/**
+ * Variant of Dtool_ExtractArg for METH_FASTCALL wrappers that does not accept
+ * a keyword argument.
+ */
+bool Dtool_ExtractArg(PyObject **result, PyObject *const *args, Py_ssize_t nargs,
+                      PyObject *kwnames) {
+  if (nargs == 1 && (kwnames == nullptr || PyTuple_GET_SIZE(kwnames) == 0)) {
+    *result = args[0];
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Variant of Dtool_ExtractOptionalArg for METH_FASTCALL wrappers.
+ */
+bool Dtool_ExtractOptionalArg(PyObject **result, PyObject *const *args,
+                              Py_ssize_t nargs, PyObject *kwnames,
+                              const char *keyword) {
+  Py_ssize_t num_keywords = (kwnames != nullptr) ? PyTuple_GET_SIZE(kwnames) : 0;
+
+  if (nargs + num_keywords > 1) {
+    return false;
+  }
+  if (num_keywords == 1 &&
+      PyUnicode_CompareWithASCIIString(PyTuple_GET_ITEM(kwnames, 0), keyword) != 0) {
+    return false;
+  }
+  if (nargs + num_keywords == 1) {
+    *result = args[0];
+  }
+  return true;
+}
+
+/**
+ * Variant of Dtool_ExtractOptionalArg for METH_FASTCALL wrappers that does
+ * not accept a keyword argument.
+ */
+bool Dtool_ExtractOptionalArg(PyObject **result, PyObject *const *args,
+                              Py_ssize_t nargs, PyObject *kwnames) {
+  if (kwnames != nullptr && PyTuple_GET_SIZE(kwnames) != 0) {
+    return false;
+  }
+  if (nargs == 1) {
+    *result = args[0];
+    return true;
+  }
+  return (nargs == 0);
+}
+
+/**
+ * The equivalent of PyArg_ParseTupleAndKeywords for wrappers that receive
+ * their arguments as a vector (METH_FASTCALL), which saves building an args
+ * tuple and a kwargs dict for every call.
+ *
+ * keywords is the nullptr-terminated list of parameter names, or nullptr if
+ * no keyword arguments are accepted.  keyword_names should point to a static
+ * array with room for one PyObject pointer per name, which is filled with
+ * interned copies of the names on first use.  Python interns the keyword
+ * names that appear in source code, so these can usually be matched by
+ * pointer, without comparing any strings.
+ *
+ * Only the format codes that interrogate generates are supported.
+ */
+bool Dtool_ParseFastcallArgs(PyObject *const *args, Py_ssize_t nargs,
+                             PyObject *kwnames, const char *const *keywords,
+                             PyObject **keyword_names, const char *format, ...) {
+  // Count the parameters, and find the function name for error messages.
+  int num_params = 0;
+  int min_params = -1;
+  const char *p;
+  for (p = format; *p != '\0' && *p != ':'; ++p) {
+    if (*p == '|') {
+      min_params = num_params;
+    } else if (*p != '#') {
+      ++num_params;
+    }
+  }
+  const char *func_name = (*p == ':') ? p + 1 : "function";
+  if (min_params < 0) {
+    min_params = num_params;
+  }
+
+  if (nargs > num_params) {
+    PyErr_Format(PyExc_TypeError,
+                 "%s() takes at most %d argument%s (%zd given)",
+                 func_name, num_params, (num_params == 1) ? "" : "s", nargs);
+    return false;
+  }
+
+  // Figure out which argument goes with which parameter.
+  PyObject *small_params[16];
+  PyObject **params = small_params;
+  if (num_params > 16) {
+    params = (PyObject **)PyMem_Malloc(sizeof(PyObject *) * num_params);
+    if (params == nullptr) {
+      PyErr_NoMemory();
+      return false;
+    }
+  }
+
+  bool success = false;
+  int pi;
+  for (pi = 0; pi < nargs; ++pi) {
+    params[pi] = args[pi];
+  }
+  for (; pi < num_params; ++pi) {
+    params[pi] = nullptr;
+  }
+
+  Py_ssize_t num_keywords = (kwnames != nullptr) ? PyTuple_GET_SIZE(kwnames) : 0;
+  if (num_keywords > 0 && keywords == nullptr) {
+    PyErr_Format(PyExc_TypeError, "%s() takes no keyword arguments", func_name);
+    goto done;
+  }
+
+  if (num_keywords > 0 && keyword_names[0] == nullptr) {
+    for (int ki = 0; keywords[ki] != nullptr; ++ki) {
+      keyword_names[ki] = PyUnicode_InternFromString(keywords[ki]);
+    }
+  }
+
+  for (Py_ssize_t i = 0; i < num_keywords; ++i) {
+    PyObject *key = PyTuple_GET_ITEM(kwnames, i);
+
+    int ki;
+    for (ki = 0; ki < num_params; ++ki) {
+      if (keyword_names[ki] == key) {
+        break;
+      }
+    }
+    if (ki == num_params) {
+      // This may still be an equal string that isn't interned.
+      for (ki = 0; ki < num_params; ++ki) {
+        if (keywords[ki][0] != '\0' &&
+            PyUnicode_CompareWithASCIIString(key, keywords[ki]) == 0) {
+          break;
+        }
+      }
+    }
+    if (ki == num_params || keywords[ki][0] == '\0') {
+      PyErr_Format(PyExc_TypeError,
+                   "'%U' is an invalid keyword argument for %s()",
+                   key, func_name);
+      goto done;
+    }
+    if (params[ki] != nullptr) {
+      PyErr_Format(PyExc_TypeError,
+                   "argument for %s() given by name ('%s') and position (%d)",
+                   func_name, keywords[ki], ki + 1);
+      goto done;
+    }
+    params[ki] = args[nargs + i];
+  }
+
+  for (pi = nargs; pi < min_params; ++pi) {
+    if (params[pi] == nullptr) {
+      if (keywords != nullptr && keywords[pi][0] != '\0') {
+        PyErr_Format(PyExc_TypeError,
+                     "%s() missing required argument '%s' (pos %d)",
+                     func_name, keywords[pi], pi + 1);
+      } else {
+        PyErr_Format(PyExc_TypeError,
+                     "%s() takes at least %d argument%s (%zd given)",
+                     func_name, min_params, (min_params == 1) ? "" : "s", nargs);
+      }
+      goto done;
+    }
+  }
+
+  {
+    // Now convert the arguments.  The common cases are handled here; the
+    // rest are passed on to PyArg_Parse one at a time.
+    va_list va;
+    va_start(va, format);
+    pi = 0;
+    for (p = format; *p != '\0' && *p != ':'; ++p) {
+      char code = *p;
+      if (code == '|') {
+        continue;
+      }
+      bool has_length = (p[1] == '#');
+      if (has_length) {
+        ++p;
+      }
+      void *ptr = va_arg(va, void *);
+      void *length_ptr = has_length ? va_arg(va, void *) : nullptr;
+
+      PyObject *arg = params[pi++];
+      if (arg == nullptr) {
+        // Omitted optional argument; leave the default value.
+        continue;
+      }
+
+      switch (code) {
+      case 'O':
+        *(PyObject **)ptr = arg;
+        continue;
+
+      case 'd':
+        *(double *)ptr = PyFloat_AsDouble(arg);
+        if (*(double *)ptr == -1.0 && _PyErr_OCCURRED()) {
+          break;
+        }
+        continue;
+
+      case 'f':
+        {
+          double value = PyFloat_AsDouble(arg);
+          if (value == -1.0 && _PyErr_OCCURRED()) {
+            break;
+          }
+          *(float *)ptr = (float)value;
+        }
+        continue;
+
+#if PY_VERSION_HEX >= 0x030A0000
+      // As of Python 3.10, PyLong_AsLong no longer accepts floats, so it
+      // behaves exactly like these format codes.
+      case 'l':
+        *(long *)ptr = PyLong_AsLong(arg);
+        if (*(long *)ptr == -1 && _PyErr_OCCURRED()) {
+          break;
+        }
+        continue;
+
+      case 'i':
+        {
+          long value = PyLong_AsLong(arg);
+          if (value == -1 && _PyErr_OCCURRED()) {
+            break;
+          }
+          if (value > INT_MAX) {
+            PyErr_SetString(PyExc_OverflowError,
+                            "signed integer is greater than maximum");
+            break;
+          }
+          if (value < INT_MIN) {
+            PyErr_SetString(PyExc_OverflowError,
+                            "signed integer is less than minimum");
+            break;
+          }
+          *(int *)ptr = (int)value;
+        }
+        continue;
+#endif
+
+      default:
+        {
+          char unit[3] = {code, has_length ? '#' : '\0', '\0'};
+          if (has_length ? PyArg_Parse(arg, unit, ptr, length_ptr)
+                         : PyArg_Parse(arg, unit, ptr)) {
+            continue;
+          }
+        }
+        break;
+      }
+
+      // The conversion failed.
+      va_end(va);
+      goto done;
+    }
+    va_end(va);
+  }
+  success = true;
+
+done:
+  if (params != small_params) {
+    PyMem_Free(params);
+  }
+  return success;
+}
+#endif  // PY_VERSION_HEX >= 0x03070000
+
+/**
+ * Returns the part of an overload cache key that describes the indicated
+ * argument.  This is its type, with the low bits, which are always zero in a
+ * pointer to a type object, used to record whatever else about its value may
+ * decide whether an overload accepts it.  Returns 0 if the argument can't be
+ * described this way, in which case the call is not cached.
+ */
+static uintptr_t
+get_overload_key(PyObject *arg) {
+  uintptr_t key = (uintptr_t)Py_TYPE(arg);
+
+  if (PyLongOrInt_Check(arg)) {
+    // An integer is rejected by an overload taking a type that is too small
+    // to hold it.  One that doesn't even fit in a long long may or may not
+    // fit in a double, so we don't try to describe it.
+    int overflow;
+    PY_LONG_LONG value = PyLong_AsLongLongAndOverflow(arg, &overflow);
+    if (overflow != 0) {
+      return 0;
+    } else if (value < INT_MIN || value > INT_MAX) {
+      key |= 2;
+    } else if (value < SHRT_MIN || value > SHRT_MAX) {
+      key |= 1;
+    }
+  } else if (DtoolInstance_Check(arg) &&
+             (DtoolInstance_IS_CONST(arg) || DtoolInstance_NUM_EXPORTS(arg) != 0)) {
+    // A const instance is rejected by an overload taking a non-const one, and
+    // so is one with an exported buffer.
+    key |= 1;
+
+#if PY_MAJOR_VERSION >= 3
+  } else if (PyUnicode_Check(arg)) {
+    // A string is rejected by an overload taking a char unless it has one
+    // character, and by one taking a C++ string if it can't be encoded, which
+    // can't happen if it is pure ASCII.
+    if (!PyUnicode_IS_ASCII(arg)) {
+      return 0;
+    }
+    if (PyUnicode_GET_LENGTH(arg) == 1) {
+      key |= 1;
+    }
+#else
+  } else if (PyUnicode_Check(arg)) {
+    return 0;
+#endif
+
+  } else if (PyBytes_Check(arg)) {
+    if (PyBytes_GET_SIZE(arg) == 1) {
+      key |= 1;
+    }
+
+  } else if (!PyByteArray_Check(arg) && Py_TYPE(arg)->tp_as_buffer != nullptr &&
+             Py_TYPE(arg)->tp_as_buffer->bf_getbuffer != nullptr) {
+    // Whether an overload accepts some other buffer, such as a memoryview,
+    // may depend on whether it is read-only, which its type doesn't tell.
+    return 0;
+  }
+  return key;
+}
+
+/**
+ * Returns true if the indicated arguments match the key stored in the cache.
+ */
+static bool
+match_overload_key(const Dtool_OverloadCache &cache, PyObject *const *args,
+                   Py_ssize_t nargs) {
+  for (Py_ssize_t i = 0; i < nargs; ++i) {
+    // Compare the types first, which is cheap and rules out most mismatches.
+    uintptr_t key = cache._types[i];
+    if ((key & ~(uintptr_t)3) != (uintptr_t)Py_TYPE(args[i]) ||
+        key != get_overload_key(args[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Returns the index of the overload that accepted arguments like these the
+ * last time, or 0 if it isn't known.  The overloads before the returned index
+ * are known not to accept these arguments and may be skipped, but the one at
+ * the index must still check them, since the key doesn't capture everything
+ * about their values.
+ */
+int Dtool_FindOverload(const Dtool_OverloadCache &cache,
+                       PyObject *args, PyObject *kwds, bool self_const) {
+  if (cache._index == 0 || cache._num_args != PyTuple_GET_SIZE(args) ||
+      cache._self_const != self_const ||
+      (kwds != nullptr && PyDict_GET_SIZE(kwds) != 0)) {
+    return 0;
+  }
+  return match_overload_key(cache, &PyTuple_GET_ITEM(args, 0), cache._num_args)
+    ? cache._index : 0;
+}
+
+/**
+ * Variant of the above for arguments passed as a vector, with the names of
+ * the keyword arguments, if any, in the kwnames tuple.
+ */
+int Dtool_FindOverload(const Dtool_OverloadCache &cache,
+                       PyObject *const *args, Py_ssize_t nargs,
+                       PyObject *kwnames, bool self_const) {
+  if (cache._index == 0 || cache._num_args != nargs ||
+      cache._self_const != self_const ||
+      (kwnames != nullptr && PyTuple_GET_SIZE(kwnames) != 0)) {
+    return 0;
+  }
+  return match_overload_key(cache, args, nargs) ? cache._index : 0;
+}
+
+/**
+ * Stores the key describing the indicated arguments in the cache, along with
+ * the index of the overload that accepted them.  Does nothing if there are
+ * too many arguments to fit in the key, or if one of them can't be described
+ * by it.
+ */
+void _Dtool_StoreOverload(Dtool_OverloadCache &cache, int index,
+                          PyObject *const *args, Py_ssize_t nargs,
+                          bool self_const) {
+  if (nargs > DTOOL_OVERLOAD_CACHE_ARGS) {
+    return;
+  }
+  uintptr_t types[DTOOL_OVERLOAD_CACHE_ARGS];
+  for (Py_ssize_t i = 0; i < nargs; ++i) {
+    types[i] = get_overload_key(args[i]);
+    if (types[i] == 0) {
+      return;
+    }
+  }
+  cache._num_args = nargs;
+  cache._self_const = self_const;
+  for (Py_ssize_t i = 0; i < nargs; ++i) {
+    cache._types[i] = types[i];
+  }
+  cache._index = index;
+}
+
+// The list of Dtool_CallStats that have been called at least once.  It ends
+// at a sentinel, so that a null _next pointer means "not yet listed".
+static Dtool_CallStats call_stats_end = {nullptr, false, nullptr, 0, 0, 0};
+static Dtool_CallStats *call_stats_head = &call_stats_end;
+
+/**
+ * Called by a wrapper generated with -gil-telemetry before it calls the
+ * wrapped function.  Returns a timestamp to pass to Dtool_EndCall.
+ */
+uint64_t Dtool_BeginCall() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Called by a wrapper generated with -gil-telemetry after the function has
+ * returned and the interpreter lock has been reacquired, in order to record
+ * how long the call took.
+ */
+void Dtool_EndCall(Dtool_CallStats &stats, uint64_t start) {
+  uint64_t elapsed = Dtool_BeginCall() - start;
+
+  if (stats._next == nullptr) {
+    stats._next = call_stats_head;
+    call_stats_head = &stats;
+  }
+  ++stats._num_calls;
+  stats._total_ns += elapsed;
+  if (elapsed > stats._max_ns) {
+    stats._max_ns = elapsed;
+  }
+}
+
+/**
+ * Implements the _gil_telemetry() function, which is added to modules
+ * generated with -gil-telemetry.  Returns a dictionary mapping the prototype
+ * of each function that has been called to a tuple of (number of calls, total
+ * time, longest time, releases the GIL), with times in seconds.  If the
+ * optional argument is true, the counters are reset afterwards.
+ */
+PyObject *Dtool_GetCallStats(PyObject *, PyObject *args) {
+  int reset = 0;
+  if (!PyArg_ParseTuple(args, "|i:_gil_telemetry", &reset)) {
+    return nullptr;
+  }
+
+  // The same function may be timed by several wrappers, eg. by both the
+  // method and the slot that are generated for it; combine these.
+  std::map<std::string, Dtool_CallStats> combined;
+  for (Dtool_CallStats *stats = call_stats_head;
+       stats != &call_stats_end;
+       stats = stats->_next) {
+    Dtool_CallStats &entry = combined[stats->_name];
+    entry._releases_gil = stats->_releases_gil;
+    entry._num_calls += stats->_num_calls;
+    entry._total_ns += stats->_total_ns;
+    if (stats->_max_ns > entry._max_ns) {
+      entry._max_ns = stats->_max_ns;
+    }
+    if (reset) {
+      stats->_num_calls = 0;
+      stats->_total_ns = 0;
+      stats->_max_ns = 0;
+    }
+  }
+
+  PyObject *dict = PyDict_New();
+  for (const auto &item : combined) {
+    const Dtool_CallStats &entry = item.second;
+    if (entry._num_calls == 0) {
+      continue;
+    }
+    PyObject *value = Py_BuildValue("(KddN)",
+      (unsigned PY_LONG_LONG)entry._num_calls,
+      entry._total_ns * 1e-9, entry._max_ns * 1e-9,
+      PyBool_FromLong(entry._releases_gil));
+    if (value == nullptr ||
+        PyDict_SetItemString(dict, item.first.c_str(), value) != 0) {
+      Py_XDECREF(value);
+      Py_DECREF(dict);
+      return nullptr;
+    }
+    Py_DECREF(value);
+  }
+  return dict;
+}
+
+#if PY_VERSION_HEX >= 0x03090000
+/**
+ * Implements the vectorcall protocol for calling a class object: creates a
+ * new instance of the class, and calls init_func, which does the work of the
+ * class's tp_init, passing on the arguments without packing them into a
+ * tuple and a dict.
+ */
+PyObject *Dtool_VectorcallConstruct(PyObject *type, PyObject *const *args,
+                                    size_t nargsf, PyObject *kwnames,
+                                    FastcallInitFunction init_func) {
+  PyTypeObject *type_obj = (PyTypeObject *)type;
+  PyObject *self = type_obj->tp_new(type_obj, nullptr, nullptr);
+  if (self == nullptr) {
+    return nullptr;
+  }
+  if (init_func(self, args, PyVectorcall_NARGS(nargsf), kwnames) < 0) {
+    Py_DECREF(self);
+    return nullptr;
+  }
+  return self;
+}
+#endif  // PY_VERSION_HEX >= 0x03090000
+
 #endif  // HAVE_PYTHON
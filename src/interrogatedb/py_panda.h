@@ -7,6 +7,7 @@
 
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <string>
 
 #ifdef USE_DEBUG_PYTHON
@@ -65,6 +66,50 @@ struct Dtool_PyInstDef {
 
   // True if this is a "const" pointer.
   bool _is_const;
+
+  // The number of buffer views of the C++ object's storage that are currently
+  // exported.  See Dtool_GetVectorBuffer.
+  unsigned int _num_exports;
+};
+
+// Instances of a wrapped type that were recently freed, kept so that the next
+// instance of exactly that type can reuse the memory.  The list is chained
+// through the _ptr_to_object pointers, and holds at most DTOOL_FREE_LIST_SIZE
+// instances.  Define this to 0 to disable the free lists.
+#ifndef DTOOL_FREE_LIST_SIZE
+#define DTOOL_FREE_LIST_SIZE 32
+#endif
+
+struct Dtool_FreeList {
+  Dtool_PyInstDef *_head;
+  int _size;
+
+  // Links the lists that have been used, so that they can be emptied.
+  Dtool_FreeList *_next;
+  struct Dtool_PyTypedObject *_type;
+
+  uint64_t _num_reused;
+  uint64_t _num_allocated;
+};
+
+// Remembers by how much a pointer must be adjusted to cast it to or from a
+// number of other wrapped classes.  It is a small direct-mapped table keyed
+// by the other class, only accessed while holding the GIL.  Only casts with a
+// constant pointer adjustment are stored; those through virtual bases or
+// typecast operators are left to the generated cast functions.
+#ifndef DTOOL_CAST_CACHE_SIZE
+#define DTOOL_CAST_CACHE_SIZE 8
+#endif
+
+// Stored as the delta of a cast that is known to fail.
+#define DTOOL_CAST_FAILS PTRDIFF_MIN
+
+struct Dtool_CastCache {
+  struct Entry {
+    struct Dtool_PyTypedObject *_other;
+    ptrdiff_t _delta;
+  };
+  Entry _entries[DTOOL_CAST_CACHE_SIZE];
 };
 
 // The Class Definition Structor For a Dtool python type.
@@ -82,8 +127,32 @@ struct Dtool_PyTypedObject {
 
   CoerceFunction _Dtool_ConstCoerce;
   CoerceFunction _Dtool_Coerce;
+
+  // Left zero-initialized by the generated definitions.
+  Dtool_FreeList _free_list;
+  Dtool_CastCache _upcast_cache;
+  Dtool_CastCache _downcast_cache;
 };
 
+EXPCL_PYPANDA PyObject *Dtool_AllocInstance(PyTypeObject *type, Dtool_PyTypedObject &classdef);
+EXPCL_PYPANDA void Dtool_FreeInstanceMemory(PyObject *self, Dtool_PyTypedObject &classdef);
+EXPCL_PYPANDA void Dtool_ClearFreeLists();
+EXPCL_PYPANDA PyObject *Dtool_GetFreeListStats(PyObject *self, PyObject *noargs);
+
+// Used by the generated buffer protocol of vectors of numbers.  While views
+// are exported, the methods of the vector that might reallocate its storage
+// are refused, and so is passing it to a C++ function by non-const reference.
+EXPCL_PYPANDA int Dtool_GetVectorBuffer(PyObject *self, Py_buffer *view, int flags, void *data, Py_ssize_t size, Py_ssize_t itemsize, const char *format);
+EXPCL_PYPANDA void Dtool_ReleaseVectorBuffer(PyObject *self, Py_buffer *view);
+EXPCL_PYPANDA bool Dtool_CheckNoExports(PyObject *self, const char *method_name);
+
+// Code generated with interrogate -cache-wrappers looks up the wrappers of
+// reference-counted objects here, so that each object has only one live
+// wrapper at a time.
+EXPCL_PYPANDA PyObject *Dtool_FindWrapper(void *local_this, Dtool_PyTypedObject &known_class, bool is_const, int type_index);
+EXPCL_PYPANDA PyObject *Dtool_RememberWrapper(PyObject *self);
+EXPCL_PYPANDA void Dtool_ForgetWrapper(PyObject *self);
+
 // This is now simply a forward declaration.  The actual definition is created
 // by the code generator.
 #define Define_Dtool_Class(MODULE_NAME, CLASS_NAME, PUBLIC_NAME) \
@@ -94,14 +163,14 @@ struct Dtool_PyTypedObject {
 #define Define_Dtool_new(CLASS_NAME,CNAME)\
 static PyObject *Dtool_new_##CLASS_NAME(PyTypeObject *type, PyObject *args, PyObject *kwds) {\
   (void) args; (void) kwds;\
-  PyObject *self = type->tp_alloc(type, 0);\
+  PyObject *self = Dtool_AllocInstance(type, Dtool_##CLASS_NAME);\
   ((Dtool_PyInstDef *)self)->_signature = PY_PANDA_SIGNATURE;\
   ((Dtool_PyInstDef *)self)->_My_Type = &Dtool_##CLASS_NAME;\
   return self;\
 }
 
 // The following used to be in the above macro, but it doesn't seem to be
-// necessary as tp_alloc memsets the object to 0.
+// necessary as Dtool_AllocInstance returns the object zeroed.
 //  ((Dtool_PyInstDef *)self)->_ptr_to_object = NULL;
 //  ((Dtool_PyInstDef *)self)->_memory_rules = false;
 //  ((Dtool_PyInstDef *)self)->_is_const = false;
@@ -110,7 +179,7 @@ static PyObject *Dtool_new_##CLASS_NAME(PyTypeObject *type, PyObject *args, PyOb
 #ifdef NDEBUG
 #define Define_Dtool_FreeInstance_Private(CLASS_NAME,CNAME)\
 static void Dtool_FreeInstance_##CLASS_NAME(PyObject *self) {\
-  Py_TYPE(self)->tp_free(self);\
+  Dtool_FreeInstanceMemory(self, Dtool_##CLASS_NAME);\
 }
 #else // NDEBUG
 #define Define_Dtool_FreeInstance_Private(CLASS_NAME,CNAME)\
@@ -121,7 +190,7 @@ static void Dtool_FreeInstance_##CLASS_NAME(PyObject *self) {\
            << " which interrogate cannot delete.\n"; \
     }\
   }\
-  Py_TYPE(self)->tp_free(self);\
+  Dtool_FreeInstanceMemory(self, Dtool_##CLASS_NAME);\
 }
 #endif  // NDEBUG
 
@@ -132,33 +201,35 @@ static void Dtool_FreeInstance_##CLASS_NAME(PyObject *self) {\
       delete (CNAME *)DtoolInstance_VOID_PTR(self);\
     }\
   }\
-  Py_TYPE(self)->tp_free(self);\
+  Dtool_FreeInstanceMemory(self, Dtool_##CLASS_NAME);\
 }
 
 #define Define_Dtool_FreeInstanceRef(CLASS_NAME,CNAME)\
 static void Dtool_FreeInstance_##CLASS_NAME(PyObject *self) {\
+  Dtool_ForgetWrapper(self);\
   if (DtoolInstance_VOID_PTR(self) != nullptr) {\
     if (((Dtool_PyInstDef *)self)->_memory_rules) {\
       unref_delete((CNAME *)DtoolInstance_VOID_PTR(self));\
     }\
   }\
-  Py_TYPE(self)->tp_free(self);\
+  Dtool_FreeInstanceMemory(self, Dtool_##CLASS_NAME);\
 }
 
 #define Define_Dtool_FreeInstanceRef_Private(CLASS_NAME,CNAME)\
 static void Dtool_FreeInstance_##CLASS_NAME(PyObject *self) {\
+  Dtool_ForgetWrapper(self);\
   if (DtoolInstance_VOID_PTR(self) != nullptr) {\
     if (((Dtool_PyInstDef *)self)->_memory_rules) {\
       unref_delete((ReferenceCount *)(CNAME *)DtoolInstance_VOID_PTR(self));\
     }\
   }\
-  Py_TYPE(self)->tp_free(self);\
+  Dtool_FreeInstanceMemory(self, Dtool_##CLASS_NAME);\
 }
 
 #define Define_Dtool_Simple_FreeInstance(CLASS_NAME, CNAME)\
 static void Dtool_FreeInstance_##CLASS_NAME(PyObject *self) {\
   ((Dtool_InstDef_##CLASS_NAME *)self)->_value.~##CLASS_NAME();\
-  Py_TYPE(self)->tp_free(self);\
+  Dtool_FreeInstanceMemory(self, Dtool_##CLASS_NAME);\
 }
 
 // Use DtoolInstance_Check to check whether a PyObject* is a DtoolInstance.
@@ -169,17 +240,30 @@ static void Dtool_FreeInstance_##CLASS_NAME(PyObject *self) {\
 // These macros access the DtoolInstance without error checking.
 #define DtoolInstance_TYPE(obj) (((Dtool_PyInstDef *)obj)->_My_Type)
 #define DtoolInstance_IS_CONST(obj) (((Dtool_PyInstDef *)obj)->_is_const)
+#define DtoolInstance_NUM_EXPORTS(obj) (((Dtool_PyInstDef *)obj)->_num_exports)
 #define DtoolInstance_VOID_PTR(obj) (((Dtool_PyInstDef *)obj)->_ptr_to_object)
 #define DtoolInstance_INIT_PTR(obj, ptr) { ((Dtool_PyInstDef *)obj)->_ptr_to_object = (void*)(ptr); }
-#define DtoolInstance_UPCAST(obj, type) (((Dtool_PyInstDef *)(obj))->_My_Type->_Dtool_UpcastInterface((obj), &(type)))
+#define DtoolInstance_UPCAST(obj, type) (DtoolInstance_Upcast((obj), &(type)))
 
 // ** HACK ** allert.. Need to keep a runtime type dictionary ... that is
 // forward declared of typed object.  We rely on the fact that typed objects
 // are uniquly defined by an integer.
 
-typedef std::map<std::string, Dtool_PyTypedObject *> Dtool_TypeMap;
+// The type map is keyed on a copy of each name, owned by the map, since the
+// module that registered a type may be unloaded again.  Names are looked up
+// directly from the static export tables of the modules, which makes resolving
+// the types at import time a matter of hashing.
+struct Dtool_NameHash {
+  INLINE size_t operator () (const char *name) const;
+};
+struct Dtool_NameEqual {
+  INLINE bool operator () (const char *a, const char *b) const;
+};
+
+typedef std::unordered_map<const char *, Dtool_PyTypedObject *, Dtool_NameHash, Dtool_NameEqual> Dtool_TypeMap;
 
 EXPCL_PYPANDA Dtool_TypeMap *Dtool_GetGlobalTypeMap();
+EXPCL_PYPANDA void Dtool_RegisterType(Dtool_TypeMap *type_map, const char *name, Dtool_PyTypedObject *type);
 
 /**
 
@@ -193,6 +277,11 @@ EXPCL_PYPANDA bool Dtool_Call_ExtractThisPointer(PyObject *self, Dtool_PyTypedOb
 EXPCL_PYPANDA bool Dtool_Call_ExtractThisPointer_NonConst(PyObject *self, Dtool_PyTypedObject &classdef,
                                                           void **answer, const char *method_name);
 
+INLINE size_t Dtool_CastCacheSlot(const Dtool_PyTypedObject *other);
+INLINE void *DtoolInstance_Upcast(PyObject *self, Dtool_PyTypedObject *requested_type);
+EXPCL_PYPANDA void *Dtool_CacheUpcast(PyObject *self, Dtool_PyTypedObject *requested_type, void *result);
+EXPCL_PYPANDA void *Dtool_CacheUpcastFailure(PyObject *self, Dtool_PyTypedObject *requested_type);
+
 template<class T> INLINE bool DtoolInstance_GetPointer(PyObject *self, T *&into);
 template<class T> INLINE bool DtoolInstance_GetPointer(PyObject *self, T *&into, Dtool_PyTypedObject &classdef);
 
@@ -247,6 +336,8 @@ EXPCL_PYPANDA PyTypeObject *Dtool_EnumType_Create(const char *name, PyObject *na
                                                   const char *module = nullptr);
 INLINE long Dtool_EnumValue_AsLong(PyObject *value);
 
+INLINE PyObject *Dtool_GenericGetAttrOrNull(PyObject *self, PyObject *name);
+
 
 /**
 
@@ -304,7 +395,7 @@ INLINE int DTool_PyInit_Finalize(PyObject *self, void *This, Dtool_PyTypedObject
 // A heler function to glu methed definition together .. that can not be done
 // at code generation time becouse of multiple generation passes in
 // interigate..
-typedef std::map<std::string, PyMethodDef *> MethodDefmap;
+typedef std::unordered_map<const char *, PyMethodDef *, Dtool_NameHash, Dtool_NameEqual> MethodDefmap;
 
 // We need a way to runtime merge compile units into a python "Module" .. this
 // is done with the fallowing structors and code.. along with the support of
@@ -327,6 +418,11 @@ EXPCL_PYPANDA PyObject *Dtool_PyModuleInitHelper(const LibraryDef *defs[], PyMod
 EXPCL_PYPANDA PyObject *Dtool_PyModuleInitHelper(const LibraryDef *defs[], const char *modulename);
 #endif
 
+// Used by modules generated with interrogate -lazy-types to add a class to the
+// module without initializing it yet.
+EXPCL_PYPANDA void Dtool_AddLazyType(PyObject *module, const char *name, Dtool_PyTypedObject *type);
+INLINE void Dtool_EnsureTypeReady(Dtool_PyTypedObject &type);
+
 // HACK.... Be carefull Dtool_BorrowThisReference This function can be used to
 // grab the "THIS" pointer from an object and use it Required to support fom
 // historical inharatence in the for of "is this instance of"..
@@ -359,6 +455,96 @@ EXPCL_PYPANDA bool Dtool_ExtractOptionalArg(PyObject **result, PyObject *args,
 EXPCL_PYPANDA  bool Dtool_ExtractOptionalArg(PyObject **result, PyObject *args,
                                              PyObject *kwds);
 
+#if PY_VERSION_HEX >= 0x03070000
+/**
+ * Variants of the above for wrappers that receive their arguments as a
+ * vector (METH_FASTCALL), which interrogate generates when run with
+ * -fastcall.
+ */
+ALWAYS_INLINE bool Dtool_CheckNoArgs(Py_ssize_t nargs, PyObject *kwnames);
+EXPCL_PYPANDA bool Dtool_ExtractArg(PyObject **result, PyObject *const *args,
+                                    Py_ssize_t nargs, PyObject *kwnames,
+                                    const char *keyword);
+EXPCL_PYPANDA bool Dtool_ExtractArg(PyObject **result, PyObject *const *args,
+                                    Py_ssize_t nargs, PyObject *kwnames);
+EXPCL_PYPANDA bool Dtool_ExtractOptionalArg(PyObject **result, PyObject *const *args,
+                                            Py_ssize_t nargs, PyObject *kwnames,
+                                            const char *keyword);
+EXPCL_PYPANDA bool Dtool_ExtractOptionalArg(PyObject **result, PyObject *const *args,
+                                            Py_ssize_t nargs, PyObject *kwnames);
+EXPCL_PYPANDA bool Dtool_ParseFastcallArgs(PyObject *const *args, Py_ssize_t nargs,
+                                           PyObject *kwnames,
+                                           const char *const *keywords,
+                                           PyObject **keyword_names,
+                                           const char *format, ...);
+#endif
+
+/**
+ * The wrapper for an overloaded function remembers which overload was chosen
+ * for the last combination of argument types it was called with, so that it
+ * can skip straight past the overloads that are known not to match when it is
+ * called with the same types again.  Besides the types, the key records what
+ * else may cause an overload to reject an argument: the constness of an
+ * instance, the range of an integer, and whether a string has one character.
+ * Arguments that may be rejected for other reasons, such as a read-only
+ * buffer, are not cached, and neither are overloads taking a scoped enum or
+ * an array, which check more about the value than the key can record.
+ */
+#define DTOOL_OVERLOAD_CACHE_ARGS 4
+
+struct Dtool_OverloadCache {
+  int _index;
+  bool _self_const;
+  Py_ssize_t _num_args;
+  uintptr_t _types[DTOOL_OVERLOAD_CACHE_ARGS];
+};
+
+EXPCL_PYPANDA int Dtool_FindOverload(const Dtool_OverloadCache &cache,
+                                     PyObject *args, PyObject *kwds,
+                                     bool self_const);
+EXPCL_PYPANDA int Dtool_FindOverload(const Dtool_OverloadCache &cache,
+                                     PyObject *const *args, Py_ssize_t nargs,
+                                     PyObject *kwnames, bool self_const);
+ALWAYS_INLINE void Dtool_RememberOverload(Dtool_OverloadCache &cache, int &start,
+                                          int index, PyObject *args,
+                                          PyObject *kwds, bool self_const);
+ALWAYS_INLINE void Dtool_RememberOverload(Dtool_OverloadCache &cache, int &start,
+                                          int index, PyObject *const *args,
+                                          Py_ssize_t nargs, PyObject *kwnames,
+                                          bool self_const);
+EXPCL_PYPANDA void _Dtool_StoreOverload(Dtool_OverloadCache &cache, int index,
+                                        PyObject *const *args, Py_ssize_t nargs,
+                                        bool self_const);
+
+/**
+ * Timing counters for a single wrapped function, kept by wrappers generated
+ * with interrogate -gil-telemetry.  Each one is linked into a global list the
+ * first time its function returns.  The counters are only updated while the
+ * interpreter lock is held.
+ */
+struct Dtool_CallStats {
+  const char *_name;
+  bool _releases_gil;
+  Dtool_CallStats *_next;
+  uint64_t _num_calls;
+  uint64_t _total_ns;
+  uint64_t _max_ns;
+};
+
+EXPCL_PYPANDA uint64_t Dtool_BeginCall();
+EXPCL_PYPANDA void Dtool_EndCall(Dtool_CallStats &stats, uint64_t start);
+EXPCL_PYPANDA PyObject *Dtool_GetCallStats(PyObject *self, PyObject *args);
+
+#if PY_VERSION_HEX >= 0x03090000
+// The vectorcall constructor of a class, installed as tp_vectorcall, calls
+// this with a function that does the work of tp_init.
+typedef int (*FastcallInitFunction)(PyObject *self, PyObject *const *args,
+                                    Py_ssize_t nargs, PyObject *kwnames);
+EXPCL_PYPANDA PyObject *Dtool_VectorcallConstruct(PyObject *type, PyObject *const *args,
+                                                  size_t nargsf, PyObject *kwnames,
+                                                  FastcallInitFunction init_func);
+#endif
+
 /**
  * These functions convert a C++ value into the corresponding Python object.
  * This used to be generated by the code generator, but it seems more reliable
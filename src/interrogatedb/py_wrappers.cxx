@@ -65,6 +65,93 @@ static PyObject *Dtool_WrapperBase_repr(PyObject *self) {
   return result;
 }
 
+// The sequence and mapping wrappers are created on every access of such a
+// property, eg. in a loop over something.children[i], and are usually freed
+// right after.  The memory of freed wrappers is kept for reuse, chained
+// through _self.  The most recently created wrapper for each object and
+// property is also remembered, so that repeated accesses return the same
+// wrapper for as long as it stays alive.
+union Dtool_PropertyWrapper {
+  Dtool_WrapperBase _base;
+  Dtool_SequenceWrapper _sequence;
+  Dtool_MutableSequenceWrapper _mutable_sequence;
+  Dtool_MappingWrapper _mapping;
+};
+
+#ifndef DTOOL_RECENT_WRAPPERS_SIZE
+#define DTOOL_RECENT_WRAPPERS_SIZE 16
+#endif
+
+static Dtool_WrapperBase *wrapper_free_list = nullptr;
+static int wrapper_free_list_size = 0;
+static bool wrapper_free_list_enabled = true;
+static Dtool_WrapperBase *recent_wrappers[DTOOL_RECENT_WRAPPERS_SIZE];
+
+/**
+ * Returns the entry in recent_wrappers for the given property of the given
+ * object.
+ */
+static Dtool_WrapperBase *&Dtool_RecentWrapper(PyObject *self, const char *name) {
+  uintptr_t bits = (uintptr_t)self ^ ((uintptr_t)name << 3);
+  return recent_wrappers[((bits >> 4) ^ (bits >> 10)) & (DTOOL_RECENT_WRAPPERS_SIZE - 1)];
+}
+
+/**
+ * Returns a wrapper of the given type for the given property of the given
+ * object.  This is the wrapper that was last returned for it if that one is
+ * still alive, or otherwise a new one.  Either way, the caller should assign
+ * all of the function pointers.
+ */
+static Dtool_WrapperBase *Dtool_NewPropertyWrapper(PyTypeObject *type, PyObject *self, const char *name) {
+  Dtool_WrapperBase *&recent = Dtool_RecentWrapper(self, name);
+  if (recent != nullptr && recent->_self == self && recent->_name == name &&
+      Py_TYPE(recent) == type) {
+    Py_INCREF((PyObject *)recent);
+    return recent;
+  }
+
+  Dtool_WrapperBase *wrap = wrapper_free_list;
+  if (wrap != nullptr) {
+    wrapper_free_list = (Dtool_WrapperBase *)wrap->_self;
+    --wrapper_free_list_size;
+  } else {
+    wrap = (Dtool_WrapperBase *)PyObject_MALLOC(sizeof(Dtool_PropertyWrapper));
+    if (wrap == nullptr) {
+      return (Dtool_WrapperBase *)PyErr_NoMemory();
+    }
+  }
+
+  (void)PyObject_INIT(wrap, type);
+  Py_XINCREF(self);
+  wrap->_self = self;
+  wrap->_name = name;
+  recent = wrap;
+  return wrap;
+}
+
+/**
+ * Deallocates a wrapper created by Dtool_NewPropertyWrapper, keeping its
+ * memory for reuse if the free list is not full.
+ */
+static void Dtool_PropertyWrapper_dealloc(PyObject *self) {
+  Dtool_WrapperBase *wrap = (Dtool_WrapperBase *)self;
+  nassertv(wrap);
+
+  Dtool_WrapperBase *&recent = Dtool_RecentWrapper(wrap->_self, wrap->_name);
+  if (recent == wrap) {
+    recent = nullptr;
+  }
+  Py_XDECREF(wrap->_self);
+
+  if (wrapper_free_list_enabled && wrapper_free_list_size < DTOOL_FREE_LIST_SIZE) {
+    wrap->_self = (PyObject *)wrapper_free_list;
+    wrapper_free_list = wrap;
+    ++wrapper_free_list_size;
+  } else {
+    Py_TYPE(self)->tp_free(self);
+  }
+}
+
 static PyObject *Dtool_SequenceWrapper_repr(PyObject *self) {
   Dtool_SequenceWrapper *wrap = (Dtool_SequenceWrapper *)self;
   nassertr(wrap, nullptr);
@@ -1183,11 +1270,6 @@ Dtool_StaticProperty_set(PyGetSetDescrObject *descr, PyObject *obj, PyObject *va
  * This wraps around a property that exposes a sequence interface.
  */
 Dtool_SequenceWrapper *Dtool_NewSequenceWrapper(PyObject *self, const char *name) {
-  Dtool_SequenceWrapper *wrap = (Dtool_SequenceWrapper *)PyObject_MALLOC(sizeof(Dtool_SequenceWrapper));
-  if (wrap == nullptr) {
-    return (Dtool_SequenceWrapper *)PyErr_NoMemory();
-  }
-
   static PySequenceMethods seq_methods = {
     Dtool_SequenceWrapper_length,
     nullptr, // sq_concat
@@ -1212,7 +1294,7 @@ Dtool_SequenceWrapper *Dtool_NewSequenceWrapper(PyObject *self, const char *name
     "sequence wrapper",
     sizeof(Dtool_SequenceWrapper),
     0, // tp_itemsize
-    Dtool_WrapperBase_dealloc,
+    Dtool_PropertyWrapper_dealloc,
     0, // tp_vectorcall_offset
     nullptr, // tp_getattr
     nullptr, // tp_setattr
@@ -1275,10 +1357,10 @@ Dtool_SequenceWrapper *Dtool_NewSequenceWrapper(PyObject *self, const char *name
     _register_collection((PyTypeObject *)&wrapper_type, "Sequence");
   }
 
-  (void)PyObject_INIT(wrap, &wrapper_type);
-  Py_XINCREF(self);
-  wrap->_base._self = self;
-  wrap->_base._name = name;
+  Dtool_SequenceWrapper *wrap = (Dtool_SequenceWrapper *)Dtool_NewPropertyWrapper(&wrapper_type, self, name);
+  if (wrap == nullptr) {
+    return nullptr;
+  }
   wrap->_len_func = nullptr;
   wrap->_getitem_func = nullptr;
   return wrap;
@@ -1288,11 +1370,6 @@ Dtool_SequenceWrapper *Dtool_NewSequenceWrapper(PyObject *self, const char *name
  * This wraps around a property that exposes a mutable sequence interface.
  */
 Dtool_MutableSequenceWrapper *Dtool_NewMutableSequenceWrapper(PyObject *self, const char *name) {
-  Dtool_MutableSequenceWrapper *wrap = (Dtool_MutableSequenceWrapper *)PyObject_MALLOC(sizeof(Dtool_MutableSequenceWrapper));
-  if (wrap == nullptr) {
-    return (Dtool_MutableSequenceWrapper *)PyErr_NoMemory();
-  }
-
   static PySequenceMethods seq_methods = {
     Dtool_SequenceWrapper_length,
     nullptr, // sq_concat
@@ -1323,7 +1400,7 @@ Dtool_MutableSequenceWrapper *Dtool_NewMutableSequenceWrapper(PyObject *self, co
     "sequence wrapper",
     sizeof(Dtool_MutableSequenceWrapper),
     0, // tp_itemsize
-    Dtool_WrapperBase_dealloc,
+    Dtool_PropertyWrapper_dealloc,
     0, // tp_vectorcall_offset
     nullptr, // tp_getattr
     nullptr, // tp_setattr
@@ -1386,10 +1463,10 @@ Dtool_MutableSequenceWrapper *Dtool_NewMutableSequenceWrapper(PyObject *self, co
     _register_collection((PyTypeObject *)&wrapper_type, "MutableSequence");
   }
 
-  (void)PyObject_INIT(wrap, &wrapper_type);
-  Py_XINCREF(self);
-  wrap->_base._self = self;
-  wrap->_base._name = name;
+  Dtool_MutableSequenceWrapper *wrap = (Dtool_MutableSequenceWrapper *)Dtool_NewPropertyWrapper(&wrapper_type, self, name);
+  if (wrap == nullptr) {
+    return nullptr;
+  }
   wrap->_len_func = nullptr;
   wrap->_getitem_func = nullptr;
   wrap->_setitem_func = nullptr;
@@ -1401,11 +1478,6 @@ Dtool_MutableSequenceWrapper *Dtool_NewMutableSequenceWrapper(PyObject *self, co
  * This wraps around a mapping interface, with getitem function.
  */
 Dtool_MappingWrapper *Dtool_NewMappingWrapper(PyObject *self, const char *name) {
-  Dtool_MappingWrapper *wrap = (Dtool_MappingWrapper *)PyObject_MALLOC(sizeof(Dtool_MappingWrapper));
-  if (wrap == nullptr) {
-    return (Dtool_MappingWrapper *)PyErr_NoMemory();
-  }
-
   static PySequenceMethods seq_methods = {
     Dtool_SequenceWrapper_length,
     nullptr, // sq_concat
@@ -1438,7 +1510,7 @@ Dtool_MappingWrapper *Dtool_NewMappingWrapper(PyObject *self, const char *name)
     "mapping wrapper",
     sizeof(Dtool_MappingWrapper),
     0, // tp_itemsize
-    Dtool_WrapperBase_dealloc,
+    Dtool_PropertyWrapper_dealloc,
     0, // tp_vectorcall_offset
     nullptr, // tp_getattr
     nullptr, // tp_setattr
@@ -1501,10 +1573,10 @@ Dtool_MappingWrapper *Dtool_NewMappingWrapper(PyObject *self, const char *name)
     _register_collection((PyTypeObject *)&wrapper_type, "Mapping");
   }
 
-  (void)PyObject_INIT(wrap, &wrapper_type);
-  Py_XINCREF(self);
-  wrap->_base._self = self;
-  wrap->_base._name = name;
+  Dtool_MappingWrapper *wrap = (Dtool_MappingWrapper *)Dtool_NewPropertyWrapper(&wrapper_type, self, name);
+  if (wrap == nullptr) {
+    return nullptr;
+  }
   wrap->_keys._len_func = nullptr;
   wrap->_keys._getitem_func = nullptr;
   wrap->_getitem_func = nullptr;
@@ -1516,11 +1588,6 @@ Dtool_MappingWrapper *Dtool_NewMappingWrapper(PyObject *self, const char *name)
  * This wraps around a mapping interface, with getitem/setitem functions.
  */
 Dtool_MappingWrapper *Dtool_NewMutableMappingWrapper(PyObject *self, const char *name) {
-  Dtool_MappingWrapper *wrap = (Dtool_MappingWrapper *)PyObject_MALLOC(sizeof(Dtool_MappingWrapper));
-  if (wrap == nullptr) {
-    return (Dtool_MappingWrapper *)PyErr_NoMemory();
-  }
-
   static PySequenceMethods seq_methods = {
     Dtool_SequenceWrapper_length,
     nullptr, // sq_concat
@@ -1558,7 +1625,7 @@ Dtool_MappingWrapper *Dtool_NewMutableMappingWrapper(PyObject *self, const char
     "mapping wrapper",
     sizeof(Dtool_MappingWrapper),
     0, // tp_itemsize
-    Dtool_WrapperBase_dealloc,
+    Dtool_PropertyWrapper_dealloc,
     0, // tp_vectorcall_offset
     nullptr, // tp_getattr
     nullptr, // tp_setattr
@@ -1621,10 +1688,10 @@ Dtool_MappingWrapper *Dtool_NewMutableMappingWrapper(PyObject *self, const char
     _register_collection((PyTypeObject *)&wrapper_type, "MutableMapping");
   }
 
-  (void)PyObject_INIT(wrap, &wrapper_type);
-  Py_XINCREF(self);
-  wrap->_base._self = self;
-  wrap->_base._name = name;
+  Dtool_MappingWrapper *wrap = (Dtool_MappingWrapper *)Dtool_NewPropertyWrapper(&wrapper_type, self, name);
+  if (wrap == nullptr) {
+    return nullptr;
+  }
   wrap->_keys._len_func = nullptr;
   wrap->_keys._getitem_func = nullptr;
   wrap->_getitem_func = nullptr;
@@ -1632,6 +1699,21 @@ Dtool_MappingWrapper *Dtool_NewMutableMappingWrapper(PyObject *self, const char
   return wrap;
 }
 
+/**
+ * Frees the memory of the wrappers that are kept for reuse, and stops keeping
+ * it from now on.  This is called when the module is unloaded.
+ */
+void Dtool_ClearWrapperFreeList() {
+  wrapper_free_list_enabled = false;
+
+  while (wrapper_free_list != nullptr) {
+    Dtool_WrapperBase *wrap = wrapper_free_list;
+    wrapper_free_list = (Dtool_WrapperBase *)wrap->_self;
+    PyObject_FREE(wrap);
+  }
+  wrapper_free_list_size = 0;
+}
+
 /**
  * Creates a generator that invokes a given function with the given self arg.
  */
@@ -13,3 +13,22 @@
   #define TARGET test_lib
   #define SOURCES test_lib.cxx test_lib.h
 #end test_bin_target
+
+#begin test_lib_target
+  #define TARGET test_calls
+  #define SOURCES test_calls.cxx test_calls.h
+  #define IGATESCAN all
+  #define INTERROGATE_OPTIONS $[INTERROGATE_OPTIONS] -cache-wrappers
+#end test_lib_target
+
+#begin test_bin_target
+  #define TARGET time_preprocess
+  #define LOCAL_LIBS cppParser $[LOCAL_LIBS]
+  #define SOURCES time_preprocess.cxx
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET time_parse
+  #define LOCAL_LIBS cppParser $[LOCAL_LIBS]
+  #define SOURCES time_parse.cxx
+#end test_bin_target
@@ -0,0 +1,98 @@
+"""
+Checks that the interrogate-generated bindings for test_calls.h export the
+elements of vectors of numbers through the buffer protocol, so that they can
+be read and written through a memoryview, and that such a vector can't be
+resized from Python while a view of it exists.
+
+    interrogate -python-native -module test_calls -library test_calls \
+        ... test_calls.h
+    interrogate_module -python-native -module test_calls \
+        -library test_calls ...
+    python test_buffers.py
+"""
+
+import sys
+
+from test_calls import CallVectors
+
+
+def check(name, result, expected):
+    """Returns 0 if the result was as expected, or 1 after reporting it."""
+
+    if result != expected:
+        print("%s: got %r, expected %r" % (name, result, expected))
+        return 1
+    return 0
+
+
+def round_trip(name, make, total, scale, format, itemsize):
+    """Reads the elements of a new vector through a memoryview, changes one of
+    them, and checks that the C++ code sees the change.  Returns the number of
+    failures."""
+
+    failures = 0
+    values = make(5, scale)
+    view = memoryview(values)
+    failures += check(name + " format", view.format, format)
+    failures += check(name + " itemsize", view.itemsize, itemsize)
+    failures += check(name + " shape", view.shape, (5,))
+    failures += check(name + " readonly", view.readonly, False)
+    failures += check(name + " elements", view.tolist(),
+                      [i * scale for i in range(5)])
+
+    view[2] = scale * 10
+    view.release()
+    failures += check(name + " sum", total(values), scale * (0 + 1 + 10 + 3 + 4))
+
+    view = memoryview(make(0, scale))
+    failures += check(name + " empty", view.tolist(), [])
+    view.release()
+    return failures
+
+
+def main():
+    failures = 0
+    failures += round_trip("floats", CallVectors.make_floats,
+                           CallVectors.sum_floats, 0.5, "f", 4)
+    failures += round_trip("doubles", CallVectors.make_doubles,
+                           CallVectors.sum_doubles, 0.25, "d", 8)
+    failures += round_trip("ints", CallVectors.make_ints,
+                           CallVectors.sum_ints, 3, "i", 4)
+
+    # While a view exists, the vector may still be read, but not passed to a
+    # function that might reallocate it.
+    values = CallVectors.make_ints(3, 1)
+    view = memoryview(values)
+    failures += check("sum while exported", CallVectors.sum_ints(values), 3)
+    try:
+        CallVectors.append_int(values, 7)
+        print("append_int was allowed while a buffer is exported")
+        failures += 1
+    except BufferError:
+        pass
+    second = memoryview(values)
+    view.release()
+    try:
+        CallVectors.append_int(values, 7)
+        print("append_int was allowed while a second buffer is exported")
+        failures += 1
+    except BufferError:
+        pass
+    second.release()
+
+    # Once the views are gone, it may be resized again.
+    CallVectors.append_int(values, 7)
+    view = memoryview(values)
+    failures += check("after append", view.tolist(), [0, 1, 2, 7])
+    view.release()
+
+    if failures:
+        print("%d checks failed" % (failures))
+        return 1
+
+    print("All vectors were exported as expected.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
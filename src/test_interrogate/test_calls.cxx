@@ -0,0 +1,428 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_calls.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "test_calls.h"
+#include "pnotify.h"
+
+/**
+ *
+ */
+CallTarget::
+CallTarget() : _value(0), _scale(1.0f) {
+}
+
+/**
+ *
+ */
+CallTarget::
+CallTarget(int value, float scale) : _value(value), _scale(scale) {
+}
+
+/**
+ *
+ */
+int CallTarget::
+get_value() const {
+  return _value;
+}
+
+/**
+ *
+ */
+void CallTarget::
+set_value(int value) {
+  _value = value;
+}
+
+/**
+ * Returns a combination of the arguments with the stored value.
+ */
+float CallTarget::
+mix(int a, float b, float c, bool negate) const {
+  float result = (_value + a) * _scale + b * c;
+  return negate ? -result : result;
+}
+
+/**
+ * Takes on the value of the other object.
+ */
+void CallTarget::
+take(const CallTarget &other) {
+  _value = other._value;
+  _scale = other._scale;
+}
+
+/**
+ * Sets the value.
+ */
+void CallTarget::
+assign(int value) {
+  _value = value;
+}
+
+/**
+ * Sets the scale.
+ */
+void CallTarget::
+assign(float scale) {
+  _scale = scale;
+}
+
+/**
+ * Takes on the value of the other object.
+ */
+void CallTarget::
+assign(const CallTarget &other) {
+  _value = other._value;
+  _scale = other._scale;
+}
+
+/**
+ *
+ */
+int CallTarget::
+add(int a, int b) {
+  return a + b;
+}
+
+/**
+ *
+ */
+float CallTarget::
+add(float a, float b) {
+  return a + b;
+}
+
+/**
+ *
+ */
+CallWorker::
+CallWorker() : _count(0) {
+}
+
+/**
+ * Does some pointless work, proportional to the given number of iterations.
+ * Returns the number of times this has been called.
+ */
+int CallWorker::
+spin(int iterations) {
+  volatile unsigned int hash = 0;
+  for (int i = 0; i < iterations; ++i) {
+    hash = hash * 31 + i;
+  }
+  return ++_count;
+}
+
+/**
+ *
+ */
+int CallWorker::
+get_count() const {
+  return _count;
+}
+
+/**
+ *
+ */
+CallContainer::
+CallContainer() {
+  for (size_t i = 0; i < 4; ++i) {
+    _items[i] = (int)i;
+  }
+}
+
+/**
+ *
+ */
+size_t CallContainer::
+get_num_items() const {
+  return 4;
+}
+
+/**
+ *
+ */
+int CallContainer::
+get_item(size_t n) const {
+  nassertr(n < 4, 0);
+  return _items[n];
+}
+
+/**
+ *
+ */
+void CallContainer::
+set_item(size_t n, int value) {
+  nassertv(n < 4);
+  _items[n] = value;
+}
+
+/**
+ * Returns true if the given name is that of one of the items.
+ */
+bool CallContainer::
+has_named(const std::string &name) const {
+  return name.size() == 1 && name[0] >= 'a' && name[0] < 'a' + 4;
+}
+
+/**
+ * Returns the item with the given name, which is a letter from "a" to "d".
+ */
+int CallContainer::
+get_named(const std::string &name) const {
+  nassertr(has_named(name), 0);
+  return _items[name[0] - 'a'];
+}
+
+/**
+ * Returns the length of the given attribute name.
+ */
+int CallContainer::
+__getattr__(const std::string &name) const {
+  return (int)name.size();
+}
+
+/**
+ * Returns a vector of count floats.
+ */
+pvector<float> CallVectors::
+make_floats(int count, float scale) {
+  pvector<float> values;
+  for (int i = 0; i < count; ++i) {
+    values.push_back(i * scale);
+  }
+  return values;
+}
+
+/**
+ * Returns a vector of count doubles.
+ */
+pvector<double> CallVectors::
+make_doubles(int count, double scale) {
+  pvector<double> values;
+  for (int i = 0; i < count; ++i) {
+    values.push_back(i * scale);
+  }
+  return values;
+}
+
+/**
+ * Returns a vector of count ints.
+ */
+pvector<int> CallVectors::
+make_ints(int count, int scale) {
+  pvector<int> values;
+  for (int i = 0; i < count; ++i) {
+    values.push_back(i * scale);
+  }
+  return values;
+}
+
+/**
+ *
+ */
+double CallVectors::
+sum_floats(const pvector<float> &values) {
+  double sum = 0.0;
+  for (float value : values) {
+    sum += value;
+  }
+  return sum;
+}
+
+/**
+ *
+ */
+double CallVectors::
+sum_doubles(const pvector<double> &values) {
+  double sum = 0.0;
+  for (double value : values) {
+    sum += value;
+  }
+  return sum;
+}
+
+/**
+ *
+ */
+long long CallVectors::
+sum_ints(const pvector<int> &values) {
+  long long sum = 0;
+  for (int value : values) {
+    sum += value;
+  }
+  return sum;
+}
+
+/**
+ * Adds the value to the end of the vector, which may move its elements.
+ */
+void CallVectors::
+append_int(pvector<int> &values, int value) {
+  values.push_back(value);
+}
+
+int CallNode::_num_nodes = 0;
+
+/**
+ *
+ */
+CallNode::
+CallNode() : _ref_count(0) {
+  ++_num_nodes;
+}
+
+/**
+ *
+ */
+CallNode::
+~CallNode() {
+  nassertv(_ref_count == 0);
+  --_num_nodes;
+}
+
+/**
+ * Returns this same node.
+ */
+CallNode *CallNode::
+get_self() {
+  return this;
+}
+
+/**
+ * Returns a node that is kept alive for the lifetime of the program.
+ */
+CallNode *CallNode::
+get_shared() {
+  static CallNode *shared = nullptr;
+  if (shared == nullptr) {
+    shared = new CallNode;
+    shared->ref();
+  }
+  return shared;
+}
+
+/**
+ * Returns the number of nodes that currently exist.
+ */
+int CallNode::
+get_num_nodes() {
+  return _num_nodes;
+}
+
+/**
+ *
+ */
+void CallNode::
+ref() const {
+  ++_ref_count;
+}
+
+/**
+ * Drops a reference, and returns true if there are any left.
+ */
+bool CallNode::
+unref() const {
+  nassertr(_ref_count > 0, false);
+  return --_ref_count != 0;
+}
+
+/**
+ *
+ */
+int CallNode::
+get_ref_count() const {
+  return _ref_count;
+}
+
+#ifdef HAVE_PYTHON
+/**
+ * Accepts a writable buffer.
+ */
+int OverloadTarget::
+take(Py_buffer *view, int n) {
+  return 1;
+}
+
+/**
+ * Accepts anything else.
+ */
+int OverloadTarget::
+take(PyObject *obj, int n) {
+  return 2;
+}
+
+/**
+ * Accepts a string of one character.
+ */
+int OverloadTarget::
+pick(char ch, int n) {
+  return 1;
+}
+
+/**
+ * Accepts any other string, as a truth value.
+ */
+int OverloadTarget::
+pick(bool flag, int n) {
+  return 2;
+}
+
+/**
+ * Accepts a string that can be encoded as UTF-8.
+ */
+int OverloadTarget::
+label(const std::string &name, int n) {
+  return 1;
+}
+
+/**
+ * Accepts anything else, as a truth value.
+ */
+int OverloadTarget::
+label(bool flag, int n) {
+  return 2;
+}
+
+/**
+ * Accepts an integer that fits in an int.
+ */
+int OverloadTarget::
+narrow(int value, int n) {
+  return 1;
+}
+
+/**
+ * Accepts any other number.
+ */
+int OverloadTarget::
+narrow(double value, int n) {
+  return 2;
+}
+
+/**
+ * Accepts a number that fits in a double.
+ */
+int OverloadTarget::
+measure(double value, int n) {
+  return 1;
+}
+
+/**
+ * Accepts anything else, as a truth value.
+ */
+int OverloadTarget::
+measure(bool flag, int n) {
+  return 2;
+}
+#endif  // HAVE_PYTHON
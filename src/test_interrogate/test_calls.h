@@ -0,0 +1,173 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_calls.h
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#ifndef TEST_CALLS_H
+#define TEST_CALLS_H
+
+#include "dtoolbase.h"
+#include "pvector.h"
+
+#ifdef HAVE_PYTHON
+#include "py_panda.h"
+#endif
+
+/**
+ * A class with methods taking arguments in various ways.  Its generated
+ * Python bindings are used by time_calls.py to measure the overhead of a
+ * call from Python into C++.
+ */
+class CallTarget {
+PUBLISHED:
+  CallTarget();
+  explicit CallTarget(int value, float scale = 1.0f);
+
+  int get_value() const;
+  void set_value(int value);
+
+  float mix(int a, float b, float c = 0.0f, bool negate = false) const;
+  void take(const CallTarget &other);
+
+  void assign(int value);
+  void assign(float scale);
+  void assign(const CallTarget &other);
+
+  static int add(int a, int b);
+  static float add(float a, float b);
+
+private:
+  int _value;
+  float _scale;
+};
+
+/**
+ * A class with a method that takes a while to run.  test_calls.N asks for its
+ * methods to release the interpreter lock, which the -gil-telemetry report
+ * shows.
+ */
+class CallWorker {
+PUBLISHED:
+  CallWorker();
+
+  int spin(int iterations);
+  int get_count() const;
+
+private:
+  int _count;
+};
+
+/**
+ * A class with sequence and mapping properties, and a __getattr__ that is
+ * consulted for attributes that are not otherwise defined.  time_calls.py
+ * measures how long it takes to access these from Python.
+ */
+class CallContainer {
+PUBLISHED:
+  CallContainer();
+
+  size_t get_num_items() const;
+  int get_item(size_t n) const;
+  void set_item(size_t n, int value);
+  MAKE_SEQ_PROPERTY(items, get_num_items, get_item, set_item);
+
+  bool has_named(const std::string &name) const;
+  int get_named(const std::string &name) const;
+  MAKE_MAP_PROPERTY(named, has_named, get_named);
+
+  int __getattr__(const std::string &name) const;
+
+private:
+  int _items[4];
+};
+
+/**
+ * A class that hands out vectors of numbers and takes them back, so that
+ * test_buffers.py can check that their elements survive a round trip through
+ * the buffer protocol.  Each vector holds 0, 1, 2, ... times the scale.
+ */
+class CallVectors {
+PUBLISHED:
+  static pvector<float> make_floats(int count, float scale);
+  static pvector<double> make_doubles(int count, double scale);
+  static pvector<int> make_ints(int count, int scale);
+
+  static double sum_floats(const pvector<float> &values);
+  static double sum_doubles(const pvector<double> &values);
+  static long long sum_ints(const pvector<int> &values);
+
+  static void append_int(pvector<int> &values, int value);
+};
+
+/**
+ * A reference-counted class.  test_calls is generated with -cache-wrappers,
+ * so test_wrappers.py can check that an object is handed back to Python as
+ * the same wrapper for as long as that wrapper is alive.
+ */
+class CallNode {
+PUBLISHED:
+  CallNode();
+  ~CallNode();
+
+  CallNode *get_self();
+  static CallNode *get_shared();
+  static int get_num_nodes();
+
+  void ref() const;
+  bool unref() const;
+  int get_ref_count() const;
+
+private:
+  mutable int _ref_count;
+  static int _num_nodes;
+};
+
+#ifndef CPPPARSER
+/**
+ * Drops a reference to the node, deleting it if it was the last one.  The
+ * generated code calls this to release the reference held by a wrapper.
+ */
+template<class RefCountType>
+INLINE void
+unref_delete(RefCountType *ptr) {
+  if (!ptr->unref()) {
+    delete ptr;
+  }
+}
+#endif  // CPPPARSER
+
+#ifdef HAVE_PYTHON
+/**
+ * A class with overloaded methods, each of which returns which of its
+ * overloads was called.  In each pair, the first overload rejects some
+ * arguments for their value rather than their type, so test_overloads.py can
+ * check that the overload that is chosen doesn't depend on earlier calls.
+ */
+class OverloadTarget {
+PUBLISHED:
+  static int take(Py_buffer *view, int n);
+  static int take(PyObject *obj, int n);
+
+  static int pick(char ch, int n);
+  static int pick(bool flag, int n);
+
+  static int label(const std::string &name, int n);
+  static int label(bool flag, int n);
+
+  static int narrow(int value, int n);
+  static int narrow(double value, int n);
+
+  static int measure(double value, int n);
+  static int measure(bool flag, int n);
+};
+#endif  // HAVE_PYTHON
+
+#endif
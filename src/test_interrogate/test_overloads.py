@@ -0,0 +1,89 @@
+"""
+Checks that the interrogate-generated bindings for test_calls.h pick the same
+overload for a given call, no matter which calls came before it.
+
+The wrapper for a set of overloads remembers which one accepted the last
+combination of argument types, and starts there on the next call with the
+same types.  Each method of OverloadTarget has an overload that rejects some
+arguments for their value, so this would give a different answer if it were
+applied where it shouldn't be.
+
+    interrogate -python-native -module test_calls -library test_calls \
+        ... test_calls.h
+    interrogate_module -python-native -module test_calls \
+        -library test_calls ...
+    python test_overloads.py
+"""
+
+import sys
+
+from test_calls import OverloadTarget
+
+
+def check(name, func, cases):
+    """Makes each call in every order, twice in a row, and returns the number
+    of calls that picked the wrong overload."""
+
+    failures = 0
+    for order in (cases, cases[::-1], cases[1:] + cases[:1]):
+        for args, expected in order + order:
+            result = func(*args)
+            if result != expected:
+                print("%s%r picked overload %d, expected %d" % (
+                    name, args, result, expected))
+                failures += 1
+    return failures
+
+
+def main():
+    writable = memoryview(bytearray(b"abc"))
+    readonly = memoryview(b"abc")
+
+    failures = 0
+    failures += check("take", OverloadTarget.take, [
+        ((writable, 0), 1),
+        ((readonly, 0), 2),
+        ((bytearray(b"abc"), 0), 1),
+        ((b"abc", 0), 2),
+    ])
+    failures += check("pick", OverloadTarget.pick, [
+        (("a", 0), 1),
+        (("ab", 0), 2),
+        (("", 0), 2),
+        (("\u00e9", 0), 2),
+        ((b"a", 0), 1),
+        ((b"ab", 0), 2),
+    ])
+    failures += check("label", OverloadTarget.label, [
+        (("abc", 0), 1),
+        (("\udc80", 0), 2),
+        (("\u00e9", 0), 1),
+        ((b"abc", 0), 1),
+        ((readonly, 0), 2),
+        ((writable, 0), 2),
+        ((bytearray(b"abc"), 0), 2),
+    ])
+    failures += check("narrow", OverloadTarget.narrow, [
+        ((1, 0), 1),
+        ((-100000, 0), 1),
+        ((2 ** 40, 0), 2),
+        ((-2 ** 40, 0), 2),
+        ((1.5, 0), 2),
+    ])
+    failures += check("measure", OverloadTarget.measure, [
+        ((2 ** 64, 0), 1),
+        ((10 ** 400, 0), 2),
+        ((1.5, 0), 1),
+        (("x", 0), 2),
+    ])
+
+    if failures:
+        print("%d calls picked the wrong overload" % (failures))
+        return 1
+
+    print("All calls picked the expected overload.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,129 @@
+"""
+Checks that interrogate -parse-cache skips a run when nothing has changed,
+and that it notices a header changing, and a header appearing earlier on the
+include path than the one that was used before.
+
+    python test_parse_cache.py path/to/interrogate
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def write_file(path, contents):
+    with open(path, "w") as file:
+        file.write(contents)
+
+
+class Runner:
+    """Runs interrogate on a small tree of headers in a scratch directory."""
+
+    def __init__(self, interrogate, root):
+        self.interrogate = interrogate
+        self.root = root
+        for dir in ("src", "quote1", "quote2", "angle1", "angle2"):
+            os.mkdir(os.path.join(root, dir))
+
+        write_file(self.path("src", "main.h"),
+                   '#include "util.h"\n'
+                   '#include <sys_util.h>\n'
+                   'class Main {\n'
+                   'public:\n'
+                   '  void run();\n'
+                   '};\n')
+        write_file(self.path("quote2", "util.h"), "class Util {};\n")
+        write_file(self.path("angle2", "sys_util.h"), "class SysUtil {};\n")
+
+    def path(self, *parts):
+        return os.path.join(self.root, *parts)
+
+    def run(self):
+        """Runs interrogate, and returns True if it used the cache."""
+
+        command = [
+            self.interrogate, "-v", "-v",
+            "-srcdir", self.path("src"),
+            "-parse-cache", self.path("cache.txt"),
+            "-oc", self.path("out.cxx"), "-od", self.path("out.in"),
+            "-I" + self.path("quote1"), "-I" + self.path("quote2"),
+            "-S" + self.path("angle1"), "-S" + self.path("angle2"),
+            "-module", "test", "-library", "test", "main.h",
+        ]
+        result = subprocess.run(command, stdout=subprocess.PIPE,
+                                stderr=subprocess.STDOUT,
+                                universal_newlines=True)
+        if result.returncode != 0:
+            raise RuntimeError("interrogate failed:\n" + result.stdout)
+        return "up-to-date" in result.stdout
+
+
+def main():
+    if len(sys.argv) != 2:
+        print("test_parse_cache.py path/to/interrogate")
+        return 1
+
+    root = tempfile.mkdtemp()
+    try:
+        runner = Runner(os.path.abspath(sys.argv[1]), root)
+        failures = 0
+
+        def expect(what, cached):
+            result = runner.run()
+            if result != cached:
+                print("%s: %s the cache" % (
+                    what, "used" if result else "did not use"))
+                return 1
+            return 0
+
+        failures += expect("first run", False)
+
+        # An unchanged run uses the cache, and touches the outputs so that
+        # they look newer than the inputs.
+        out_cxx = runner.path("out.cxx")
+        os.utime(out_cxx, (time.time() - 100, time.time() - 100))
+        old_mtime = os.path.getmtime(out_cxx)
+        failures += expect("unchanged", True)
+        if os.path.getmtime(out_cxx) <= old_mtime:
+            print("unchanged: the output was not touched")
+            failures += 1
+
+        # Changing a header that was read invalidates the cache.
+        write_file(runner.path("quote2", "util.h"), "class Util { int x; };\n")
+        failures += expect("changed header", False)
+        failures += expect("after changed header", True)
+
+        # So does a header that would now be found earlier on the path.
+        write_file(runner.path("quote1", "util.h"), "class Util {};\n")
+        failures += expect("shadowing quote header", False)
+        failures += expect("after shadowing quote header", True)
+
+        write_file(runner.path("angle1", "sys_util.h"), "class SysUtil {};\n")
+        failures += expect("shadowing angle header", False)
+        failures += expect("after shadowing angle header", True)
+
+        # Or one next to the including file.
+        write_file(runner.path("src", "util.h"), "class Util {};\n")
+        failures += expect("header next to includer", False)
+        failures += expect("after header next to includer", True)
+
+        # A header added to a directory after the one that was used doesn't.
+        write_file(runner.path("angle2", "util.h"), "class Util {};\n")
+        failures += expect("unrelated header", True)
+
+    finally:
+        shutil.rmtree(root)
+
+    if failures:
+        print("%d runs did not behave as expected" % (failures))
+        return 1
+
+    print("All runs used the cache as expected.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,91 @@
+"""
+Checks that the interrogate-generated bindings for test_calls.h, which are
+made with -cache-wrappers, hand a reference-counted object back to Python as
+the same wrapper for as long as that wrapper is alive, and that they don't
+keep the object alive or hand out the wrapper after it is gone.
+
+    interrogate -python-native -cache-wrappers -module test_calls \
+        -library test_calls ... test_calls.h
+    interrogate_module -python-native -module test_calls \
+        -library test_calls ...
+    python test_wrappers.py
+"""
+
+import gc
+import sys
+
+from test_calls import CallNode
+
+
+def check(name, result, expected):
+    """Returns 0 if the result was as expected, or 1 after reporting it."""
+
+    if result != expected:
+        print("%s: got %r, expected %r" % (name, result, expected))
+        return 1
+    return 0
+
+
+class SubNode(CallNode):
+    pass
+
+
+def main():
+    failures = 0
+
+    # A static method returning the same object gives the same wrapper, which
+    # holds the only reference that Python has to it.
+    shared = CallNode.get_shared()
+    failures += check("shared is shared",
+                      CallNode.get_shared() is CallNode.get_shared(), True)
+    failures += check("shared is kept", CallNode.get_shared() is shared, True)
+    failures += check("shared ref count", shared.get_ref_count(), 2)
+
+    # Once that wrapper is gone, a new one is made, and then reused in turn.
+    del shared
+    gc.collect()
+    shared = CallNode.get_shared()
+    failures += check("new shared ref count", shared.get_ref_count(), 2)
+    failures += check("new shared is kept", CallNode.get_shared() is shared,
+                      True)
+    del shared
+
+    # So does a method returning the object it was called on, including on an
+    # instance of a Python subclass, which keeps its attributes.
+    num_nodes = CallNode.get_num_nodes()
+    node = CallNode()
+    failures += check("self", node.get_self() is node, True)
+    failures += check("self of self", node.get_self().get_self() is node, True)
+    failures += check("self ref count", node.get_ref_count(), 1)
+
+    sub = SubNode()
+    sub.tag = "sub"
+    returned = sub.get_self()
+    failures += check("subclass self", returned is sub, True)
+    failures += check("subclass type", type(returned), SubNode)
+    failures += check("subclass tag", getattr(returned, "tag", None), "sub")
+    failures += check("subclass ref count", sub.get_ref_count(), 1)
+
+    # The wrappers don't keep the objects alive once they are gone.
+    failures += check("live nodes", CallNode.get_num_nodes(), num_nodes + 2)
+    del node, sub, returned
+    gc.collect()
+    failures += check("nodes after del", CallNode.get_num_nodes(), num_nodes)
+
+    # A new object at the address of one that went away gets its own wrapper.
+    for i in range(10):
+        node = CallNode()
+        failures += check("new node self", node.get_self() is node, True)
+        failures += check("new node type", type(node.get_self()), CallNode)
+        del node
+
+    if failures:
+        print("%d checks failed" % (failures))
+        return 1
+
+    print("All objects were returned as the same wrapper.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
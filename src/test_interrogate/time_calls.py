@@ -0,0 +1,63 @@
+"""
+Measures the overhead of calling from Python into the interrogate-generated
+bindings for test_calls.h, per kind of call.
+
+To compare calling conventions, generate the test_calls module once as usual
+and once with interrogate's -fastcall option added, and run this script
+against each build:
+
+    interrogate -python-native -module test_calls -library test_calls \
+        [-fastcall] ... test_calls.h
+    interrogate_module -python-native -module test_calls \
+        -library test_calls ...
+
+If the module was generated with -gil-telemetry, the time spent in each C++
+function is listed afterwards, along with whether it released the GIL.
+"""
+
+import sys
+import timeit
+
+import test_calls
+from test_calls import CallTarget, CallWorker, CallContainer
+
+
+def main(number=1000000):
+    obj = CallTarget(1, 2.0)
+    other = CallTarget()
+    container = CallContainer()
+
+    tests = [
+        ("get_value()", lambda: obj.get_value()),
+        ("set_value(3)", lambda: obj.set_value(3)),
+        ("mix(1, 2.0)", lambda: obj.mix(1, 2.0)),
+        ("mix(1, 2.0, negate=True)", lambda: obj.mix(1, 2.0, negate=True)),
+        ("mix(a=1, b=2.0, c=3.0)", lambda: obj.mix(a=1, b=2.0, c=3.0)),
+        ("take(other)", lambda: obj.take(other)),
+        ("CallTarget.add(1, 2)", lambda: CallTarget.add(1, 2)),
+        ("CallTarget.add(1.5, 2.5)", lambda: CallTarget.add(1.5, 2.5)),
+        ("CallTarget(1, 2.0)", lambda: CallTarget(1, 2.0)),
+        ("container.items[2]", lambda: container.items[2]),
+        ("container.items[2] = 3", lambda: container.items.__setitem__(2, 3)),
+        ("container.named['b']", lambda: container.named['b']),
+        ("container.get_num_items()", lambda: container.get_num_items()),
+        ("container.undefined", lambda: container.undefined),
+    ]
+
+    for name, func in tests:
+        elapsed = min(timeit.repeat(func, number=number, repeat=3))
+        print("%-28s %6.1f ns" % (name, elapsed * 1e9 / number))
+
+    if hasattr(test_calls, "_gil_telemetry"):
+        CallWorker().spin(number)
+
+        print()
+        stats = test_calls._gil_telemetry()
+        for name, (calls, total, longest, released) in \
+                sorted(stats.items(), key=lambda item: -item[1][1]):
+            print("%-64s %9d %9.3f ms %s" % (name, calls, total * 1e3,
+                                              "released" if released else ""))
+
+
+if __name__ == "__main__":
+    main(*map(int, sys.argv[1:]))
@@ -0,0 +1,50 @@
+"""
+Measures how long it takes to import an interrogate-generated module, and how
+long it then takes to make all of its classes available.
+
+To compare eager and lazy type initialization, generate the module once as
+usual and once with interrogate's -lazy-types option added, and run this
+script against each build:
+
+    interrogate -python-native -module test_calls -library test_calls \
+        [-lazy-types] ... test_calls.h
+    interrogate_module -python-native -module test_calls \
+        -library test_calls ...
+
+Every import is done in a fresh interpreter, so that the timing is not
+affected by modules that are already loaded.
+"""
+
+import subprocess
+import sys
+
+SCRIPT = """
+import time
+t0 = time.perf_counter()
+import {0} as module
+t1 = time.perf_counter()
+for name in dir(module):
+    getattr(module, name)
+t2 = time.perf_counter()
+print(t1 - t0, t2 - t1)
+"""
+
+
+def main(module="test_calls", repeat=20):
+    repeat = int(repeat)
+    script = SCRIPT.format(module)
+
+    imports = []
+    accesses = []
+    for i in range(repeat):
+        output = subprocess.check_output([sys.executable, "-c", script])
+        import_time, access_time = map(float, output.split())
+        imports.append(import_time)
+        accesses.append(access_time)
+
+    print("%-28s %9.3f ms" % ("import " + module, min(imports) * 1e3))
+    print("%-28s %9.3f ms" % ("access all attributes", min(accesses) * 1e3))
+
+
+if __name__ == "__main__":
+    main(*sys.argv[1:])
@@ -0,0 +1,217 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file time_parse.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "cppParser.h"
+#include "cppManifest.h"
+#include "filename.h"
+#include "vector_string.h"
+#include "panda_getopt.h"
+#include "preprocess_argv.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+#ifdef HAVE_THREADS
+#include <thread>
+#endif
+
+using std::cerr;
+using std::string;
+
+static vector_string quote_dirs;
+static vector_string angle_dirs;
+static vector_string defines;
+
+/**
+ * Parses each header in turn with a fresh parser, taking the next one from
+ * the list until all of them have been parsed.  Several of these may run at
+ * the same time on different threads.
+ */
+static void
+parse_headers(const vector_string &headers, std::atomic<size_t> &next,
+              std::atomic<size_t> &num_failed) {
+  size_t i;
+  while ((i = next++) < headers.size()) {
+    CPPParser parser;
+    parser.set_verbose(0);
+    for (const string &dir : quote_dirs) {
+      parser._quote_include_path.append_directory(dir);
+      parser._quote_include_kind.push_back(CPPFile::S_alternate);
+    }
+    for (const string &dir : angle_dirs) {
+      parser._angle_include_path.append_directory(dir);
+      parser._quote_include_path.append_directory(dir);
+      parser._quote_include_kind.push_back(CPPFile::S_system);
+    }
+    for (const string &define : defines) {
+      size_t eq = define.find('=');
+      CPPManifest *macro;
+      if (eq != string::npos) {
+        macro = new CPPManifest(define.substr(0, eq), define.substr(eq + 1));
+      } else {
+        macro = new CPPManifest(define, string());
+      }
+      parser._manifests[macro->_name] = macro;
+    }
+
+    if (!parser.parse_file(headers[i])) {
+      ++num_failed;
+    }
+  }
+}
+
+/**
+ * Adds the headers in the given directory and its subdirectories to the list.
+ */
+static void
+scan_headers(const Filename &dirname, vector_string &headers) {
+  vector_string contents;
+  if (!dirname.scan_directory(contents)) {
+    return;
+  }
+
+  for (const string &name : contents) {
+    Filename pathname(dirname, name);
+    if (pathname.is_directory()) {
+      scan_headers(pathname, headers);
+    } else if (pathname.get_extension() == "h") {
+      headers.push_back(pathname);
+    }
+  }
+}
+
+static void
+usage() {
+  cerr <<
+    "time_parse [opts] dir|file [dir|file ...]\n\n"
+
+    "Parses each of the given header files, and all headers found in the\n"
+    "given directories, with a separate parser, and reports how long it took.\n"
+    "The headers are parsed on several threads at once with -j.  The results\n"
+    "of the parses are discarded, not combined.\n\n"
+
+    "Options:\n\n"
+    "  -I [dir]\n"
+    "      Add a directory to the search path for #include \"...\".\n"
+    "  -S [dir]\n"
+    "      Add a directory to the search path for #include <...> and \"...\".\n"
+    "  -D [name]=[value]\n"
+    "      Define a manifest, as for interrogate.\n"
+    "  -j [count]\n"
+    "      Parse this many headers at the same time, on separate threads.\n"
+    "  -r [count]\n"
+    "      Parse everything this many times, and report the fastest run.\n\n";
+}
+
+int
+main(int argc, char **argv) {
+  extern char *optarg;
+  extern int optind;
+  const char *optstr = "I:S:D:j:r:h";
+
+  int num_threads = 1;
+  int repeat = 1;
+  preprocess_argv(argc, argv);
+  int flag = getopt(argc, argv, optstr);
+
+  while (flag != EOF) {
+    switch (flag) {
+    case 'I':
+      quote_dirs.push_back(optarg);
+      break;
+
+    case 'S':
+      angle_dirs.push_back(optarg);
+      break;
+
+    case 'D':
+      defines.push_back(optarg);
+      break;
+
+    case 'j':
+      num_threads = std::max(atoi(optarg), 1);
+      break;
+
+    case 'r':
+      repeat = std::max(atoi(optarg), 1);
+      break;
+
+    case 'h':
+      usage();
+      exit(0);
+
+    default:
+      exit(1);
+    }
+    flag = getopt(argc, argv, optstr);
+  }
+
+  argc -= (optind-1);
+  argv += (optind-1);
+
+  if (argc < 2) {
+    usage();
+    exit(1);
+  }
+
+#ifndef HAVE_THREADS
+  if (num_threads > 1) {
+    cerr << "Built without thread support; ignoring -j.\n";
+    num_threads = 1;
+  }
+#endif
+
+  vector_string headers;
+  for (int i = 1; i < argc; i++) {
+    Filename param = Filename::from_os_specific(argv[i]);
+    if (param.is_directory()) {
+      scan_headers(param, headers);
+    } else {
+      headers.push_back(param);
+    }
+  }
+  std::sort(headers.begin(), headers.end());
+
+  double best = 0.0;
+  size_t num_failed = 0;
+  for (int r = 0; r < repeat; ++r) {
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> failed(0);
+    auto start = std::chrono::steady_clock::now();
+
+#ifdef HAVE_THREADS
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_threads; ++t) {
+      threads.push_back(std::thread(parse_headers, std::cref(headers),
+                                    std::ref(next), std::ref(failed)));
+    }
+    parse_headers(headers, next, failed);
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+#else
+    parse_headers(headers, next, failed);
+#endif
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (r == 0 || elapsed.count() < best) {
+      best = elapsed.count();
+    }
+    num_failed = failed;
+  }
+
+  cerr << headers.size() << " files, " << num_failed << " failed, "
+       << num_threads << " threads, " << best * 1000.0 << " ms\n";
+  return 0;
+}
@@ -0,0 +1,217 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file time_preprocess.cxx
+ * @author agent
+ * @date 2026-10-19
+ */
+
+#include "cppParser.h"
+#include "cppBisonDefs.h"
+#include "cppCommentBlock.h"
+#include "filename.h"
+#include "vector_string.h"
+#include "panda_getopt.h"
+#include "preprocess_argv.h"
+
+#include <algorithm>
+#include <chrono>
+
+using std::cerr;
+using std::cout;
+using std::string;
+
+/**
+ * Runs only the preprocessor over a file, pulling tokens until the end of the
+ * file without handing them to the parser.
+ */
+class PreprocessOnly : public CPPParser {
+public:
+  size_t preprocess(const Filename &filename, bool dump);
+};
+
+/**
+ * Returns the number of tokens read from the file, or 0 if it could not be
+ * read.  If dump is true, writes each token and comment with its location to
+ * stdout, which is useful to compare the output of two builds.
+ */
+size_t PreprocessOnly::
+preprocess(const Filename &filename, bool dump) {
+  current_scope = this;
+  global_scope = this;
+  _resolve_identifiers = false;
+  _verbose = 0;
+
+  CPPFile file(filename, filename, CPPFile::S_local);
+  if (!init_cpp(file)) {
+    cerr << "Unable to read " << filename << "\n";
+    return 0;
+  }
+
+  size_t num_tokens = 0;
+  CPPToken token = get_next_token();
+  while (!token.is_eof()) {
+    ++num_tokens;
+    if (dump) {
+      const YYLTYPE &loc = token._lloc;
+      cout << loc.file._filename << ":" << loc.first_line << ":"
+           << loc.first_column << "-" << loc.last_line << ":"
+           << loc.last_column << " " << token._token << " ";
+      token.output(cout);
+      cout << "\n";
+    }
+    token = get_next_token();
+  }
+
+  if (dump) {
+    for (CPPCommentBlock *comment : _comments) {
+      cout << comment->_file._filename << ":" << comment->_line_number << ":"
+           << comment->_col_number << "-" << comment->_last_line
+           << " comment " << comment->_comment.size() << "\n";
+    }
+  }
+  return num_tokens;
+}
+
+/**
+ * Adds the headers in the given directory and its subdirectories to the list.
+ * Files without an extension are considered headers too, as in parser-inc.
+ */
+static void
+scan_headers(const Filename &dirname, vector_string &headers) {
+  vector_string contents;
+  if (!dirname.scan_directory(contents)) {
+    return;
+  }
+
+  for (const string &name : contents) {
+    Filename pathname(dirname, name);
+    if (pathname.is_directory()) {
+      scan_headers(pathname, headers);
+    } else {
+      string ext = pathname.get_extension();
+      if (ext.empty() || ext == "h") {
+        headers.push_back(pathname);
+      }
+    }
+  }
+}
+
+static void
+usage() {
+  cerr <<
+    "time_preprocess [opts] dir|file [dir|file ...]\n\n"
+
+    "Runs interrogate's preprocessor over the given header files, and over all\n"
+    "headers found in the given directories, and reports how long it took.\n"
+    "To measure the preprocessing of the whole tree, pass the parser-inc\n"
+    "directory with -S as well as on the command line, along with the source\n"
+    "directories.\n\n"
+
+    "Options:\n\n"
+    "  -I [dir]\n"
+    "      Add a directory to the search path for #include \"...\".\n"
+    "  -S [dir]\n"
+    "      Add a directory to the search path for #include <...> and \"...\".\n"
+    "  -r [count]\n"
+    "      Preprocess everything this many times, and report the fastest run.\n"
+    "  -d  Write each token and comment with its location to stdout.\n\n";
+}
+
+int
+main(int argc, char **argv) {
+  extern char *optarg;
+  extern int optind;
+  const char *optstr = "I:S:r:dh";
+
+  vector_string quote_dirs;
+  vector_string angle_dirs;
+  int repeat = 1;
+  bool dump = false;
+  preprocess_argv(argc, argv);
+  int flag = getopt(argc, argv, optstr);
+
+  while (flag != EOF) {
+    switch (flag) {
+    case 'I':
+      quote_dirs.push_back(optarg);
+      break;
+
+    case 'S':
+      angle_dirs.push_back(optarg);
+      break;
+
+    case 'r':
+      repeat = std::max(atoi(optarg), 1);
+      break;
+
+    case 'd':
+      dump = true;
+      break;
+
+    case 'h':
+      usage();
+      exit(0);
+
+    default:
+      exit(1);
+    }
+    flag = getopt(argc, argv, optstr);
+  }
+
+  argc -= (optind-1);
+  argv += (optind-1);
+
+  if (argc < 2) {
+    usage();
+    exit(1);
+  }
+
+  vector_string headers;
+  for (int i = 1; i < argc; i++) {
+    Filename param = Filename::from_os_specific(argv[i]);
+    if (param.is_directory()) {
+      scan_headers(param, headers);
+    } else {
+      headers.push_back(param);
+    }
+  }
+  std::sort(headers.begin(), headers.end());
+
+  double best = 0.0;
+  size_t num_tokens = 0;
+  for (int r = 0; r < repeat; ++r) {
+    num_tokens = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (const string &header : headers) {
+      // Use a fresh preprocessor for each file, so that it starts out without
+      // any manifests defined, like a separate interrogate run would.
+      PreprocessOnly pp;
+      for (const string &dir : quote_dirs) {
+        pp._quote_include_path.append_directory(dir);
+        pp._quote_include_kind.push_back(CPPFile::S_alternate);
+      }
+      for (const string &dir : angle_dirs) {
+        pp._angle_include_path.append_directory(dir);
+        pp._quote_include_path.append_directory(dir);
+        pp._quote_include_kind.push_back(CPPFile::S_system);
+      }
+      num_tokens += pp.preprocess(header, dump && r == 0);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (r == 0 || elapsed.count() < best) {
+      best = elapsed.count();
+    }
+  }
+
+  cerr << headers.size() << " files, " << num_tokens << " tokens, "
+       << best * 1000.0 << " ms\n";
+  return 0;
+}